@@ -0,0 +1,16 @@
+#!/bin/bash
+BUILD_DIR=../../BELLA-traccc_build
+
+# Results of this version, e.g. benchmarks_v1.2.json
+version=$(git describe --tags --always --dirty)
+
+mkdir -p ${PWD}/benchmarks
+
+command="
+${BUILD_DIR}/bin/bella_benchmarks
+--benchmark_out=${PWD}/benchmarks/benchmarks_${version}.json
+--benchmark_out_format=json
+--benchmark_repetitions=5
+--benchmark_report_aggregates_only=true
+"
+${command}
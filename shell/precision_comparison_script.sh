@@ -0,0 +1,65 @@
+#!/bin/bash
+n_events=10
+n_particles=100
+p=0.1
+deg=90
+
+# Builds configured with -DBELLA_SCALAR_TYPE=double and =float
+DOUBLE_BUILD_DIR=${PWD}/../../BELLA-traccc_build
+FLOAT_BUILD_DIR=${PWD}/../../BELLA-traccc_build_float
+
+WORK_DIR=${PWD}/precision_comparison
+mkdir -p ${WORK_DIR}/double ${WORK_DIR}/float
+cd ${WORK_DIR}
+
+# Write the bfield and simulate the events once, so both builds fit the
+# same measurements
+command="
+${DOUBLE_BUILD_DIR}/bin/write_bfield
+--bfield-format=cvf
+--bfield-output=${WORK_DIR}/bfield.cvf"
+${command}
+
+command="
+${DOUBLE_BUILD_DIR}/bin/do_telescope_simulation
+--gen-events=${n_events}
+--gen-nparticles=${n_particles}
+--gen-theta=${deg}:${deg}
+--gen-mom-gev=${p}:${p}
+--gen-phi-degree=0:0
+--output-directory=${WORK_DIR}/sim_data/
+--bfield-file=${WORK_DIR}/bfield.cvf
+"
+${command}
+
+# Fit them in both precisions, into double/residual.bin and float/residual.bin
+for precision in double float
+do
+    if [ ${precision} == double ]; then
+        build_dir=${DOUBLE_BUILD_DIR}
+    else
+        build_dir=${FLOAT_BUILD_DIR}
+    fi
+
+    cd ${WORK_DIR}/${precision}
+    command="
+    ${build_dir}/bin/do_truth_fitting_momentum_residual
+    --detector-file=${WORK_DIR}/telescope_detector_geometry.json
+    --material-file=${WORK_DIR}/telescope_detector_homogeneous_material.json
+    --input-directory=${WORK_DIR}/sim_data/
+    --input-events=${n_events}
+    --use-detray-detector
+    --bfield-file=${WORK_DIR}/bfield.cvf
+    --output-format=binary
+    "
+    ${command}
+done
+
+# Report the differences of the fitted momenta
+cd ${WORK_DIR}
+command="
+${DOUBLE_BUILD_DIR}/bin/do_compare_precision
+--reference-residuals=${WORK_DIR}/double/residual.bin
+--test-residuals=${WORK_DIR}/float/residual.bin
+"
+${command}
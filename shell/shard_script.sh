@@ -0,0 +1,42 @@
+#!/bin/bash
+# One shard of a Slurm job array, and the merge of all shards, e.g.
+#   sbatch --array=0-15 shard_script.sh
+#   sbatch --dependency=afterok:<array job id> shard_script.sh merge 16
+n_events=1000
+n_particles=100
+p=0.1
+deg=90
+
+BUILD_DIR=../../BELLA-traccc_build
+
+if [ "$1" == merge ]; then
+    n_shards=$2
+    command="
+    ${BUILD_DIR}/bin/bella_merge
+    --residual-inputs $(ls residual_shard_*_of_${n_shards}.bin)
+    --state-inputs $(ls state_shard_*_of_${n_shards}.bin)
+    --summary-inputs $(ls residual_summary_shard_*_of_${n_shards}.json)
+    --merge-output=../data/residual_${p}_GeV_${deg}_theta
+    "
+    ${command}
+    exit
+fi
+
+shard=${SLURM_ARRAY_TASK_ID:-0}
+n_shards=${SLURM_ARRAY_TASK_COUNT:-1}
+
+# Every shard simulates and fits its block of the same logical sample
+command="
+${BUILD_DIR}/bin/do_telescope_simulate_and_fit
+--gen-events=${n_events}
+--gen-nparticles=${n_particles}
+--gen-theta=${deg}:${deg}
+--gen-mom-gev=${p}:${p}
+--gen-phi-degree=0:0
+--bfield-file=${PWD}/../bfield/bfield.cvf
+--seed=1
+--shard=${shard}/${n_shards}
+--output-format=binary
+"
+${command}
+
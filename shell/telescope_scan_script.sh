@@ -0,0 +1,32 @@
+#!/bin/bash
+n_events=10
+n_particles=100
+moms=0.1,0.5,1.0
+degrees=90
+
+BUILD_DIR=../../BELLA-traccc_build
+
+# Write bfield in covfie format for BELLA detector
+command="
+${BUILD_DIR}/bin/write_bfield
+--bfield-format=cvf
+--bfield-output=${PWD}/../bfield/bfield.cvf"
+${command}
+
+# Simulate and fit all (momentum, theta) points in one process
+command="
+${BUILD_DIR}/bin/do_telescope_simulate_and_fit
+--gen-events=${n_events}
+--gen-nparticles=${n_particles}
+--gen-phi-degree=0:0
+--scan-mom=${moms}
+--scan-theta=${degrees}
+--cpu-threads=$(nproc)
+--bfield-file=${PWD}/../bfield/bfield.cvf
+"
+${command}
+
+# Move the CSV files to data directory
+mkdir -p ../data
+mv residual_*_GeV_*_theta.csv ../data/
+mv state_*_GeV_*_theta.csv ../data/
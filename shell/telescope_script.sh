@@ -11,16 +11,11 @@ do
     for p in "${moms[@]}"
     do
 
-	# Write bfield in txt for BELLA detector
+	# Write bfield in covfie format for BELLA detector
 	command="
-	${BUILD_DIR}/bin/write_bfield"
-	${command}
-
-	# Convert bfield into covfie format
-	command="
-	${BUILD_DIR}/_deps/covfie-build/examples/core/convert_bfield
-	--input ${PWD}/bfield.txt 
-	--output ${PWD}/../bfield/bfield.cvf"
+	${BUILD_DIR}/bin/write_bfield
+	--bfield-format=cvf
+	--bfield-output=${PWD}/../bfield/bfield.cvf"
 	${command}
 
 	# Do the simulation
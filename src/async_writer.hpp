@@ -0,0 +1,161 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// System include(s).
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace bella
+{
+
+    /// Output stage writing on a dedicated thread
+    ///
+    /// Producers hand finished values, e.g. the records of one event, to
+    /// @c push, which only moves them into the front buffer. The writer
+    /// thread swaps the front buffer with its back buffer and writes the
+    /// back buffer out without holding the lock, so the producers never wait
+    /// for the file system while there is room. @c push blocks while the
+    /// front buffer holds @c capacity values, which bounds the memory held
+    /// by a slow file system to two buffers.
+    ///
+    /// @c push may be called from several threads; the values of one thread
+    /// are written in the order it pushed them. The first exception of the
+    /// write callable stops the writing, makes @c push return false and is
+    /// rethrown by @c close.
+    template <typename T>
+    class async_writer
+    {
+
+    public:
+        /// Callable writing one value, on the writer thread
+        using write_type = std::function<void(T &&)>;
+
+        /// Constructor, starting the writer thread
+        ///
+        /// @param capacity Maximum number of values waiting in the front
+        ///                 buffer
+        /// @param write    Callable writing one value
+        async_writer(const std::size_t capacity, write_type write)
+            : m_capacity(capacity > 0u ? capacity : 1u), m_write(std::move(write))
+        {
+            m_front.reserve(m_capacity);
+            m_back.reserve(m_capacity);
+            m_thread = std::thread([this]() { run(); });
+        }
+
+        /// Destructor, writing out the waiting values. Errors are only
+        /// reported by @c close.
+        ~async_writer() { finish(); }
+
+        async_writer(const async_writer &) = delete;
+        async_writer &operator=(const async_writer &) = delete;
+
+        /// Hand over a value, waiting for room in the front buffer
+        ///
+        /// @return false if the writer failed or was closed and @c value
+        ///         was dropped
+        bool push(T &&value)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_not_full.wait(lock, [this]()
+                            { return m_closed || m_front.size() < m_capacity; });
+            if (m_closed)
+            {
+                return false;
+            }
+            m_front.push_back(std::move(value));
+            m_not_empty.notify_one();
+            return true;
+        }
+
+        /// Write out the waiting values, stop the writer thread and rethrow
+        /// the first error of the writing
+        void close()
+        {
+            finish();
+            if (m_error)
+            {
+                std::rethrow_exception(std::exchange(m_error, nullptr));
+            }
+        }
+
+    private:
+        /// Writer thread: write the front buffer whenever it has values
+        void run()
+        {
+            while (true)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_not_empty.wait(lock, [this]()
+                                     { return m_draining || !m_front.empty(); });
+                    if (m_front.empty())
+                    {
+                        return;
+                    }
+                    std::swap(m_front, m_back);
+                    m_not_full.notify_all();
+                }
+
+                try
+                {
+                    for (T &value : m_back)
+                    {
+                        m_write(std::move(value));
+                    }
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_error = std::current_exception();
+                    m_closed = true;
+                    m_front.clear();
+                    m_not_full.notify_all();
+                }
+                m_back.clear();
+            }
+        }
+
+        /// Stop accepting values and wait for the writer to empty the buffers
+        void finish()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_closed = true;
+                m_draining = true;
+                m_not_empty.notify_one();
+                m_not_full.notify_all();
+            }
+            if (m_thread.joinable())
+            {
+                m_thread.join();
+            }
+        }
+
+        std::size_t m_capacity;
+        write_type m_write;
+        std::vector<T> m_front;
+        std::vector<T> m_back;
+        bool m_closed = false;
+        bool m_draining = false;
+        std::exception_ptr m_error;
+        std::mutex m_mutex;
+        std::condition_variable m_not_empty;
+        std::condition_variable m_not_full;
+        std::thread m_thread;
+
+    }; // class async_writer
+
+} // namespace bella
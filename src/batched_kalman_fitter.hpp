@@ -0,0 +1,1042 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Project include(s).
+#include "traccc/definitions/common.hpp"
+#include "traccc/definitions/primitives.hpp"
+#include "traccc/definitions/track_parametrization.hpp"
+#include "traccc/edm/measurement.hpp"
+#include "traccc/edm/track_candidate.hpp"
+#include "traccc/edm/track_parameters.hpp"
+#include "traccc/edm/track_state.hpp"
+#include "traccc/utils/particle.hpp"
+
+// detray include(s).
+#include "detray/definitions/pdg_particle.hpp"
+#include "detray/geometry/barcode.hpp"
+#include "detray/geometry/tracking_surface.hpp"
+
+// Local include(s).
+#include "src/fitting_options.hpp"
+#include "src/telescope_metadata.hpp"
+
+// VecMem include(s).
+#include <vecmem/containers/vector.hpp>
+#include <vecmem/memory/memory_resource.hpp>
+
+// System include(s).
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace bella
+{
+
+    namespace detail
+    {
+
+        /// One value per track of a batch
+        template <std::size_t N>
+        using lane_array = std::array<traccc::scalar, N>;
+
+        /// Track parameters of a batch in the telescope frame
+        /// (y, z, dy/dx, dz/dx, q/p), one lane per track
+        template <std::size_t N>
+        using lane_vector = std::array<lane_array<N>, 5>;
+
+        /// 5x5 matrices of a batch, one lane per track
+        template <std::size_t N>
+        using lane_matrix = std::array<std::array<lane_array<N>, 5>, 5>;
+
+        /// Indices of the telescope frame parameters
+        enum plane_parameter : unsigned int
+        {
+            e_y = 0u,
+            e_z = 1u,
+            e_ty = 2u,
+            e_tz = 3u,
+            e_qop = 4u,
+        };
+
+        template <std::size_t N>
+        lane_matrix<N> identity()
+        {
+            lane_matrix<N> m{};
+            for (unsigned int i = 0; i < 5u; ++i)
+            {
+                m[i][i].fill(1.f);
+            }
+            return m;
+        }
+
+        /// @c out = @c a + @c c * @c b, lane by lane
+        template <std::size_t N>
+        void add_scaled(const lane_vector<N> &a, const traccc::scalar c,
+                        const lane_vector<N> &b, lane_vector<N> &out)
+        {
+            for (unsigned int i = 0; i < 5u; ++i)
+            {
+                for (std::size_t l = 0; l < N; ++l)
+                {
+                    out[i][l] = a[i][l] + c * b[i][l];
+                }
+            }
+        }
+
+        /// @c out = @c a + @c c * @c b, lane by lane
+        template <std::size_t N>
+        void add_scaled(const lane_matrix<N> &a, const traccc::scalar c,
+                        const lane_matrix<N> &b, lane_matrix<N> &out)
+        {
+            for (unsigned int i = 0; i < 5u; ++i)
+            {
+                for (unsigned int j = 0; j < 5u; ++j)
+                {
+                    for (std::size_t l = 0; l < N; ++l)
+                    {
+                        out[i][j][l] = a[i][j][l] + c * b[i][j][l];
+                    }
+                }
+            }
+        }
+
+        /// @c a * @c b, lane by lane
+        template <std::size_t N>
+        lane_matrix<N> multiply(const lane_matrix<N> &a, const lane_matrix<N> &b)
+        {
+            lane_matrix<N> c{};
+            for (unsigned int i = 0; i < 5u; ++i)
+            {
+                for (unsigned int j = 0; j < 5u; ++j)
+                {
+                    for (unsigned int k = 0; k < 5u; ++k)
+                    {
+                        for (std::size_t l = 0; l < N; ++l)
+                        {
+                            c[i][j][l] += a[i][k][l] * b[k][j][l];
+                        }
+                    }
+                }
+            }
+            return c;
+        }
+
+        /// @c a * transpose(@c b), lane by lane
+        template <std::size_t N>
+        lane_matrix<N> multiply_transposed(const lane_matrix<N> &a,
+                                           const lane_matrix<N> &b)
+        {
+            lane_matrix<N> c{};
+            for (unsigned int i = 0; i < 5u; ++i)
+            {
+                for (unsigned int j = 0; j < 5u; ++j)
+                {
+                    for (unsigned int k = 0; k < 5u; ++k)
+                    {
+                        for (std::size_t l = 0; l < N; ++l)
+                        {
+                            c[i][j][l] += a[i][k][l] * b[j][k][l];
+                        }
+                    }
+                }
+            }
+            return c;
+        }
+
+        /// Inverse of symmetric positive definite matrices, lane by lane
+        ///
+        /// Gauss-Jordan elimination without pivoting, which is stable for
+        /// covariance matrices. Lanes with a non-positive pivot are flagged
+        /// in @c ok.
+        template <std::size_t N>
+        lane_matrix<N> invert(lane_matrix<N> a, std::array<bool, N> &ok)
+        {
+            lane_matrix<N> inv = identity<N>();
+            for (unsigned int i = 0; i < 5u; ++i)
+            {
+                lane_array<N> pivot_inv;
+                for (std::size_t l = 0; l < N; ++l)
+                {
+                    ok[l] = ok[l] && a[i][i][l] > 0.f;
+                    pivot_inv[l] = a[i][i][l] > 0.f ? 1.f / a[i][i][l] : 0.f;
+                }
+                for (unsigned int j = 0; j < 5u; ++j)
+                {
+                    for (std::size_t l = 0; l < N; ++l)
+                    {
+                        a[i][j][l] *= pivot_inv[l];
+                        inv[i][j][l] *= pivot_inv[l];
+                    }
+                }
+                for (unsigned int r = 0; r < 5u; ++r)
+                {
+                    if (r == i)
+                    {
+                        continue;
+                    }
+                    for (unsigned int j = 0; j < 5u; ++j)
+                    {
+                        for (std::size_t l = 0; l < N; ++l)
+                        {
+                            const traccc::scalar f = a[r][i][l];
+                            a[r][j][l] -= f * a[i][j][l];
+                            inv[r][j][l] -= f * inv[i][j][l];
+                        }
+                    }
+                }
+            }
+            return inv;
+        }
+
+        /// Move the tracks of a batch from the plane at @c x0 to the one at
+        /// @c x1 with RK4 steps in x of at most @c max_step, with the transport
+        /// Jacobian
+        ///
+        /// The Jacobian is integrated with the same RK4 stages as the
+        /// parameters, from dJ/dx = A J with A the derivative of the
+        /// equations of motion at the stage, like in the detray RK stepper.
+        /// The field gradient is neglected in A.
+        template <std::size_t N, typename field_view_t>
+        void propagate(const field_view_t &field, const traccc::scalar x0,
+                       const traccc::scalar x1, const traccc::scalar max_step,
+                       lane_vector<N> &s, lane_matrix<N> &jacobian)
+        {
+            using traccc::scalar;
+
+            jacobian = identity<N>();
+
+            const scalar dx = x1 - x0;
+            const std::size_t n_steps = static_cast<std::size_t>(
+                std::ceil(std::abs(dx) / max_step));
+            if (n_steps == 0u)
+            {
+                return;
+            }
+            const scalar h = dx / static_cast<scalar>(n_steps);
+
+            // d(dy/dx, dz/dx)/d(dy/dx, dz/dx, q/p) of the batch
+            using motion_derivative = std::array<std::array<lane_array<N>, 3>, 2>;
+
+            // d(y, z, ty, tz, qop)/dx of the batch at x, and its derivative
+            auto derivative = [&field](const scalar x, const lane_vector<N> &st,
+                                       lane_vector<N> &d, motion_derivative &a)
+            {
+                std::array<lane_array<N>, 3> b;
+                for (std::size_t l = 0; l < N; ++l)
+                {
+                    const auto bl = field.at(static_cast<float>(x),
+                                             static_cast<float>(st[e_y][l]),
+                                             static_cast<float>(st[e_z][l]));
+                    b[0][l] = bl[0];
+                    b[1][l] = bl[1];
+                    b[2][l] = bl[2];
+                }
+                for (std::size_t l = 0; l < N; ++l)
+                {
+                    const scalar ty = st[e_ty][l];
+                    const scalar tz = st[e_tz][l];
+                    const scalar qop = st[e_qop][l];
+                    const scalar n = std::sqrt(1.f + ty * ty + tz * tz);
+                    const scalar k = qop * n;
+                    const scalar fy = tz * b[0][l] - (1.f + ty * ty) * b[2][l] +
+                                      ty * tz * b[1][l];
+                    const scalar fz = (1.f + tz * tz) * b[1][l] - ty * b[0][l] -
+                                      ty * tz * b[2][l];
+                    d[e_y][l] = ty;
+                    d[e_z][l] = tz;
+                    d[e_ty][l] = k * fy;
+                    d[e_tz][l] = k * fz;
+                    d[e_qop][l] = 0.f;
+
+                    a[0][0][l] = qop * ty / n * fy +
+                                 k * (tz * b[1][l] - 2.f * ty * b[2][l]);
+                    a[0][1][l] = qop * tz / n * fy + k * (b[0][l] + ty * b[1][l]);
+                    a[0][2][l] = n * fy;
+                    a[1][0][l] = qop * ty / n * fz - k * (b[0][l] + tz * b[2][l]);
+                    a[1][1][l] = qop * tz / n * fz +
+                                 k * (2.f * tz * b[1][l] - ty * b[2][l]);
+                    a[1][2][l] = n * fz;
+                }
+            };
+
+            // A J of a stage
+            auto jacobian_derivative =
+                [](const motion_derivative &a, const lane_matrix<N> &j,
+                   lane_matrix<N> &dj)
+            {
+                for (unsigned int c = 0; c < 5u; ++c)
+                {
+                    for (std::size_t l = 0; l < N; ++l)
+                    {
+                        dj[e_y][c][l] = j[e_ty][c][l];
+                        dj[e_z][c][l] = j[e_tz][c][l];
+                        for (unsigned int r = 0; r < 2u; ++r)
+                        {
+                            dj[e_ty + r][c][l] = a[r][0][l] * j[e_ty][c][l] +
+                                                 a[r][1][l] * j[e_tz][c][l] +
+                                                 a[r][2][l] * j[e_qop][c][l];
+                        }
+                        dj[e_qop][c][l] = 0.f;
+                    }
+                }
+            };
+
+            lane_vector<N> k1, k2, k3, k4, tmp;
+            lane_matrix<N> j1, j2, j3, j4, jtmp;
+            motion_derivative a;
+            scalar x = x0;
+            for (std::size_t step = 0; step < n_steps; ++step)
+            {
+                derivative(x, s, k1, a);
+                jacobian_derivative(a, jacobian, j1);
+
+                add_scaled(s, 0.5f * h, k1, tmp);
+                add_scaled(jacobian, 0.5f * h, j1, jtmp);
+                derivative(x + 0.5f * h, tmp, k2, a);
+                jacobian_derivative(a, jtmp, j2);
+
+                add_scaled(s, 0.5f * h, k2, tmp);
+                add_scaled(jacobian, 0.5f * h, j2, jtmp);
+                derivative(x + 0.5f * h, tmp, k3, a);
+                jacobian_derivative(a, jtmp, j3);
+
+                add_scaled(s, h, k3, tmp);
+                add_scaled(jacobian, h, j3, jtmp);
+                derivative(x + h, tmp, k4, a);
+                jacobian_derivative(a, jtmp, j4);
+
+                for (unsigned int i = 0; i < 5u; ++i)
+                {
+                    for (std::size_t l = 0; l < N; ++l)
+                    {
+                        s[i][l] += h / 6.f *
+                                   (k1[i][l] + 2.f * k2[i][l] + 2.f * k3[i][l] +
+                                    k4[i][l]);
+                    }
+                    for (unsigned int c = 0; c < 5u; ++c)
+                    {
+                        for (std::size_t l = 0; l < N; ++l)
+                        {
+                            jacobian[i][c][l] +=
+                                h / 6.f *
+                                (j1[i][c][l] + 2.f * j2[i][c][l] +
+                                 2.f * j3[i][c][l] + j4[i][c][l]);
+                        }
+                    }
+                }
+                x += h;
+            }
+        }
+
+    } // namespace detail
+
+    /// Kalman fitter of same-topology telescope tracks, several at once
+    ///
+    /// Every BELLA track that is seen on all sensitive planes crosses the
+    /// same planes in the same order, so the fit is the same sequence of
+    /// steps for all of them. This fitter runs that sequence on batches of
+    /// @c lanes tracks, with the parameters and covariances stored as
+    /// structures of arrays and every arithmetic loop running over the
+    /// tracks innermost, so the compiler vectorizes it.
+    ///
+    /// The tracks are parametrized on the planes by (y, z, dy/dx, dz/dx,
+    /// q/p), with the planes perpendicular to x. Between planes they are
+    /// moved with RK4 steps in x through the field, with the transport
+    /// Jacobian integrated along the same steps; segments clear of the
+    /// magnets are straight lines with the exact Jacobian. Every plane,
+    /// sensitive or passive, adds multiple scattering (Highland) and the
+    /// mean Bethe-Bloch energy loss of its material. The forward filter is
+    /// followed by a Rauch-Tung-Striebel smoother.
+    ///
+    /// Tracks with holes, tracks not moving along +x and tracks whose fit
+    /// fails numerically are fitted with the scalar traccc fitter instead.
+    class batched_kalman_fitter
+    {
+
+    public:
+        /// Number of tracks fitted together
+        static constexpr std::size_t lanes = 8u;
+
+        /// Fitter configuration
+        struct config
+        {
+            /// Maximum RK4 step in the field
+            traccc::scalar max_step = 2.f * traccc::unit<traccc::scalar>::mm;
+            /// Particle hypothesis of the material effects
+            detray::pdg_particle<traccc::scalar> ptc_type =
+                detray::muon<traccc::scalar>();
+        };
+
+        using track_state_type = traccc::track_state<traccc::default_algebra>;
+
+        /// Constructor with the default configuration
+        ///
+        /// @param det Telescope the tracks are fitted in
+        explicit batched_kalman_fitter(const host_detector_type &det)
+            : batched_kalman_fitter(det, config{})
+        {
+        }
+
+        /// Constructor
+        ///
+        /// @param det Telescope the tracks are fitted in
+        /// @param cfg Fitter configuration
+        batched_kalman_fitter(const host_detector_type &det, const config &cfg)
+            : m_det(det), m_cfg(cfg)
+        {
+            using traccc::scalar;
+
+            const traccc::vector3 beam{1.f, 0.f, 0.f};
+            const auto &slabs = det.material_store().template get<
+                host_detector_type::materials::id::e_slab>();
+
+            for (const auto &desc : det.surfaces())
+            {
+                if (!desc.is_sensitive() && !desc.is_passive())
+                {
+                    continue;
+                }
+
+                const detray::tracking_surface sf{det, desc.barcode()};
+                const auto origin = sf.bound_to_global({}, {0.f, 0.f}, beam);
+                const auto u = sf.bound_to_global({}, {1.f, 0.f}, beam) - origin;
+                const auto v = sf.bound_to_global({}, {0.f, 1.f}, beam) - origin;
+                if (std::abs(u[0]) > 1e-6f || std::abs(v[0]) > 1e-6f)
+                {
+                    throw std::logic_error(
+                        "The batched fitter needs planes perpendicular to x");
+                }
+
+                const auto &slab = slabs.at(desc.material().index());
+                const auto &mat = slab.get_material();
+
+                plane p;
+                p.barcode = desc.barcode();
+                p.sensitive = desc.is_sensitive();
+                p.x = origin[0];
+                p.origin = {origin[1], origin[2]};
+                p.u = {u[1], u[2]};
+                p.v = {v[1], v[2]};
+                p.thickness = slab.thickness();
+                p.X0 = mat.X0();
+                p.Z = mat.Z();
+                p.Ar = mat.Ar();
+                p.density = mat.mass_density();
+                m_planes.push_back(p);
+            }
+
+            std::sort(m_planes.begin(), m_planes.end(),
+                      [](const plane &a, const plane &b)
+                      { return a.x < b.x; });
+
+            for (std::size_t i = 0; i < m_planes.size(); ++i)
+            {
+                if (m_planes[i].sensitive)
+                {
+                    m_sensitive.push_back(i);
+                }
+            }
+        }
+
+        /// Whether the candidate has one measurement on every sensitive
+        /// plane, in plane order
+        bool has_full_topology(
+            const vecmem::vector<traccc::track_candidate> &measurements) const
+        {
+            if (measurements.size() != m_sensitive.size())
+            {
+                return false;
+            }
+            for (std::size_t i = 0; i < measurements.size(); ++i)
+            {
+                if (measurements[i].surface_link !=
+                    m_planes[m_sensitive[i]].barcode)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /// Fit the track candidates of one event
+        ///
+        /// @param field            Magnetic field
+        /// @param track_candidates Track candidates of the event
+        /// @param fallback         Scalar fitting algorithm of the tracks
+        ///                         the batches do not take
+        /// @param mr               Memory resource of the fitted tracks
+        /// @return The fitted tracks, in the order of @c track_candidates
+        template <typename field_t, typename fitting_algorithm_t>
+        traccc::track_state_container_types::host operator()(
+            const field_t &field,
+            const traccc::track_candidate_container_types::host &track_candidates,
+            const fitting_algorithm_t &fallback, vecmem::memory_resource &mr) const
+        {
+            const std::size_t n_tracks = track_candidates.size();
+            const typename field_t::view_t field_view(field);
+
+            std::vector<std::size_t> batched;
+            std::vector<std::size_t> scalar;
+            for (std::size_t i = 0; i < n_tracks; ++i)
+            {
+                const auto &header = track_candidates.at(i).header;
+                const bool forward =
+                    std::cos(header.phi()) * std::sin(header.theta()) > 0.1f;
+                if (forward && has_full_topology(track_candidates.at(i).items))
+                {
+                    batched.push_back(i);
+                }
+                else
+                {
+                    scalar.push_back(i);
+                }
+            }
+
+            std::vector<fit_output> results(n_tracks);
+            std::vector<bool> fitted(n_tracks, false);
+
+            for (std::size_t first = 0; first < batched.size(); first += lanes)
+            {
+                // Pad the last batch with copies of its last track
+                std::array<std::size_t, lanes> tracks;
+                for (std::size_t l = 0; l < lanes; ++l)
+                {
+                    tracks[l] = batched[std::min(first + l, batched.size() - 1u)];
+                }
+
+                std::array<bool, lanes> ok;
+                std::array<fit_output, lanes> out;
+                fit_batch(field_view, track_candidates, tracks, ok, out, mr);
+
+                for (std::size_t l = 0; l < lanes && first + l < batched.size();
+                     ++l)
+                {
+                    if (ok[l])
+                    {
+                        results[tracks[l]] = std::move(out[l]);
+                        fitted[tracks[l]] = true;
+                    }
+                    else
+                    {
+                        scalar.push_back(tracks[l]);
+                    }
+                }
+            }
+
+            // The rest goes through the scalar fitter
+            std::sort(scalar.begin(), scalar.end());
+            traccc::track_candidate_container_types::host rest{&mr};
+            for (const std::size_t i : scalar)
+            {
+                rest.push_back(track_candidates.at(i).header,
+                               track_candidates.at(i).items);
+            }
+            auto rest_states = fallback(m_det, field, rest);
+
+            traccc::track_state_container_types::host track_states{&mr};
+            track_states.reserve(n_tracks);
+            std::size_t next_rest = 0u;
+            for (std::size_t i = 0; i < n_tracks; ++i)
+            {
+                if (fitted[i])
+                {
+                    track_states.push_back(std::move(results[i].result),
+                                           std::move(results[i].states));
+                }
+                else
+                {
+                    track_states.push_back(
+                        std::move(rest_states.at(next_rest).header),
+                        std::move(rest_states.at(next_rest).items));
+                    ++next_rest;
+                }
+            }
+            return track_states;
+        }
+
+    private:
+        /// Sensitive or passive plane, with its local axes in (y, z)
+        struct plane
+        {
+            detray::geometry::barcode barcode;
+            bool sensitive;
+            traccc::scalar x;
+            std::array<traccc::scalar, 2> origin;
+            std::array<traccc::scalar, 2> u;
+            std::array<traccc::scalar, 2> v;
+            traccc::scalar thickness;
+            traccc::scalar X0;
+            traccc::scalar Z;
+            traccc::scalar Ar;
+            traccc::scalar density;
+        };
+
+        /// Fitted track
+        struct fit_output
+        {
+            traccc::fitting_result<traccc::default_algebra> result;
+            vecmem::vector<track_state_type> states;
+        };
+
+        using lane_vector = detail::lane_vector<lanes>;
+        using lane_matrix = detail::lane_matrix<lanes>;
+
+        /// Move the batch from @c x0 to @c x1, with the transport Jacobian
+        template <typename field_view_t>
+        void transport(const field_view_t &field, const traccc::scalar x0,
+                       const traccc::scalar x1, lane_vector &s,
+                       lane_matrix &jacobian) const
+        {
+            using traccc::scalar;
+            using namespace detail;
+
+            const scalar dx = x1 - x0;
+
+            // Straight line when the whole batch stays clear of the magnets
+            bool straight = false;
+            if constexpr (requires(const std::array<scalar, 3> &p) {
+                              field.is_field_free(p, p);
+                          })
+            {
+                straight = true;
+                for (std::size_t l = 0; l < lanes && straight; ++l)
+                {
+                    const std::array<scalar, 3> a{x0, s[e_y][l], s[e_z][l]};
+                    const std::array<scalar, 3> b{x1, s[e_y][l] + dx * s[e_ty][l],
+                                                  s[e_z][l] + dx * s[e_tz][l]};
+                    straight = field.is_field_free(a, b);
+                }
+            }
+
+            if (straight)
+            {
+                for (std::size_t l = 0; l < lanes; ++l)
+                {
+                    s[e_y][l] += dx * s[e_ty][l];
+                    s[e_z][l] += dx * s[e_tz][l];
+                }
+                jacobian = identity<lanes>();
+                jacobian[e_y][e_ty].fill(dx);
+                jacobian[e_z][e_tz].fill(dx);
+                return;
+            }
+
+            propagate(field, x0, x1, m_cfg.max_step, s, jacobian);
+        }
+
+        /// Add the multiple scattering and the energy loss of @c p
+        void add_material(const plane &p, lane_vector &s, lane_matrix &cov) const
+        {
+            using traccc::scalar;
+            using namespace detail;
+            using unit = traccc::unit<scalar>;
+
+            const scalar m = m_cfg.ptc_type.mass();
+            const scalar q = std::abs(m_cfg.ptc_type.charge());
+            const scalar me = 0.51099895f * unit::MeV;
+            // 4 pi N_A r_e^2 m_e c^2
+            const scalar K = 0.307075f * unit::MeV * unit::cm * unit::cm;
+            // Mean excitation energy approximation, as in detray
+            const scalar I = 16.f * unit::eV * std::pow(p.Z, 0.9f);
+            // Electrons per volume, in mol
+            const scalar electron_density = p.Z / p.Ar * p.density / unit::g;
+
+            for (std::size_t l = 0; l < lanes; ++l)
+            {
+                const scalar ty = s[e_ty][l];
+                const scalar tz = s[e_tz][l];
+                const scalar n2 = 1.f + ty * ty + tz * tz;
+                const scalar path = p.thickness * std::sqrt(n2);
+
+                const scalar mom = q / std::abs(s[e_qop][l]);
+                const scalar E = std::sqrt(mom * mom + m * m);
+                const scalar beta2 = (mom * mom) / (E * E);
+                const scalar bg2 = (mom * mom) / (m * m);
+                const scalar gamma = E / m;
+
+                // Highland formula
+                const scalar x_X0 = path / p.X0;
+                const scalar theta0 =
+                    13.6f * unit::MeV / (std::sqrt(beta2) * mom) * q *
+                    std::sqrt(x_X0) *
+                    (1.f + 0.038f * std::log(x_X0 * q * q / beta2));
+                const scalar var = theta0 * theta0 * n2;
+                cov[e_ty][e_ty][l] += var * (1.f + ty * ty);
+                cov[e_tz][e_tz][l] += var * (1.f + tz * tz);
+                cov[e_ty][e_tz][l] += var * ty * tz;
+                cov[e_tz][e_ty][l] += var * ty * tz;
+
+                // Mean Bethe-Bloch energy loss, without density correction
+                const scalar t_max = 2.f * me * bg2 /
+                                     (1.f + 2.f * gamma * me / m + (me * me) / (m * m));
+                const scalar dedx =
+                    K * q * q * electron_density / beta2 *
+                    (0.5f * std::log(2.f * me * bg2 * t_max / (I * I)) - beta2);
+                const scalar E_out = std::max(E - dedx * path, m * 1.000001f);
+                const scalar mom_out = std::sqrt(E_out * E_out - m * m);
+
+                const scalar ratio = mom / mom_out;
+                s[e_qop][l] *= ratio;
+                for (unsigned int i = 0; i < 5u; ++i)
+                {
+                    cov[e_qop][i][l] *= ratio;
+                    cov[i][e_qop][l] *= ratio;
+                }
+            }
+        }
+
+        /// Telescope frame parameters and covariance of a bound seed
+        void from_bound(const plane &p, const traccc::bound_track_parameters &bound,
+                        lane_vector &s, lane_matrix &cov, const std::size_t l) const
+        {
+            using namespace detail;
+
+            const auto local = bound.bound_local();
+            const traccc::scalar phi = bound.phi();
+            const traccc::scalar theta = bound.theta();
+
+            s[e_y][l] = p.origin[0] + local[0] * p.u[0] + local[1] * p.v[0];
+            s[e_z][l] = p.origin[1] + local[0] * p.u[1] + local[1] * p.v[1];
+            s[e_ty][l] = std::tan(phi);
+            s[e_tz][l] = 1.f / (std::tan(theta) * std::cos(phi));
+            s[e_qop][l] = bound.qop();
+
+            // d(y, z, ty, tz, qop)/d(loc0, loc1, phi, theta, qop)
+            std::array<std::array<traccc::scalar, 5>, 5> J{};
+            J[e_y][0] = p.u[0];
+            J[e_y][1] = p.v[0];
+            J[e_z][0] = p.u[1];
+            J[e_z][1] = p.v[1];
+            J[e_ty][2] = 1.f / (std::cos(phi) * std::cos(phi));
+            J[e_tz][2] = std::sin(phi) / (std::tan(theta) * std::cos(phi) * std::cos(phi));
+            J[e_tz][3] = -1.f / (std::sin(theta) * std::sin(theta) * std::cos(phi));
+            J[e_qop][4] = 1.f;
+
+            const std::array<unsigned int, 5> bound_index{
+                traccc::e_bound_loc0, traccc::e_bound_loc1, traccc::e_bound_phi,
+                traccc::e_bound_theta, traccc::e_bound_qoverp};
+            const auto &bound_cov = bound.covariance();
+
+            for (unsigned int i = 0; i < 5u; ++i)
+            {
+                for (unsigned int j = 0; j < 5u; ++j)
+                {
+                    traccc::scalar c = 0.f;
+                    for (unsigned int a = 0; a < 5u; ++a)
+                    {
+                        for (unsigned int b = 0; b < 5u; ++b)
+                        {
+                            c += J[i][a] *
+                                 traccc::getter::element(bound_cov, bound_index[a],
+                                                         bound_index[b]) *
+                                 J[j][b];
+                        }
+                    }
+                    cov[i][j][l] = c;
+                }
+            }
+        }
+
+        /// Bound parameters on @c p of the lane @c l
+        traccc::bound_track_parameters to_bound(
+            const plane &p, const lane_vector &s, const lane_matrix &cov,
+            const std::size_t l,
+            const traccc::bound_track_parameters &seed) const
+        {
+            using traccc::scalar;
+            using namespace detail;
+
+            const scalar dy = s[e_y][l] - p.origin[0];
+            const scalar dz = s[e_z][l] - p.origin[1];
+            const scalar ty = s[e_ty][l];
+            const scalar tz = s[e_tz][l];
+            const scalar n = std::sqrt(1.f + ty * ty + tz * tz);
+            const scalar theta = std::acos(tz / n);
+            const scalar sin_theta = std::sin(theta);
+
+            // d(loc0, loc1, phi, theta, qop)/d(y, z, ty, tz, qop)
+            std::array<std::array<scalar, 5>, 5> J{};
+            J[0][e_y] = p.u[0];
+            J[0][e_z] = p.u[1];
+            J[1][e_y] = p.v[0];
+            J[1][e_z] = p.v[1];
+            J[2][e_ty] = 1.f / (1.f + ty * ty);
+            J[3][e_ty] = ty * tz / (sin_theta * n * n * n);
+            J[3][e_tz] = -(1.f + ty * ty) / (sin_theta * n * n * n);
+            J[4][e_qop] = 1.f;
+
+            const std::array<unsigned int, 5> bound_index{
+                traccc::e_bound_loc0, traccc::e_bound_loc1, traccc::e_bound_phi,
+                traccc::e_bound_theta, traccc::e_bound_qoverp};
+
+            auto bound_cov = seed.covariance();
+            for (unsigned int i = 0; i < 5u; ++i)
+            {
+                for (unsigned int j = 0; j < 5u; ++j)
+                {
+                    scalar c = 0.f;
+                    for (unsigned int a = 0; a < 5u; ++a)
+                    {
+                        for (unsigned int b = 0; b < 5u; ++b)
+                        {
+                            c += J[i][a] * cov[a][b][l] * J[j][b];
+                        }
+                    }
+                    traccc::getter::element(bound_cov, bound_index[i],
+                                            bound_index[j]) = c;
+                }
+            }
+
+            traccc::bound_track_parameters bound = seed;
+            bound.set_surface_link(p.barcode);
+            // The local axes are orthonormal in the (y, z) plane
+            bound.set_bound_local({dy * p.u[0] + dz * p.u[1],
+                                   dy * p.v[0] + dz * p.v[1]});
+            bound.set_phi(std::atan(ty));
+            bound.set_theta(theta);
+            bound.set_qop(s[e_qop][l]);
+            bound.set_covariance(bound_cov);
+            return bound;
+        }
+
+        /// Fit the tracks @c tracks of @c track_candidates together
+        template <typename field_view_t>
+        void fit_batch(
+            const field_view_t &field,
+            const traccc::track_candidate_container_types::host &track_candidates,
+            const std::array<std::size_t, lanes> &tracks,
+            std::array<bool, lanes> &ok, std::array<fit_output, lanes> &out,
+            vecmem::memory_resource &mr) const
+        {
+            using traccc::scalar;
+            using namespace detail;
+
+            const std::size_t n_planes = m_planes.size();
+            ok.fill(true);
+
+            // Filtered (before the material of the plane) and predicted
+            // states of every plane, and the transport to the next plane
+            std::vector<lane_vector> filtered(n_planes), predicted(n_planes);
+            std::vector<lane_matrix> filtered_cov(n_planes), predicted_cov(n_planes);
+            std::vector<lane_matrix> jacobians(n_planes);
+
+            // The seeds are bound to the first sensitive plane
+            const std::size_t first = m_sensitive.front();
+            for (std::size_t l = 0; l < lanes; ++l)
+            {
+                from_bound(m_planes[first], track_candidates.at(tracks[l]).header,
+                           predicted[first], predicted_cov[first], l);
+            }
+
+            lane_array<lanes> chi2{};
+            std::size_t n_meas = 0u;
+
+            for (std::size_t k = first; k < n_planes; ++k)
+            {
+                const plane &p = m_planes[k];
+                lane_vector s = predicted[k];
+                lane_matrix cov = predicted_cov[k];
+
+                if (p.sensitive)
+                {
+                    // Measurements of the batch in (y, z)
+                    std::array<lane_array<lanes>, 2> m;
+                    std::array<lane_array<lanes>, 3> V;
+                    for (std::size_t l = 0; l < lanes; ++l)
+                    {
+                        const traccc::measurement &meas =
+                            track_candidates.at(tracks[l]).items[n_meas];
+                        const scalar l0 = meas.local[0];
+                        const scalar l1 = meas.local[1];
+                        const scalar v0 = meas.variance[0];
+                        const scalar v1 = meas.variance[1];
+                        m[0][l] = p.origin[0] + l0 * p.u[0] + l1 * p.v[0];
+                        m[1][l] = p.origin[1] + l0 * p.u[1] + l1 * p.v[1];
+                        V[0][l] = p.u[0] * p.u[0] * v0 + p.v[0] * p.v[0] * v1;
+                        V[1][l] = p.u[0] * p.u[1] * v0 + p.v[0] * p.v[1] * v1;
+                        V[2][l] = p.u[1] * p.u[1] * v0 + p.v[1] * p.v[1] * v1;
+                    }
+                    ++n_meas;
+
+                    for (std::size_t l = 0; l < lanes; ++l)
+                    {
+                        const scalar s00 = cov[0][0][l] + V[0][l];
+                        const scalar s01 = cov[0][1][l] + V[1][l];
+                        const scalar s11 = cov[1][1][l] + V[2][l];
+                        const scalar det = s00 * s11 - s01 * s01;
+                        ok[l] = ok[l] && det > 0.f;
+                        const scalar inv_det = det > 0.f ? 1.f / det : 0.f;
+                        const scalar i00 = s11 * inv_det;
+                        const scalar i01 = -s01 * inv_det;
+                        const scalar i11 = s00 * inv_det;
+
+                        const scalar r0 = m[0][l] - s[e_y][l];
+                        const scalar r1 = m[1][l] - s[e_z][l];
+                        chi2[l] += r0 * (i00 * r0 + i01 * r1) + r1 * (i01 * r0 + i11 * r1);
+
+                        std::array<scalar, 5> k0, k1, row0, row1;
+                        for (unsigned int i = 0; i < 5u; ++i)
+                        {
+                            k0[i] = cov[i][0][l] * i00 + cov[i][1][l] * i01;
+                            k1[i] = cov[i][0][l] * i01 + cov[i][1][l] * i11;
+                            row0[i] = cov[0][i][l];
+                            row1[i] = cov[1][i][l];
+                        }
+                        for (unsigned int i = 0; i < 5u; ++i)
+                        {
+                            s[i][l] += k0[i] * r0 + k1[i] * r1;
+                            for (unsigned int j = 0; j < 5u; ++j)
+                            {
+                                cov[i][j][l] -= k0[i] * row0[j] + k1[i] * row1[j];
+                            }
+                        }
+                    }
+                }
+
+                filtered[k] = s;
+                filtered_cov[k] = cov;
+
+                if (k + 1u == n_planes)
+                {
+                    break;
+                }
+
+                // Predict the next plane
+                add_material(p, s, cov);
+                transport(field, p.x, m_planes[k + 1u].x, s, jacobians[k]);
+                predicted[k + 1u] = s;
+                predicted_cov[k + 1u] =
+                    multiply_transposed(multiply(jacobians[k], cov), jacobians[k]);
+            }
+
+            // Rauch-Tung-Striebel smoother
+            std::vector<lane_vector> smoothed = filtered;
+            std::vector<lane_matrix> smoothed_cov = filtered_cov;
+            for (std::size_t k = n_planes - 1u; k-- > first;)
+            {
+                const lane_matrix predicted_inv = invert(predicted_cov[k + 1u], ok);
+                // A = C_k|k F^T C_k+1|k^-1
+                const lane_matrix gain = multiply(
+                    multiply_transposed(filtered_cov[k], jacobians[k]), predicted_inv);
+
+                lane_vector diff;
+                lane_matrix cov_diff;
+                for (unsigned int i = 0; i < 5u; ++i)
+                {
+                    for (std::size_t l = 0; l < lanes; ++l)
+                    {
+                        diff[i][l] = smoothed[k + 1u][i][l] - predicted[k + 1u][i][l];
+                    }
+                    for (unsigned int j = 0; j < 5u; ++j)
+                    {
+                        for (std::size_t l = 0; l < lanes; ++l)
+                        {
+                            cov_diff[i][j][l] = smoothed_cov[k + 1u][i][j][l] -
+                                                predicted_cov[k + 1u][i][j][l];
+                        }
+                    }
+                }
+
+                for (unsigned int i = 0; i < 5u; ++i)
+                {
+                    for (unsigned int j = 0; j < 5u; ++j)
+                    {
+                        for (std::size_t l = 0; l < lanes; ++l)
+                        {
+                            smoothed[k][i][l] += gain[i][j][l] * diff[j][l];
+                        }
+                    }
+                }
+                const lane_matrix correction =
+                    multiply_transposed(multiply(gain, cov_diff), gain);
+                for (unsigned int i = 0; i < 5u; ++i)
+                {
+                    for (unsigned int j = 0; j < 5u; ++j)
+                    {
+                        for (std::size_t l = 0; l < lanes; ++l)
+                        {
+                            smoothed_cov[k][i][j][l] += correction[i][j][l];
+                        }
+                    }
+                }
+            }
+
+            // Track states of the measurements
+            for (std::size_t l = 0; l < lanes; ++l)
+            {
+                for (std::size_t k = first; k < n_planes && ok[l]; ++k)
+                {
+                    for (unsigned int i = 0; i < 5u; ++i)
+                    {
+                        ok[l] = ok[l] && std::isfinite(smoothed[k][i][l]);
+                    }
+                }
+                if (!ok[l])
+                {
+                    continue;
+                }
+
+                const auto &candidate = track_candidates.at(tracks[l]);
+                out[l].states = vecmem::vector<track_state_type>(&mr);
+                out[l].states.reserve(n_meas);
+                for (std::size_t i = 0; i < m_sensitive.size(); ++i)
+                {
+                    const plane &p = m_planes[m_sensitive[i]];
+                    track_state_type st(candidate.items[i]);
+                    st.filtered() = to_bound(p, filtered[m_sensitive[i]],
+                                             filtered_cov[m_sensitive[i]], l,
+                                             candidate.header);
+                    st.smoothed() = to_bound(p, smoothed[m_sensitive[i]],
+                                             smoothed_cov[m_sensitive[i]], l,
+                                             candidate.header);
+                    out[l].states.push_back(st);
+                }
+
+                out[l].result.fit_params = out[l].states.front().smoothed();
+                out[l].result.chi2 = chi2[l];
+                out[l].result.ndf = static_cast<scalar>(2u * n_meas) - 5.f;
+            }
+        }
+
+        const host_detector_type &m_det;
+        config m_cfg;
+
+        /// Sensitive and passive planes, in ascending x
+        std::vector<plane> m_planes;
+        /// Indices of the sensitive planes in @c m_planes
+        std::vector<std::size_t> m_sensitive;
+
+    }; // class batched_kalman_fitter
+
+    /// Make the batched fitter configuration of the fitting options
+    inline batched_kalman_fitter::config make_batched_fitter_config(
+        const traccc::opts::fitting_options &opts)
+    {
+        if (!(opts.max_step > 0.f))
+        {
+            throw std::invalid_argument("--fit-max-step must be positive");
+        }
+
+        batched_kalman_fitter::config cfg;
+        cfg.max_step = opts.max_step * traccc::unit<traccc::scalar>::mm;
+        cfg.ptc_type =
+            traccc::detail::particle_from_pdg_number<traccc::scalar>(opts.particle);
+        if (cfg.ptc_type.charge() == 0.f)
+        {
+            throw std::invalid_argument("The fit particle must be charged: " +
+                                        std::to_string(opts.particle));
+        }
+        return cfg;
+    }
+
+} // namespace bella
@@ -0,0 +1,200 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Project include(s).
+#include "traccc/definitions/common.hpp"
+#include "traccc/definitions/primitives.hpp"
+#include "traccc/simulation/measurement_smearer.hpp"
+#include "traccc/simulation/simulator.hpp"
+
+// detray include(s).
+#include "detray/definitions/pdg_particle.hpp"
+
+// Local include(s).
+#include "src/bounded_queue.hpp"
+#include "src/event_store.hpp"
+#include "src/field_map.hpp"
+#include "src/geometry_config.hpp"
+#include "src/magnet_field.hpp"
+#include "src/memory_writer.hpp"
+#include "src/telescope_detector.hpp"
+#include "src/track_generator.hpp"
+
+// VecMem include(s).
+#include <vecmem/memory/host_memory_resource.hpp>
+
+// Google Benchmark include(s).
+#include <benchmark/benchmark.h>
+
+// System include(s).
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace bella::benchmarks
+{
+
+    /// Momenta of the benchmarked muons [MeV]
+    inline const std::vector<std::int64_t> momenta_mev{100, 1000, 10000};
+
+    /// Muons per event of the benchmarked events
+    inline const std::vector<std::int64_t> multiplicities{1, 10, 100};
+
+    /// Benchmark every momentum and multiplicity
+    ///
+    /// The benchmark receives the momentum in MeV as @c range(0) and the
+    /// number of muons per event as @c range(1).
+    inline void momentum_and_multiplicity(benchmark::internal::Benchmark *b)
+    {
+        b->ArgNames({"p_MeV", "muons"});
+        b->ArgsProduct({momenta_mev, multiplicities});
+    }
+
+    /// Particle type of the benchmarked tracks
+    inline detray::pdg_particle<traccc::scalar> particle()
+    {
+        return detray::muon<traccc::scalar>();
+    }
+
+    /// The default BELLA layout and magnets
+    inline const geometry_config &geometry()
+    {
+        static const geometry_config cfg{};
+        return cfg;
+    }
+
+    /// Memory resource of the benchmark setup
+    inline vecmem::host_memory_resource &host_mr()
+    {
+        static vecmem::host_memory_resource mr;
+        return mr;
+    }
+
+    /// The telescope and its volume names, built once for all benchmarks
+    inline const auto &telescope_and_names()
+    {
+        static const auto detector = build_detector(host_mr(), geometry());
+        return detector;
+    }
+
+    /// The telescope, built once for all benchmarks
+    inline const host_detector_type &telescope()
+    {
+        return std::get<0>(telescope_and_names());
+    }
+
+    /// Analytic field of the BELLA magnets
+    inline const magnet_field &magnets()
+    {
+        // Edge width of the default field map spacing
+        static const magnet_field field(geometry().magnets, 10.f);
+        return field;
+    }
+
+    /// Field map that write_bfield makes of the BELLA magnets
+    inline const grid_field_type &field_map()
+    {
+        static const grid_field_type field = make_field_map(
+            geometry().magnets, field_grid{}, std::thread::hardware_concurrency());
+        return field;
+    }
+
+    /// Field of the field model @c field_t
+    template <typename field_t>
+    const field_t &field();
+
+    template <>
+    inline const grid_field_type &field<grid_field_type>()
+    {
+        return field_map();
+    }
+
+    template <>
+    inline const magnet_field &field<magnet_field>()
+    {
+        return magnets();
+    }
+
+    /// Generator of @c n_muons muons of momentum @c p_mev along the beam
+    inline generator_type::configuration beam_generator(const std::int64_t p_mev,
+                                                        const std::int64_t n_muons)
+    {
+        using traccc::scalar;
+
+        const scalar p = static_cast<scalar>(p_mev) * traccc::unit<scalar>::MeV;
+        const scalar theta = 90.f * traccc::unit<scalar>::degree;
+
+        generator_type::configuration gen_cfg{};
+        gen_cfg.n_tracks(static_cast<std::size_t>(n_muons));
+        gen_cfg.origin(traccc::point3{0.f, 0.f, 0.f});
+        gen_cfg.phi_range(0.f, 0.f);
+        gen_cfg.theta_range(theta, theta);
+        gen_cfg.mom_range(p, p);
+        gen_cfg.charge(particle().charge());
+
+        return gen_cfg;
+    }
+
+    /// Measurement smearing of the simulation executables
+    using smearer_type = traccc::measurement_smearer<traccc::default_algebra>;
+
+    inline smearer_type make_smearer()
+    {
+        return smearer_type(50.f * traccc::unit<traccc::scalar>::mm,
+                            50.f * traccc::unit<traccc::scalar>::mm);
+    }
+
+    /// Simulate @c n_events events of the generator @c gen_cfg in memory
+    template <typename field_t>
+    std::vector<truth_event> simulate_events(
+        const field_t &b_field, const generator_type::configuration &gen_cfg,
+        const std::size_t n_events)
+    {
+        using writer_type = memory_writer<smearer_type>;
+
+        // Room for every event, so the simulation never waits on the queue
+        bounded_queue<truth_event> queue(n_events + 1u);
+
+        typename writer_type::config writer_cfg{make_smearer(), particle(),
+                                                &queue};
+
+        auto sim = traccc::simulator<const host_detector_type, field_t,
+                                     generator_type, writer_type>(
+            particle(), n_events, telescope(), b_field, generator_type(gen_cfg),
+            std::move(writer_cfg), "");
+        sim.run();
+        queue.close();
+
+        std::vector<truth_event> events;
+        while (auto evt = queue.pop())
+        {
+            events.push_back(std::move(*evt));
+        }
+        return events;
+    }
+
+    /// Directory of the files written by the benchmarks
+    inline const std::filesystem::path &scratch_directory()
+    {
+        static const std::filesystem::path dir = []()
+        {
+            const auto path =
+                std::filesystem::temp_directory_path() / "bella_benchmarks";
+            std::filesystem::create_directories(path);
+            return path;
+        }();
+        return dir;
+    }
+
+} // namespace bella::benchmarks
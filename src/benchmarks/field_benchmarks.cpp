@@ -0,0 +1,107 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+// Project include(s).
+#include "traccc/definitions/common.hpp"
+
+// Local include(s).
+#include "src/benchmarks/benchmark_setup.hpp"
+#include "src/field_model.hpp"
+#include "src/magnet_field.hpp"
+
+// Google Benchmark include(s).
+#include <benchmark/benchmark.h>
+
+// System include(s).
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+    /// Number of positions looked up per iteration
+    constexpr std::size_t n_positions = 4096u;
+
+    /// Positions along the beam, inside the telescope and around the
+    /// magnets [internal units]
+    ///
+    /// @param half_width Half width of the sampled region in y and z [mm]
+    std::vector<std::array<float, 3>> beam_positions(const float half_width)
+    {
+        const float mm = traccc::unit<float>::mm;
+
+        std::mt19937 gen(42u);
+        std::uniform_real_distribution<float> x(0.f, 260.f * mm);
+        std::uniform_real_distribution<float> yz(-half_width * mm, half_width * mm);
+
+        std::vector<std::array<float, 3>> positions(n_positions);
+        for (auto &p : positions)
+        {
+            p = {x(gen), yz(gen), yz(gen)};
+        }
+        return positions;
+    }
+
+    /// Field lookup at random positions along the beam
+    ///
+    /// @c range(0) is the half width of the sampled region in mm; a few mm
+    /// is where the muons fly, a few times the magnet size mostly misses
+    /// the magnets.
+    template <typename field_t>
+    void BM_FieldLookup(benchmark::State &state)
+    {
+        const typename field_t::view_t view(
+            bella::benchmarks::field<field_t>());
+        const auto positions = beam_positions(static_cast<float>(state.range(0)));
+
+        for (auto _ : state)
+        {
+            for (const auto &p : positions)
+            {
+                benchmark::DoNotOptimize(view.at(p[0], p[1], p[2]));
+            }
+        }
+
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() *
+                                                          positions.size()));
+    }
+
+    /// Straight segment test of the gap stepper, segments of one
+    /// plane pitch along the beam
+    void BM_FieldFreeTest(benchmark::State &state)
+    {
+        const bella::magnet_field_view view(bella::benchmarks::magnets());
+        const auto positions = beam_positions(static_cast<float>(state.range(0)));
+        const float pitch = 10.f * traccc::unit<float>::mm;
+
+        for (auto _ : state)
+        {
+            for (const auto &p : positions)
+            {
+                const std::array<float, 3> end{p[0] + pitch, p[1], p[2]};
+                benchmark::DoNotOptimize(view.is_field_free(p, end));
+            }
+        }
+
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() *
+                                                          positions.size()));
+    }
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_FieldLookup, bella::grid_field_type)
+    ->ArgName("half_width_mm")
+    ->Arg(5)
+    ->Arg(50);
+BENCHMARK_TEMPLATE(BM_FieldLookup, bella::magnet_field)
+    ->ArgName("half_width_mm")
+    ->Arg(5)
+    ->Arg(50);
+BENCHMARK(BM_FieldFreeTest)->ArgName("half_width_mm")->Arg(5)->Arg(50);
@@ -0,0 +1,112 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+// Project include(s).
+#include "traccc/fitting/fitting_algorithm.hpp"
+#include "traccc/fitting/kalman_filter/kalman_fitter.hpp"
+
+// detray include(s).
+#include "detray/navigation/navigator.hpp"
+
+// Local include(s).
+#include "src/batched_kalman_fitter.hpp"
+#include "src/benchmarks/benchmark_setup.hpp"
+#include "src/event_store.hpp"
+#include "src/field_model.hpp"
+#include "src/gap_stepper.hpp"
+#include "src/magnet_field.hpp"
+#include "src/truth_fitting.hpp"
+
+// Google Benchmark include(s).
+#include <benchmark/benchmark.h>
+
+// System include(s).
+#include <cstdint>
+
+namespace
+{
+
+    /// Kalman fit of the truth track candidates of one simulated event
+    ///
+    /// The event is simulated and its candidates are made before the timing
+    /// starts, so only the fit itself is measured.
+    template <typename field_t>
+    void BM_KalmanFit(benchmark::State &state)
+    {
+        using detector_type = bella::host_detector_type;
+        using fitter_type =
+            traccc::kalman_fitter<bella::stepper_type<field_t>,
+                                  detray::navigator<const detector_type>>;
+
+        const detector_type &det = bella::benchmarks::telescope();
+        const field_t &b_field = bella::benchmarks::field<field_t>();
+        auto &mr = bella::benchmarks::host_mr();
+
+        const auto events = bella::benchmarks::simulate_events(
+            b_field,
+            bella::benchmarks::beam_generator(state.range(0), state.range(1)),
+            1u);
+        const auto candidates =
+            bella::generate_truth_candidates(det, events.at(0).view(), mr);
+
+        const traccc::fitting_algorithm<fitter_type> fitting(
+            typename traccc::fitting_algorithm<fitter_type>::config_type{});
+
+        for (auto _ : state)
+        {
+            auto track_states = fitting(det, b_field, candidates);
+            benchmark::DoNotOptimize(track_states);
+        }
+
+        state.SetItemsProcessed(
+            static_cast<std::int64_t>(state.iterations() * candidates.size()));
+    }
+
+    /// The same fit with the batched fitter, falling back to the scalar one
+    template <typename field_t>
+    void BM_BatchedKalmanFit(benchmark::State &state)
+    {
+        using detector_type = bella::host_detector_type;
+        using fitter_type =
+            traccc::kalman_fitter<bella::stepper_type<field_t>,
+                                  detray::navigator<const detector_type>>;
+
+        const detector_type &det = bella::benchmarks::telescope();
+        const field_t &b_field = bella::benchmarks::field<field_t>();
+        auto &mr = bella::benchmarks::host_mr();
+
+        const auto events = bella::benchmarks::simulate_events(
+            b_field,
+            bella::benchmarks::beam_generator(state.range(0), state.range(1)),
+            1u);
+        const auto candidates =
+            bella::generate_truth_candidates(det, events.at(0).view(), mr);
+
+        const traccc::fitting_algorithm<fitter_type> fallback(
+            typename traccc::fitting_algorithm<fitter_type>::config_type{});
+        const bella::batched_kalman_fitter fitting(det);
+
+        for (auto _ : state)
+        {
+            auto track_states = fitting(b_field, candidates, fallback, mr);
+            benchmark::DoNotOptimize(track_states);
+        }
+
+        state.SetItemsProcessed(
+            static_cast<std::int64_t>(state.iterations() * candidates.size()));
+    }
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_KalmanFit, bella::grid_field_type)
+    ->Apply(bella::benchmarks::momentum_and_multiplicity);
+BENCHMARK_TEMPLATE(BM_KalmanFit, bella::magnet_field)
+    ->Apply(bella::benchmarks::momentum_and_multiplicity);
+BENCHMARK_TEMPLATE(BM_BatchedKalmanFit, bella::grid_field_type)
+    ->Apply(bella::benchmarks::momentum_and_multiplicity);
+BENCHMARK_TEMPLATE(BM_BatchedKalmanFit, bella::magnet_field)
+    ->Apply(bella::benchmarks::momentum_and_multiplicity);
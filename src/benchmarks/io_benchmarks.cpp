@@ -0,0 +1,177 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+// Project include(s).
+#include "traccc/simulation/simulator.hpp"
+#include "traccc/simulation/smearing_writer.hpp"
+
+// Local include(s).
+#include "src/benchmarks/benchmark_setup.hpp"
+#include "src/csv_event.hpp"
+#include "src/event_store.hpp"
+#include "src/fit_output.hpp"
+#include "src/track_records.hpp"
+#include "src/truth_fitting.hpp"
+
+// VecMem include(s).
+#include <vecmem/memory/host_memory_resource.hpp>
+
+// Google Benchmark include(s).
+#include <benchmark/benchmark.h>
+
+// System include(s).
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <utility>
+
+namespace
+{
+
+    /// Directory holding one simulated csv event of the benchmark arguments
+    std::string csv_event_directory(const std::int64_t p_mev,
+                                    const std::int64_t n_muons)
+    {
+        using writer_type =
+            traccc::smearing_writer<bella::benchmarks::smearer_type>;
+
+        const std::string dir = (bella::benchmarks::scratch_directory() /
+                                 ("csv_" + std::to_string(p_mev) + "_MeV_" +
+                                  std::to_string(n_muons) + "_muons"))
+                                    .string() +
+                                "/";
+        std::filesystem::create_directories(dir);
+
+        typename writer_type::config writer_cfg{bella::benchmarks::make_smearer()};
+
+        auto sim = traccc::simulator<const bella::host_detector_type,
+                                     bella::magnet_field, bella::generator_type,
+                                     writer_type>(
+            bella::benchmarks::particle(), 1u, bella::benchmarks::telescope(),
+            bella::benchmarks::magnets(),
+            bella::generator_type(
+                bella::benchmarks::beam_generator(p_mev, n_muons)),
+            std::move(writer_cfg), dir);
+        sim.run();
+
+        return dir;
+    }
+
+    /// Loading of one csv event up to its truth track candidates, as the
+    /// fitter does without an event store
+    void BM_CsvEventLoad(benchmark::State &state)
+    {
+        const std::string dir = csv_event_directory(state.range(0), state.range(1));
+        vecmem::host_memory_resource mr;
+
+        std::size_t n_tracks = 0u;
+        for (auto _ : state)
+        {
+            const bella::truth_event evt = bella::read_csv_event(dir, 0u);
+
+            const bella::candidate_event candidates{
+                bella::generate_truth_candidates(bella::benchmarks::telescope(),
+                                                 evt.view(), mr),
+                bella::track_truths(evt.view())};
+            n_tracks = candidates.truths.size();
+            benchmark::DoNotOptimize(candidates);
+        }
+
+        state.SetItemsProcessed(
+            static_cast<std::int64_t>(state.iterations() * n_tracks));
+    }
+
+    /// Loading of the same event from a binary event store
+    void BM_EventStoreLoad(benchmark::State &state)
+    {
+        const std::string path =
+            (bella::benchmarks::scratch_directory() /
+             ("store_" + std::to_string(state.range(0)) + "_MeV_" +
+              std::to_string(state.range(1)) + "_muons.bin"))
+                .string();
+        {
+            bella::event_store_writer writer(path);
+            for (const auto &evt : bella::benchmarks::simulate_events(
+                     bella::benchmarks::magnets(),
+                     bella::benchmarks::beam_generator(state.range(0),
+                                                       state.range(1)),
+                     1u))
+            {
+                writer.add(evt.view());
+            }
+        }
+        const bella::event_store store(path);
+        vecmem::host_memory_resource mr;
+
+        std::size_t n_tracks = 0u;
+        for (auto _ : state)
+        {
+            const bella::event_view evt = store.find(0u);
+
+            const bella::candidate_event candidates{
+                bella::generate_truth_candidates(bella::benchmarks::telescope(),
+                                                 evt, mr),
+                bella::track_truths(evt)};
+            n_tracks = candidates.truths.size();
+            benchmark::DoNotOptimize(candidates);
+        }
+
+        state.SetItemsProcessed(
+            static_cast<std::int64_t>(state.iterations() * n_tracks));
+    }
+
+    /// Writing of the records of one event with @c range(0) fitted tracks
+    /// of 12 states each
+    template <typename writer_t>
+    void BM_RecordWriter(benchmark::State &state)
+    {
+        const std::size_t n_tracks = static_cast<std::size_t>(state.range(0));
+
+        bella::event_records records;
+        for (std::size_t i = 0; i < n_tracks; ++i)
+        {
+            records.residuals.push_back(
+                {0u, i, -9.9e-3, -9.9e-3, -1.e3, -1.e-2, -1.e-2, -1.e3});
+            for (std::size_t j = 0; j < 12u; ++j)
+            {
+                records.states.push_back({0u, i, 10. * j, 0.1, -0.1});
+            }
+        }
+
+        const auto dir = bella::benchmarks::scratch_directory();
+        writer_t writer((dir / "residual_benchmark").string(),
+                        (dir / "state_benchmark").string());
+
+        for (auto _ : state)
+        {
+            writer.write(records);
+        }
+        writer.close();
+
+        state.SetItemsProcessed(
+            static_cast<std::int64_t>(state.iterations() * n_tracks));
+    }
+
+} // namespace
+
+BENCHMARK(BM_CsvEventLoad)
+    ->Apply(bella::benchmarks::momentum_and_multiplicity)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_EventStoreLoad)
+    ->Apply(bella::benchmarks::momentum_and_multiplicity)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_RecordWriter, bella::csv_writer)
+    ->ArgName("muons")
+    ->Arg(1)
+    ->Arg(10)
+    ->Arg(100);
+BENCHMARK_TEMPLATE(BM_RecordWriter, bella::binary_writer)
+    ->ArgName("muons")
+    ->Arg(1)
+    ->Arg(10)
+    ->Arg(100);
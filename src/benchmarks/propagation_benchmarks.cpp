@@ -0,0 +1,79 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+// Project include(s).
+#include "traccc/edm/track_parameters.hpp"
+
+// detray include(s).
+#include "detray/navigation/navigator.hpp"
+#include "detray/propagator/actor_chain.hpp"
+#include "detray/propagator/propagator.hpp"
+
+// Local include(s).
+#include "src/benchmarks/benchmark_setup.hpp"
+#include "src/field_model.hpp"
+#include "src/gap_stepper.hpp"
+#include "src/magnet_field.hpp"
+#include "src/track_generator.hpp"
+
+// Google Benchmark include(s).
+#include <benchmark/benchmark.h>
+
+// System include(s).
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+
+    /// Propagation of the muons of one event through the whole telescope
+    ///
+    /// Uses the stepper the fitters use with the field model @c field_t,
+    /// without any actors, so this is the cost of stepping and navigation
+    /// alone.
+    template <typename field_t>
+    void BM_Propagation(benchmark::State &state)
+    {
+        using detector_type = bella::host_detector_type;
+        using stepper_type = bella::stepper_type<field_t>;
+        using navigator_type = detray::navigator<const detector_type>;
+        using propagator_type =
+            detray::propagator<stepper_type, navigator_type, detray::actor_chain<>>;
+
+        const detector_type &det = bella::benchmarks::telescope();
+        const typename field_t::view_t field_view(
+            bella::benchmarks::field<field_t>());
+
+        std::vector<traccc::free_track_parameters> tracks;
+        for (const auto &track : bella::generator_type(
+                 bella::benchmarks::beam_generator(state.range(0), state.range(1))))
+        {
+            tracks.push_back(track);
+        }
+
+        detray::propagation::config cfg{};
+        const propagator_type propagator(cfg);
+
+        for (auto _ : state)
+        {
+            for (const auto &track : tracks)
+            {
+                typename propagator_type::state propagation(track, field_view, det);
+                benchmark::DoNotOptimize(propagator.propagate(propagation));
+            }
+        }
+
+        state.SetItemsProcessed(
+            static_cast<std::int64_t>(state.iterations() * tracks.size()));
+    }
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_Propagation, bella::grid_field_type)
+    ->Apply(bella::benchmarks::momentum_and_multiplicity);
+BENCHMARK_TEMPLATE(BM_Propagation, bella::magnet_field)
+    ->Apply(bella::benchmarks::momentum_and_multiplicity);
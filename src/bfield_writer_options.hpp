@@ -0,0 +1,93 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Local include(s).
+#include "traccc/options/details/interface.hpp"
+
+// System include(s).
+#include <string>
+
+namespace traccc::opts
+{
+
+    /// Convenience namespace shorthand
+    namespace po = boost::program_options;
+
+    /// Command line options of the B field map writer
+    class bfield_writer_options : public interface
+    {
+
+    public:
+        /// Constructor
+        bfield_writer_options() : interface("B Field Writer Options")
+        {
+
+            m_desc.add_options()("bfield-format",
+                                 po::value(&(format))
+                                     ->default_value("txt"),
+                                 "Format of the field map: txt (input of "
+                                 "covfie's convert_bfield), cvf (covfie "
+                                 "file read by the executables) or bfm "
+                                 "(BELLA file memory-mapped by the "
+                                 "executables)");
+            m_desc.add_options()("bfield-output",
+                                 po::value(&(output))
+                                     ->default_value(""),
+                                 "Output file name (default: bfield.txt, "
+                                 "bfield.cvf or bfield.bfm)");
+            m_desc.add_options()("bfield-spacing",
+                                 po::value(&(spacing))
+                                     ->default_value(10.),
+                                 "Distance between the grid points [mm]");
+            m_desc.add_options()("bfield-x-min",
+                                 po::value(&(x_min))
+                                     ->default_value(-100.),
+                                 "Lower x bound of the grid [mm]");
+            m_desc.add_options()("bfield-x-max",
+                                 po::value(&(x_max))
+                                     ->default_value(1000.),
+                                 "Upper x bound of the grid, excluded [mm]");
+            m_desc.add_options()("bfield-y-min",
+                                 po::value(&(y_min))
+                                     ->default_value(-500.),
+                                 "Lower y bound of the grid [mm]");
+            m_desc.add_options()("bfield-y-max",
+                                 po::value(&(y_max))
+                                     ->default_value(500.),
+                                 "Upper y bound of the grid, excluded [mm]");
+            m_desc.add_options()("bfield-z-min",
+                                 po::value(&(z_min))
+                                     ->default_value(-500.),
+                                 "Lower z bound of the grid [mm]");
+            m_desc.add_options()("bfield-z-max",
+                                 po::value(&(z_max))
+                                     ->default_value(500.),
+                                 "Upper z bound of the grid, excluded [mm]");
+        }
+
+        /// Output file name, with the default of the format
+        std::string output_file() const
+        {
+            return output.empty() ? "bfield." + format : output;
+        }
+
+        std::string format;
+        std::string output;
+
+        double spacing;
+        double x_min;
+        double x_max;
+        double y_min;
+        double y_max;
+        double z_min;
+        double z_max;
+
+    }; // class bfield_writer_options
+
+} // namespace traccc::opts
@@ -0,0 +1,94 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// System include(s).
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+namespace bella
+{
+
+    /// First-in first-out queue with a fixed capacity, shared between
+    /// producer and consumer threads
+    ///
+    /// @c push blocks while the queue is full and @c pop blocks while it is
+    /// empty. After @c close the remaining elements can still be popped, and
+    /// both calls return immediately once there is nothing left.
+    template <typename T>
+    class bounded_queue
+    {
+
+    public:
+        /// Constructor
+        ///
+        /// @param capacity Maximum number of queued elements
+        explicit bounded_queue(const std::size_t capacity)
+            : m_capacity(capacity > 0u ? capacity : 1u)
+        {
+        }
+
+        /// Add an element, waiting for space
+        ///
+        /// @return false if the queue was closed and @c value was dropped
+        bool push(T &&value)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_not_full.wait(lock, [this]()
+                            { return m_closed || m_queue.size() < m_capacity; });
+            if (m_closed)
+            {
+                return false;
+            }
+            m_queue.push_back(std::move(value));
+            m_not_empty.notify_one();
+            return true;
+        }
+
+        /// Take the oldest element, waiting for one to arrive
+        ///
+        /// @return nothing once the queue is closed and empty
+        std::optional<T> pop()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_not_empty.wait(lock, [this]()
+                             { return m_closed || !m_queue.empty(); });
+            if (m_queue.empty())
+            {
+                return std::nullopt;
+            }
+            std::optional<T> value{std::move(m_queue.front())};
+            m_queue.pop_front();
+            m_not_full.notify_one();
+            return value;
+        }
+
+        /// Stop accepting elements and wake up all waiting threads
+        void close()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+            m_not_empty.notify_all();
+            m_not_full.notify_all();
+        }
+
+    private:
+        std::size_t m_capacity;
+        bool m_closed = false;
+        std::deque<T> m_queue;
+        std::mutex m_mutex;
+        std::condition_variable m_not_empty;
+        std::condition_variable m_not_full;
+
+    }; // class bounded_queue
+
+} // namespace bella
@@ -0,0 +1,92 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Project include(s).
+#include "traccc/edm/track_candidate.hpp"
+#include "traccc/edm/track_state.hpp"
+
+// Local include(s).
+#include "src/event_loop.hpp"
+
+// VecMem include(s).
+#include <vecmem/memory/memory_resource.hpp>
+
+// System include(s).
+#include <algorithm>
+#include <cstddef>
+
+namespace bella
+{
+
+    /// Fit the track candidates of one event in chunks of @c chunk_size
+    /// tracks, using up to @c n_threads threads
+    ///
+    /// Every chunk is fitted by the same (const) fitting algorithm, and the
+    /// fitted tracks are returned in the order of @c track_candidates.
+    ///
+    /// @param fitting          Host fitting algorithm
+    /// @param det              Detector the tracks are fitted in
+    /// @param field            Magnetic field
+    /// @param track_candidates Track candidates of the event
+    /// @param chunk_size       Tracks per chunk (0: fit everything at once)
+    /// @param n_threads        Number of threads fitting the chunks
+    /// @param mr               Memory resource of the chunk containers
+    template <typename fitting_algorithm_t, typename detector_t,
+              typename field_t>
+    traccc::track_state_container_types::host chunked_fit(
+        const fitting_algorithm_t &fitting, const detector_t &det,
+        const field_t &field,
+        const traccc::track_candidate_container_types::host &track_candidates,
+        const std::size_t chunk_size, const std::size_t n_threads,
+        vecmem::memory_resource &mr)
+    {
+        const std::size_t n_tracks = track_candidates.size();
+
+        if (chunk_size == 0u || chunk_size >= n_tracks)
+        {
+            return fitting(det, field, track_candidates);
+        }
+
+        const std::size_t n_chunks = (n_tracks + chunk_size - 1u) / chunk_size;
+
+        traccc::track_state_container_types::host track_states{&mr};
+        track_states.reserve(n_tracks);
+
+        auto fit_chunk = [&](const std::size_t chunk)
+        {
+            const std::size_t begin = chunk * chunk_size;
+            const std::size_t end = std::min(begin + chunk_size, n_tracks);
+
+            traccc::track_candidate_container_types::host candidates{&mr};
+            candidates.reserve(end - begin);
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                candidates.push_back(track_candidates.at(i).header,
+                                     track_candidates.at(i).items);
+            }
+
+            return fitting(det, field, candidates);
+        };
+
+        auto append_chunk =
+            [&](traccc::track_state_container_types::host &&chunk_states)
+        {
+            for (std::size_t i = 0; i < chunk_states.size(); ++i)
+            {
+                track_states.push_back(std::move(chunk_states.at(i).header),
+                                       std::move(chunk_states.at(i).items));
+            }
+        };
+
+        ordered_event_loop(n_threads, 0u, n_chunks, fit_chunk, append_chunk);
+
+        return track_states;
+    }
+
+} // namespace bella
@@ -0,0 +1,142 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+// Project include(s).
+#include "traccc/options/program_options.hpp"
+
+// Local include(s).
+#include "src/fit_output.hpp"
+#include "src/precision_comparison_options.hpp"
+
+// System include(s).
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+    /// Running moments of one compared quantity
+    struct quantity_comparison
+    {
+        std::string name;
+        double sum_diff = 0.;
+        double sum_diff2 = 0.;
+        double max_diff = 0.;
+        double sum_ref_res2 = 0.;
+        double sum_test_res2 = 0.;
+
+        void add(const double ref_fit, const double test_fit,
+                 const double truth)
+        {
+            const double diff = test_fit - ref_fit;
+            sum_diff += diff;
+            sum_diff2 += diff * diff;
+            max_diff = std::max(max_diff, std::abs(diff));
+            sum_ref_res2 += (ref_fit - truth) * (ref_fit - truth);
+            sum_test_res2 += (test_fit - truth) * (test_fit - truth);
+        }
+    };
+
+    using track_key = std::pair<std::uint64_t, std::uint64_t>;
+
+} // namespace
+
+// The main routine
+//
+int main(int argc, char *argv[])
+{
+    // Program options.
+    traccc::opts::precision_comparison_options comparison_opts;
+    traccc::opts::program_options program_opts{
+        "Compare the Residuals of a Double and a Float Build",
+        {comparison_opts},
+        argc,
+        argv};
+
+    const auto reference = bella::read_binary_table<bella::residual_row>(
+        comparison_opts.reference, bella::residual_columns());
+    const auto test = bella::read_binary_table<bella::residual_row>(
+        comparison_opts.test, bella::residual_columns());
+
+    // Tracks are matched by event and track id, as the fits of the two
+    // builds need not finish in the same order or succeed for the same tracks
+    std::map<track_key, const bella::residual_row *> reference_tracks;
+    for (const auto &r : reference)
+    {
+        reference_tracks.emplace(track_key{r.event_id, r.track_id}, &r);
+    }
+
+    std::array<quantity_comparison, 3> quantities{
+        {{"qop"}, {"qopT"}, {"qopz"}}};
+    std::size_t n_matched = 0u;
+    for (const auto &t : test)
+    {
+        const auto it = reference_tracks.find({t.event_id, t.track_id});
+        if (it == reference_tracks.end())
+        {
+            continue;
+        }
+        const bella::residual_row &r = *(it->second);
+        quantities[0].add(r.fit_qop, t.fit_qop, r.truth_qop);
+        quantities[1].add(r.fit_qopT, t.fit_qopT, r.truth_qopT);
+        quantities[2].add(r.fit_qopz, t.fit_qopz, r.truth_qopz);
+        ++n_matched;
+    }
+
+    std::cout << "Reference: " << reference.size() << " tracks, test: "
+              << test.size() << " tracks, matched: " << n_matched
+              << std::endl;
+    if (n_matched == 0u)
+    {
+        std::cout << "No track is in both files" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const double n = static_cast<double>(n_matched);
+    bool passed = true;
+    std::cout << std::left << std::setw(8) << "" << std::right
+              << std::setw(14) << "mean diff" << std::setw(14) << "rms diff"
+              << std::setw(14) << "max |diff|" << std::setw(14) << "ref rms"
+              << std::setw(14) << "test rms" << std::setw(14) << "rms diff/ref"
+              << std::endl;
+    for (const quantity_comparison &q : quantities)
+    {
+        const double rms_diff = std::sqrt(q.sum_diff2 / n);
+        const double ref_rms = std::sqrt(q.sum_ref_res2 / n);
+        const double test_rms = std::sqrt(q.sum_test_res2 / n);
+        const double relative = ref_rms > 0. ? rms_diff / ref_rms : 0.;
+        passed = passed && relative <= comparison_opts.tolerance;
+
+        std::cout << std::left << std::setw(8) << q.name << std::right
+                  << std::scientific << std::setprecision(4) << std::setw(14)
+                  << q.sum_diff / n << std::setw(14) << rms_diff
+                  << std::setw(14) << q.max_diff << std::setw(14) << ref_rms
+                  << std::setw(14) << test_rms << std::setw(14) << relative
+                  << std::endl;
+    }
+
+    // Tracks only one build could fit hint at a numerical problem as well
+    std::cout << reference.size() - n_matched
+              << " tracks fitted by the reference build only, "
+              << test.size() - n_matched << " by the test build only"
+              << std::endl;
+    std::cout << (passed ? "PASSED" : "FAILED")
+              << ": fit differences within " << comparison_opts.tolerance
+              << " of the reference resolution" << std::endl;
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
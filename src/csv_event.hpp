@@ -0,0 +1,183 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Project include(s).
+#include "traccc/definitions/primitives.hpp"
+#include "traccc/edm/measurement.hpp"
+#include "traccc/edm/particle.hpp"
+#include "traccc/io/csv/make_hit_reader.hpp"
+#include "traccc/io/csv/make_measurement_hit_id_reader.hpp"
+#include "traccc/io/csv/make_measurement_reader.hpp"
+#include "traccc/io/csv/make_particle_reader.hpp"
+#include "traccc/io/utils.hpp"
+
+// detray include(s).
+#include "detray/geometry/barcode.hpp"
+
+// Local include(s).
+#include "src/event_store.hpp"
+
+// System include(s).
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace bella
+{
+
+    /// Read one event of the simulation csv files into a @c truth_event
+    ///
+    /// Reads the particles, hits, measurements and measurement to hit map
+    /// written by @c traccc::smearing_writer directly, in one pass each,
+    /// instead of through @c traccc::event_data. That needs a detector of
+    /// the default detray type only to map the geometry ids and fills trees
+    /// keyed on the measurements, neither of which the BELLA telescope needs:
+    /// the geometry ids of the simulation are the surface barcodes, and the
+    /// truth of a measurement is the hit it was smeared from.
+    ///
+    /// The particles with measurements are kept in ascending particle id,
+    /// with their measurements in the file order, which is the order of
+    /// @c traccc::event_data and so of @c make_truth_event.
+    ///
+    /// @param directory Directory of the csv files, relative to the traccc
+    ///                  data directory unless absolute
+    /// @param event_id  Event index
+    inline truth_event read_csv_event(const std::string &directory,
+                                      const std::uint64_t event_id)
+    {
+        const std::string dir = traccc::io::get_absolute_path(directory);
+        auto file = [&](const char *suffix)
+        {
+            return (std::filesystem::path(dir) /
+                    traccc::io::get_event_filename(event_id, suffix))
+                .string();
+        };
+
+        // Particles, by particle id
+        std::vector<traccc::particle> particles;
+        std::unordered_map<std::uint64_t, std::size_t> particle_index;
+        {
+            auto reader = traccc::io::csv::make_particle_reader(file("-particles.csv"));
+            traccc::io::csv::particle p;
+            while (reader.read(p))
+            {
+                traccc::particle ptc{};
+                ptc.particle_id = p.particle_id;
+                ptc.particle_type = p.particle_type;
+                ptc.pos = {p.vx, p.vy, p.vz};
+                ptc.time = p.vt;
+                ptc.momentum = {p.px, p.py, p.pz};
+                ptc.mass = p.m;
+                ptc.charge = p.q;
+                particle_index[p.particle_id] = particles.size();
+                particles.push_back(ptc);
+            }
+        }
+
+        // Hits, indexed by their row like in the measurement to hit map
+        std::vector<traccc::io::csv::hit> hits;
+        {
+            auto reader = traccc::io::csv::make_hit_reader(file("-hits.csv"));
+            traccc::io::csv::hit h;
+            while (reader.read(h))
+            {
+                hits.push_back(h);
+            }
+        }
+
+        // Hit of every measurement id
+        constexpr std::size_t no_hit = std::numeric_limits<std::size_t>::max();
+        std::vector<std::size_t> hit_of_measurement;
+        {
+            auto reader = traccc::io::csv::make_measurement_hit_id_reader(
+                file("-measurement-simhit-map.csv"));
+            traccc::io::csv::measurement_hit_id link;
+            while (reader.read(link))
+            {
+                if (link.measurement_id >= hit_of_measurement.size())
+                {
+                    hit_of_measurement.resize(link.measurement_id + 1u, no_hit);
+                }
+                hit_of_measurement[link.measurement_id] = link.hit_id;
+            }
+        }
+
+        // Measurements with their truth, bucketed by particle
+        std::vector<std::vector<traccc::measurement>> measurements(particles.size());
+        std::vector<std::vector<measurement_truth>> truths(particles.size());
+        {
+            auto reader =
+                traccc::io::csv::make_measurement_reader(file("-measurements.csv"));
+            traccc::io::csv::measurement m;
+            while (reader.read(m))
+            {
+                const std::size_t hit_id = m.measurement_id < hit_of_measurement.size()
+                                               ? hit_of_measurement[m.measurement_id]
+                                               : no_hit;
+                if (hit_id >= hits.size())
+                {
+                    throw std::runtime_error("Measurement without a hit in event " +
+                                             std::to_string(event_id));
+                }
+                const traccc::io::csv::hit &h = hits[hit_id];
+                const auto ptc = particle_index.find(h.particle_id);
+                if (ptc == particle_index.end())
+                {
+                    throw std::runtime_error("Hit without a particle in event " +
+                                             std::to_string(event_id));
+                }
+
+                traccc::measurement meas{};
+                meas.local = {m.local0, m.local1};
+                meas.variance = {m.var_local0, m.var_local1};
+                meas.surface_link = detray::geometry::barcode{m.geometry_id};
+                meas.meas_dim = 2u;
+                meas.measurement_id = m.measurement_id;
+
+                measurements[ptc->second].push_back(meas);
+                truths[ptc->second].push_back(
+                    {{h.tx, h.ty, h.tz}, {h.tpx, h.tpy, h.tpz}});
+            }
+        }
+
+        // Flatten the particles with measurements in ascending id
+        std::vector<std::size_t> order;
+        for (std::size_t i = 0; i < particles.size(); ++i)
+        {
+            if (!measurements[i].empty())
+            {
+                order.push_back(i);
+            }
+        }
+        std::sort(order.begin(), order.end(), [&](const std::size_t a, const std::size_t b)
+                  { return particles[a].particle_id < particles[b].particle_id; });
+
+        truth_event evt;
+        evt.event_id = event_id;
+        evt.particles.reserve(order.size());
+        evt.measurement_offsets.reserve(order.size() + 1u);
+        for (const std::size_t i : order)
+        {
+            evt.particles.push_back(particles[i]);
+            evt.measurements.insert(evt.measurements.end(),
+                                    measurements[i].begin(), measurements[i].end());
+            evt.truths.insert(evt.truths.end(), truths[i].begin(), truths[i].end());
+            evt.measurement_offsets.push_back(evt.measurements.size());
+        }
+
+        return evt;
+    }
+
+} // namespace bella
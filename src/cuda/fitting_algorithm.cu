@@ -0,0 +1,126 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+// Local include(s).
+#include "src/cuda/fitting_algorithm.hpp"
+
+// Project include(s).
+#include "traccc/fitting/device/fit.hpp"
+
+// VecMem include(s).
+#include <vecmem/containers/device_vector.hpp>
+
+// Thrust include(s).
+#include <thrust/execution_policy.h>
+#include <thrust/sequence.h>
+
+// CUDA include(s).
+#include <cuda_runtime.h>
+
+// System include(s).
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace bella::cuda
+{
+
+    namespace
+    {
+
+        /// Throw on a CUDA error
+        void check_cuda(const cudaError_t code)
+        {
+            if (code != cudaSuccess)
+            {
+                throw std::runtime_error(std::string("CUDA error: ") +
+                                         cudaGetErrorString(code));
+            }
+        }
+
+        /// Fit one track per thread
+        __global__ void fit(
+            typename device_detector_type::view_type det_data,
+            const field_type::view_t field_data,
+            const typename fitter_type::config_type cfg,
+            traccc::track_candidate_container_types::const_view
+                track_candidates_view,
+            vecmem::data::vector_view<const unsigned int> param_ids_view,
+            traccc::track_state_container_types::view track_states_view)
+        {
+            const std::size_t gid = threadIdx.x + blockIdx.x * blockDim.x;
+
+            traccc::device::fit<fitter_type>(gid, det_data, field_data, cfg,
+                                             track_candidates_view,
+                                             param_ids_view,
+                                             track_states_view);
+        }
+
+    } // namespace
+
+    fitting_algorithm::fitting_algorithm(const config_type &cfg,
+                                         const traccc::memory_resource &mr,
+                                         vecmem::copy &copy,
+                                         traccc::cuda::stream &str)
+        : m_cfg(cfg), m_mr(mr), m_copy(copy), m_stream(str)
+    {
+        cudaDeviceProp props;
+        check_cuda(cudaGetDeviceProperties(&props, str.device()));
+        m_warp_size = static_cast<unsigned int>(props.warpSize);
+    }
+
+    traccc::track_state_container_types::buffer fitting_algorithm::operator()(
+        const typename device_detector_type::view_type &det_view,
+        const field_type::view_t &field_view,
+        const traccc::track_candidate_container_types::const_view
+            &track_candidates) const
+    {
+        cudaStream_t stream =
+            reinterpret_cast<cudaStream_t>(m_stream.get().cudaStream());
+
+        // Number of tracks and of candidates per track
+        const unsigned int n_tracks =
+            m_copy.get().get_size(track_candidates.headers);
+        const std::vector<unsigned int> candidate_sizes =
+            m_copy.get().get_sizes(track_candidates.items);
+
+        // One track state per track candidate
+        traccc::track_state_container_types::buffer track_states{
+            {n_tracks, m_mr.main},
+            {candidate_sizes, m_mr.main, m_mr.host,
+             vecmem::data::buffer_type::resizable}};
+        m_copy.get().setup(track_states.headers)->ignore();
+        m_copy.get().setup(track_states.items)->ignore();
+
+        if (n_tracks > 0u)
+        {
+            // All BELLA tracks cross the same planes in the same order, so
+            // the tracks are fitted in their input order
+            vecmem::data::vector_buffer<unsigned int> param_ids(n_tracks,
+                                                                m_mr.main);
+            vecmem::device_vector<unsigned int> param_ids_device(param_ids);
+            thrust::sequence(thrust::cuda::par.on(stream),
+                             param_ids_device.begin(),
+                             param_ids_device.end());
+
+            const unsigned int n_threads = m_warp_size * 2u;
+            const unsigned int n_blocks =
+                (n_tracks + n_threads - 1u) / n_threads;
+
+            fit<<<n_blocks, n_threads, 0, stream>>>(
+                det_view, field_view, m_cfg, track_candidates, param_ids,
+                track_states);
+            check_cuda(cudaGetLastError());
+
+            // Wait for the kernel before the track ids go out of scope
+            m_stream.get().synchronize();
+        }
+
+        return track_states;
+    }
+
+} // namespace bella::cuda
@@ -0,0 +1,101 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Project include(s).
+#include "traccc/cuda/utils/stream.hpp"
+#include "traccc/edm/track_candidate.hpp"
+#include "traccc/edm/track_state.hpp"
+#include "traccc/fitting/kalman_filter/kalman_fitter.hpp"
+#include "traccc/utils/memory_resource.hpp"
+
+// Detray include(s).
+#include "detray/core/detector.hpp"
+#include "detray/navigation/navigator.hpp"
+#include "detray/propagator/rk_stepper.hpp"
+
+// Local include(s).
+#include "src/telescope_metadata.hpp"
+
+// Covfie include(s).
+#include <covfie/core/backend/primitive/array.hpp>
+#include <covfie/core/backend/transformer/affine.hpp>
+#include <covfie/core/backend/transformer/linear.hpp>
+#include <covfie/core/backend/transformer/strided.hpp>
+#include <covfie/core/field.hpp>
+#include <covfie/cuda/backend/primitive/cuda_device_array.hpp>
+
+// VecMem include(s).
+#include <vecmem/utils/copy.hpp>
+
+// System include(s).
+#include <functional>
+
+namespace bella::cuda
+{
+
+    /// Telescope detector as seen by the device
+    using device_detector_type =
+        bella::telescope_detector<detray::device_container_types>;
+
+    /// Device copy of the @c detray::bfield::inhom_bknd_t field, with the
+    /// host array replaced by a CUDA device array
+    using field_type = covfie::field<covfie::backend::affine<
+        covfie::backend::linear<covfie::backend::strided<
+            covfie::vector::size3,
+            covfie::backend::cuda_device_array<covfie::vector::float3>>>>>;
+
+    using rk_stepper_type =
+        detray::rk_stepper<field_type::view_t, traccc::default_algebra,
+                           detray::constrained_step<>>;
+    using navigator_type = detray::navigator<const device_detector_type>;
+    using fitter_type = traccc::kalman_fitter<rk_stepper_type, navigator_type>;
+
+    /// Kalman fitting of the BELLA truth track candidates on a CUDA device
+    ///
+    /// traccc only instantiates its CUDA fitting algorithm for the constant
+    /// field, so this runs the same @c traccc::device::fit kernel body for
+    /// the inhomogeneous BELLA field.
+    class fitting_algorithm
+    {
+
+    public:
+        using config_type = typename fitter_type::config_type;
+
+        /// Constructor
+        ///
+        /// @param cfg    Fitting configuration
+        /// @param mr     Device and host memory resources
+        /// @param copy   Copy object that is synchronised with @c str
+        /// @param str    CUDA stream to run on
+        fitting_algorithm(const config_type &cfg,
+                          const traccc::memory_resource &mr,
+                          vecmem::copy &copy, traccc::cuda::stream &str);
+
+        /// Fit a batch of track candidates
+        ///
+        /// @param det_view         Device view of the detector
+        /// @param field_view       Device view of the magnetic field
+        /// @param track_candidates Track candidates in device memory
+        /// @return Fitted track states in device memory
+        traccc::track_state_container_types::buffer operator()(
+            const typename device_detector_type::view_type &det_view,
+            const field_type::view_t &field_view,
+            const traccc::track_candidate_container_types::const_view
+                &track_candidates) const;
+
+    private:
+        config_type m_cfg;
+        traccc::memory_resource m_mr;
+        std::reference_wrapper<vecmem::copy> m_copy;
+        std::reference_wrapper<traccc::cuda::stream> m_stream;
+        unsigned int m_warp_size;
+
+    }; // class fitting_algorithm
+
+} // namespace bella::cuda
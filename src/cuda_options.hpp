@@ -0,0 +1,42 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Local include(s).
+#include "traccc/options/details/interface.hpp"
+
+// System include(s).
+#include <cstddef>
+
+namespace traccc::opts
+{
+
+    /// Convenience namespace shorthand
+    namespace po = boost::program_options;
+
+    /// Command line options of the CUDA track fitting
+    class cuda_options : public interface
+    {
+
+    public:
+        /// Constructor
+        cuda_options() : interface("BELLA CUDA Options")
+        {
+
+            m_desc.add_options()("cuda-batch-events",
+                                 po::value(&(batch_events))
+                                     ->default_value(10u),
+                                 "Number of events fitted together in one "
+                                 "GPU batch");
+        }
+
+        std::size_t batch_events;
+
+    }; // class cuda_options
+
+} // namespace traccc::opts
@@ -0,0 +1,84 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Project include(s).
+#include "traccc/options/detector.hpp"
+
+// detray include(s).
+#include "detray/io/frontend/detector_reader.hpp"
+
+// Local include(s).
+#include "src/geometry_config.hpp"
+#include "src/geometry_source_options.hpp"
+#include "src/telescope_detector.hpp"
+#include "src/telescope_metadata.hpp"
+
+// VecMem include(s).
+#include <vecmem/memory/memory_resource.hpp>
+
+// System include(s).
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+namespace bella
+{
+
+    /// Read the detector given by the detector options into @c detector_t
+    ///
+    /// @param opts Detector, material and grid file names
+    /// @param mr   Memory resource of the detector
+    /// @return The detector and its volume name map
+    template <typename detector_t>
+    auto read_detector(const traccc::opts::detector &opts,
+                       vecmem::memory_resource &mr)
+    {
+        detray::io::detector_reader_config reader_cfg{};
+        reader_cfg.add_file(opts.detector_file);
+        if (!opts.material_file.empty())
+        {
+            reader_cfg.add_file(opts.material_file);
+        }
+        if (!opts.grid_file.empty())
+        {
+            reader_cfg.add_file(opts.grid_file);
+        }
+        return detray::io::read_detector<detector_t>(mr, reader_cfg);
+    }
+
+    /// Load the BELLA telescope the tracks are fitted in
+    ///
+    /// The builder source runs the same builder as the simulation, which
+    /// takes no file I/O at all and is what short batch jobs should use.
+    ///
+    /// @param det_opts    Detector files, read with the json source
+    /// @param source_opts Where the geometry comes from
+    /// @param geometry    Layout built with the builder source
+    /// @param mr          Memory resource of the detector
+    /// @return The detector and its volume name map
+    inline std::tuple<host_detector_type, typename host_detector_type::name_map>
+    load_telescope(const traccc::opts::detector &det_opts,
+                   const traccc::opts::geometry_source_options &source_opts,
+                   const geometry_config &geometry, vecmem::memory_resource &mr)
+    {
+        if (source_opts.source == "builder")
+        {
+            auto [det, names] = build_detector(mr, geometry);
+            return {std::move(det), std::move(names)};
+        }
+        if (source_opts.source == "json")
+        {
+            auto [det, names] = read_detector<host_detector_type>(det_opts, mr);
+            return {std::move(det), std::move(names)};
+        }
+        throw std::invalid_argument("Unknown geometry source: " +
+                                    source_opts.source);
+    }
+
+} // namespace bella
@@ -0,0 +1,306 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Local include(s).
+#include "src/bounded_queue.hpp"
+
+// System include(s).
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace bella
+{
+
+    /// Hands results that arrive in any order to a consumer in index order
+    ///
+    /// @c push may be called from several threads. The consumer is called
+    /// under a lock, one result at a time, as soon as all results with a
+    /// lower index have been consumed.
+    template <typename result_t, typename consume_t>
+    class ordered_consumer
+    {
+
+    public:
+        /// Constructor
+        ///
+        /// @param first   Index of the first result
+        /// @param consume Callable receiving the results in index order
+        ordered_consumer(const std::size_t first, consume_t &consume)
+            : m_next(first), m_consume(consume)
+        {
+        }
+
+        /// Hand over the result with the index @c index
+        void push(const std::size_t index, result_t &&result)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_finished.emplace(index, std::move(result));
+
+            // Flush everything that is now contiguous
+            while (!m_finished.empty() && m_finished.begin()->first == m_next)
+            {
+                m_consume(std::move(m_finished.begin()->second));
+                m_finished.erase(m_finished.begin());
+                ++m_next;
+            }
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::map<std::size_t, result_t> m_finished;
+        std::size_t m_next;
+        consume_t &m_consume;
+
+    }; // class ordered_consumer
+
+    /// Process the events [@c begin, @c end) on @c n_threads worker threads
+    ///
+    /// Every event is handed to @c process on whichever worker picks it up.
+    /// The results are passed to @c consume strictly in event order, one at
+    /// a time, so @c consume can write to a shared output without locking.
+    /// The indices need not be events; the same loop fits the track chunks
+    /// of a single event.
+    /// The first exception thrown by either callable stops the loop and is
+    /// rethrown in the calling thread.
+    ///
+    /// @param n_threads Number of worker threads (0 or 1 runs serially)
+    /// @param begin     First event index
+    /// @param end       One past the last event index
+    /// @param process   Callable producing the result of one event
+    /// @param consume   Callable receiving the results in event order
+    template <typename process_t, typename consume_t>
+    void ordered_event_loop(const std::size_t n_threads,
+                            const std::size_t begin, const std::size_t end,
+                            process_t &&process, consume_t &&consume)
+    {
+        using result_type = std::invoke_result_t<process_t &, std::size_t>;
+
+        if (n_threads <= 1u)
+        {
+            for (std::size_t event = begin; event < end; ++event)
+            {
+                consume(process(event));
+            }
+            return;
+        }
+
+        std::atomic<std::size_t> next_event{begin};
+        std::atomic<bool> abort{false};
+
+        ordered_consumer<result_type, std::remove_reference_t<consume_t>>
+            consumer(begin, consume);
+
+        std::mutex error_mutex;
+        std::exception_ptr error;
+
+        auto worker = [&]()
+        {
+            while (!abort)
+            {
+                const std::size_t event = next_event++;
+                if (event >= end)
+                {
+                    return;
+                }
+
+                try
+                {
+                    consumer.push(event, process(event));
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!error)
+                    {
+                        error = std::current_exception();
+                    }
+                    abort = true;
+                }
+            }
+        };
+
+        std::vector<std::thread> workers;
+        workers.reserve(n_threads);
+        for (std::size_t i = 0; i < n_threads; ++i)
+        {
+            workers.emplace_back(worker);
+        }
+        for (auto &w : workers)
+        {
+            w.join();
+        }
+
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    /// Process a stream of events of unknown length, read ahead of time
+    ///
+    /// A background thread calls @c read until it returns nothing, staying
+    /// at most @c depth events ahead of the processing, so reading the input
+    /// overlaps with the processing of the previous events. The events get
+    /// consecutive indices from @c first, are handed to @c process on
+    /// @c n_threads worker threads (at least one), and the results to
+    /// @c consume in index order, as in @c ordered_event_loop.
+    ///
+    /// @param n_threads Number of worker threads
+    /// @param first     Index of the first event
+    /// @param depth     Maximum number of read events waiting
+    /// @param read      Callable returning the next event as a
+    ///                  @c std::optional, empty at the end of the stream
+    /// @param process   Callable producing the result from the event index
+    ///                  and the read event
+    /// @param consume   Callable receiving the results in index order
+    template <typename read_t, typename process_t, typename consume_t>
+    void streamed_event_loop(const std::size_t n_threads,
+                             const std::size_t first, const std::size_t depth,
+                             read_t &&read, process_t &&process,
+                             consume_t &&consume)
+    {
+        using event_type =
+            typename std::invoke_result_t<read_t &>::value_type;
+        using result_type =
+            std::invoke_result_t<process_t &, std::size_t, event_type &>;
+
+        bounded_queue<std::pair<std::size_t, event_type>> events(depth);
+
+        ordered_consumer<result_type, std::remove_reference_t<consume_t>>
+            consumer(first, consume);
+
+        std::mutex error_mutex;
+        std::exception_ptr error;
+        auto record_error = [&]()
+        {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error)
+            {
+                error = std::current_exception();
+            }
+            // Unblock the other side of the queue
+            events.close();
+        };
+
+        auto read_events = [&]()
+        {
+            try
+            {
+                for (std::size_t event = first;; ++event)
+                {
+                    auto evt = read();
+                    if (!evt || !events.push({event, std::move(*evt)}))
+                    {
+                        break;
+                    }
+                }
+            }
+            catch (...)
+            {
+                record_error();
+            }
+            events.close();
+        };
+
+        auto process_events = [&]()
+        {
+            try
+            {
+                while (auto evt = events.pop())
+                {
+                    consumer.push(evt->first, process(evt->first, evt->second));
+                }
+            }
+            catch (...)
+            {
+                record_error();
+            }
+        };
+
+        std::thread reader(read_events);
+
+        std::vector<std::thread> workers;
+        for (std::size_t i = 0; i < std::max<std::size_t>(n_threads, 1u); ++i)
+        {
+            workers.emplace_back(process_events);
+        }
+        for (auto &w : workers)
+        {
+            w.join();
+        }
+        reader.join();
+
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    /// Process the events [@c begin, @c end), loading them ahead of time
+    ///
+    /// A background thread calls @c load for the events in order, staying at
+    /// most @c depth events ahead of the processing, as in
+    /// @c streamed_event_loop.
+    ///
+    /// @param n_threads Number of worker threads
+    /// @param begin     First event index
+    /// @param end       One past the last event index
+    /// @param depth     Maximum number of loaded events waiting
+    /// @param load      Callable loading one event
+    /// @param process   Callable producing the result from the event index
+    ///                  and the loaded event
+    /// @param consume   Callable receiving the results in event order
+    template <typename load_t, typename process_t, typename consume_t>
+    void prefetched_event_loop(const std::size_t n_threads,
+                               const std::size_t begin, const std::size_t end,
+                               const std::size_t depth, load_t &&load,
+                               process_t &&process, consume_t &&consume)
+    {
+        using event_type = std::invoke_result_t<load_t &, std::size_t>;
+
+        std::size_t next = begin;
+        streamed_event_loop(
+            n_threads, begin, depth,
+            [&]() -> std::optional<event_type>
+            {
+                if (next == end)
+                {
+                    return std::nullopt;
+                }
+                return load(next++);
+            },
+            std::forward<process_t>(process), std::forward<consume_t>(consume));
+    }
+
+    /// Call @c func for every index in [@c begin, @c end) on @c n_threads
+    /// worker threads, in no particular order
+    template <typename func_t>
+    void parallel_for(const std::size_t n_threads, const std::size_t begin,
+                      const std::size_t end, func_t &&func)
+    {
+        ordered_event_loop(
+            n_threads, begin, end,
+            [&func](const std::size_t i)
+            {
+                func(i);
+                return true;
+            },
+            [](bool) {});
+    }
+
+} // namespace bella
@@ -0,0 +1,536 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Project include(s).
+#include "traccc/definitions/primitives.hpp"
+#include "traccc/edm/measurement.hpp"
+#include "traccc/edm/particle.hpp"
+#include "traccc/edm/track_candidate.hpp"
+#include "traccc/utils/event_data.hpp"
+#include "traccc/utils/particle.hpp"
+#include "traccc/utils/seed_generator.hpp"
+
+// Local include(s).
+#include "src/truth_fitting.hpp"
+
+// VecMem include(s).
+#include <vecmem/containers/vector.hpp>
+#include <vecmem/memory/memory_resource.hpp>
+
+// System include(s).
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// POSIX include(s).
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace bella
+{
+
+    /// Truth position and momentum of the particle at a measurement
+    struct measurement_truth
+    {
+        traccc::point3 position;
+        traccc::vector3 momentum;
+    };
+
+    static_assert(std::is_trivially_copyable_v<traccc::particle>);
+    static_assert(std::is_trivially_copyable_v<traccc::measurement>);
+    static_assert(std::is_trivially_copyable_v<measurement_truth>);
+
+    /// Binary store of the simulated BELLA events
+    ///
+    /// The file starts with a @c store_header, followed by one block per
+    /// event and an index of the block offsets at @c index_offset. A block is
+    /// an @c event_header followed by the particles, the measurement offset
+    /// of every particle (n_particles + 1 entries), the measurements grouped
+    /// by particle and the truth of every measurement. All arrays start at
+    /// 8 byte aligned offsets, so they can be used in place from a mapping of
+    /// the file.
+    namespace event_store_format
+    {
+
+        /// Format version
+        static constexpr std::uint32_t version = 2u;
+
+        /// Header of the file
+        ///
+        /// The particles, measurements and truths are stored as the bytes of
+        /// their traccc types, whose layout depends on the scalar type of the
+        /// build, so the store records its size.
+        struct store_header
+        {
+            std::array<char, 8> magic;
+            std::uint32_t version;
+            std::uint32_t scalar_size;
+            std::uint64_t n_events;
+            std::uint64_t index_offset;
+        };
+
+        /// Header of one event block
+        struct event_header
+        {
+            std::uint64_t event_id;
+            std::uint64_t n_particles;
+            std::uint64_t n_measurements;
+        };
+
+        static constexpr std::array<char, 8> magic = {'B', 'E', 'L', 'L',
+                                                      'A', 'E', 'V', 'T'};
+
+        /// Round @c offset up to the array alignment
+        constexpr std::uint64_t align(const std::uint64_t offset)
+        {
+            return (offset + 7u) & ~std::uint64_t{7u};
+        }
+
+    } // namespace event_store_format
+
+    /// View of one event of an event store
+    struct event_view
+    {
+        std::uint64_t event_id;
+        std::span<const traccc::particle> particles;
+        std::span<const std::uint64_t> measurement_offsets;
+        std::span<const traccc::measurement> measurements;
+        std::span<const measurement_truth> truths;
+
+        /// Measurements of the particle @c i
+        std::span<const traccc::measurement> particle_measurements(
+            const std::size_t i) const
+        {
+            return measurements.subspan(
+                measurement_offsets[i],
+                measurement_offsets[i + 1] - measurement_offsets[i]);
+        }
+    };
+
+    /// Owning, in-memory counterpart of @c event_view
+    struct truth_event
+    {
+        std::uint64_t event_id = 0u;
+        std::vector<traccc::particle> particles;
+        std::vector<std::uint64_t> measurement_offsets{0u};
+        std::vector<traccc::measurement> measurements;
+        std::vector<measurement_truth> truths;
+
+        /// View of the event
+        event_view view() const
+        {
+            return {event_id, particles, measurement_offsets, measurements,
+                    truths};
+        }
+    };
+
+    /// Flatten the truth of one event read from the simulation csv files
+    ///
+    /// The measurements are grouped by particle, in the particle order of
+    /// @c traccc::event_data::generate_truth_candidates, and the truth of
+    /// every measurement is stored at the same index. The truth map is
+    /// walked once into an index by measurement id, so the truth of a
+    /// measurement is an array read instead of a tree lookup keyed on the
+    /// measurement. Measurements whose id is not unique in the event fall
+    /// back to the lookup.
+    ///
+    /// @param event_id Event index
+    /// @param evt_data Truth information of the event
+    inline truth_event make_truth_event(const std::uint64_t event_id,
+                                        const traccc::event_data &evt_data)
+    {
+        using truth_entry =
+            typename decltype(evt_data.m_meas_to_param_map)::value_type;
+
+        // Truth of every measurement id, from one pass over the map
+        std::vector<const truth_entry *> by_id;
+        for (const truth_entry &entry : evt_data.m_meas_to_param_map)
+        {
+            const std::size_t id = entry.first.measurement_id;
+            if (id >= by_id.size())
+            {
+                by_id.resize(id + 1u, nullptr);
+            }
+            by_id[id] = &entry;
+        }
+
+        truth_event evt;
+        evt.event_id = event_id;
+        evt.particles.reserve(evt_data.m_ptc_to_meas_map.size());
+        evt.measurement_offsets.reserve(evt_data.m_ptc_to_meas_map.size() + 1u);
+        evt.measurements.reserve(evt_data.m_meas_to_param_map.size());
+        evt.truths.reserve(evt_data.m_meas_to_param_map.size());
+
+        for (const auto &[ptc, ptc_measurements] : evt_data.m_ptc_to_meas_map)
+        {
+            evt.particles.push_back(ptc);
+            for (const auto &meas : ptc_measurements)
+            {
+                // The map is ordered by measurement, so an entry is the
+                // one of @c meas if neither orders before the other
+                const truth_entry *entry =
+                    meas.measurement_id < by_id.size()
+                        ? by_id[meas.measurement_id]
+                        : nullptr;
+                const auto &param =
+                    entry != nullptr && !(entry->first < meas) &&
+                            !(meas < entry->first)
+                        ? entry->second
+                        : evt_data.m_meas_to_param_map.at(meas);
+                evt.measurements.push_back(meas);
+                evt.truths.push_back({param.first, param.second});
+            }
+            evt.measurement_offsets.push_back(evt.measurements.size());
+        }
+
+        return evt;
+    }
+
+    /// Writer of an event store
+    class event_store_writer
+    {
+
+    public:
+        /// Constructor
+        ///
+        /// @param path Path of the store file
+        event_store_writer(const std::string &path)
+            : m_file(path, std::ios::binary)
+        {
+            if (!m_file)
+            {
+                throw std::runtime_error("Could not open " + path);
+            }
+
+            // Leave room for the header, written by close()
+            const event_store_format::store_header header{};
+            write(&header, 1u);
+        }
+
+        /// Destructor
+        ~event_store_writer() { close(); }
+
+        /// Append one event
+        ///
+        /// @param evt Event to append
+        void add(const event_view &evt)
+        {
+            m_index.push_back(event_store_format::align(m_offset));
+
+            const event_store_format::event_header header{
+                evt.event_id, evt.particles.size(), evt.measurements.size()};
+            write(&header, 1u);
+            write(evt.particles.data(), evt.particles.size());
+            write(evt.measurement_offsets.data(), evt.measurement_offsets.size());
+            write(evt.measurements.data(), evt.measurements.size());
+            write(evt.truths.data(), evt.truths.size());
+        }
+
+        /// Append one event read from the simulation csv files
+        ///
+        /// @param event_id Event index
+        /// @param evt_data Truth information of the event
+        void add(const std::uint64_t event_id,
+                 const traccc::event_data &evt_data)
+        {
+            add(make_truth_event(event_id, evt_data).view());
+        }
+
+        /// Write the index and the header
+        void close()
+        {
+            if (!m_file.is_open())
+            {
+                return;
+            }
+
+            const std::uint64_t index_offset = m_offset;
+            write(m_index.data(), m_index.size());
+
+            const event_store_format::store_header header{
+                event_store_format::magic, event_store_format::version,
+                static_cast<std::uint32_t>(sizeof(traccc::scalar)),
+                m_index.size(), index_offset};
+            m_file.seekp(0);
+            m_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            m_file.close();
+        }
+
+    private:
+        /// Write an array at the next aligned offset
+        template <typename T>
+        void write(const T *data, const std::size_t n)
+        {
+            static constexpr char padding[8] = {};
+            const std::uint64_t aligned = event_store_format::align(m_offset);
+            m_file.write(padding, static_cast<std::streamsize>(aligned - m_offset));
+
+            const std::uint64_t n_bytes = n * sizeof(T);
+            m_file.write(reinterpret_cast<const char *>(data),
+                         static_cast<std::streamsize>(n_bytes));
+            m_offset = aligned + n_bytes;
+        }
+
+        std::ofstream m_file;
+        std::uint64_t m_offset = 0u;
+        std::vector<std::uint64_t> m_index;
+
+    }; // class event_store_writer
+
+    /// Read-only, memory-mapped event store
+    class event_store
+    {
+
+    public:
+        /// Constructor
+        ///
+        /// @param path Path of the store file
+        event_store(const std::string &path)
+        {
+            const int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+            {
+                throw std::runtime_error("Could not open " + path);
+            }
+
+            struct stat st;
+            if (::fstat(fd, &st) != 0)
+            {
+                ::close(fd);
+                throw std::runtime_error("Could not stat " + path);
+            }
+            m_size = static_cast<std::size_t>(st.st_size);
+
+            void *data = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (data == MAP_FAILED)
+            {
+                throw std::runtime_error("Could not map " + path);
+            }
+            m_data = static_cast<const char *>(data);
+
+            try
+            {
+                const auto &header = at<event_store_format::store_header>(0u);
+                if (header.magic != event_store_format::magic ||
+                    header.version != event_store_format::version)
+                {
+                    throw std::runtime_error(path + " is not a BELLA event store");
+                }
+                if (header.scalar_size != sizeof(traccc::scalar))
+                {
+                    throw std::runtime_error(
+                        path + " was packed with " +
+                        std::to_string(8u * header.scalar_size) +
+                        " bit scalars, this build uses " +
+                        std::to_string(8u * sizeof(traccc::scalar)) +
+                        " bit ones (BELLA_SCALAR_TYPE)");
+                }
+
+                // The whole index has to be in the file
+                std::uint64_t index_offset = header.index_offset;
+                m_index = array<std::uint64_t>(index_offset, header.n_events).data();
+                m_n_events = header.n_events;
+            }
+            catch (...)
+            {
+                ::munmap(const_cast<char *>(m_data), m_size);
+                throw;
+            }
+        }
+
+        /// Destructor
+        ~event_store() { ::munmap(const_cast<char *>(m_data), m_size); }
+
+        event_store(const event_store &) = delete;
+        event_store &operator=(const event_store &) = delete;
+
+        /// Number of events in the store
+        std::size_t size() const { return m_n_events; }
+
+        /// View of the @c i-th event
+        event_view event(const std::size_t i) const
+        {
+            if (i >= m_n_events)
+            {
+                throw std::out_of_range("Event " + std::to_string(i) +
+                                        " is not in the event store");
+            }
+
+            std::uint64_t offset = m_index[i];
+            const auto &header = at<event_store_format::event_header>(offset);
+            offset += sizeof(header);
+
+            event_view view;
+            view.event_id = header.event_id;
+            view.particles = array<traccc::particle>(offset, header.n_particles);
+            view.measurement_offsets =
+                array<std::uint64_t>(offset, header.n_particles + 1u);
+            view.measurements =
+                array<traccc::measurement>(offset, header.n_measurements);
+            view.truths = array<measurement_truth>(offset, header.n_measurements);
+
+            // The particles have to split the measurements of the block
+            for (std::size_t p = 0; p < view.particles.size(); ++p)
+            {
+                if (view.measurement_offsets[p] > view.measurement_offsets[p + 1u])
+                {
+                    throw std::runtime_error("Corrupt event store");
+                }
+            }
+            if (view.measurement_offsets.front() != 0u ||
+                view.measurement_offsets.back() != header.n_measurements)
+            {
+                throw std::runtime_error("Corrupt event store");
+            }
+
+            return view;
+        }
+
+        /// View of the event with the index @c event_id
+        ///
+        /// The events are packed in consecutive order, so this is a direct
+        /// index into the store.
+        event_view find(const std::uint64_t event_id) const
+        {
+            const std::uint64_t first_id = event(0u).event_id;
+            if (event_id < first_id)
+            {
+                throw std::out_of_range("Event " + std::to_string(event_id) +
+                                        " is not in the event store");
+            }
+
+            const event_view view = event(event_id - first_id);
+            if (view.event_id != event_id)
+            {
+                throw std::runtime_error("Event store is not consecutive");
+            }
+            return view;
+        }
+
+    private:
+        /// Object at @c offset of the mapping
+        template <typename T>
+        const T &at(const std::uint64_t offset) const
+        {
+            if (offset > m_size || sizeof(T) > m_size - offset)
+            {
+                throw std::runtime_error("Truncated event store");
+            }
+            return *reinterpret_cast<const T *>(m_data + offset);
+        }
+
+        /// Array of @c n objects at the next aligned @c offset, advancing it
+        template <typename T>
+        std::span<const T> array(std::uint64_t &offset, const std::uint64_t n) const
+        {
+            // Compared by division, as a corrupt @c n would overflow n * size
+            if (offset > m_size)
+            {
+                throw std::runtime_error("Truncated event store");
+            }
+            offset = event_store_format::align(offset);
+            if (offset > m_size || n > (m_size - offset) / sizeof(T))
+            {
+                throw std::runtime_error("Truncated event store");
+            }
+            const T *first = reinterpret_cast<const T *>(m_data + offset);
+            offset += n * sizeof(T);
+            return {first, n};
+        }
+
+        const char *m_data = nullptr;
+        std::size_t m_size = 0u;
+        std::size_t m_n_events = 0u;
+        const std::uint64_t *m_index = nullptr;
+
+    }; // class event_store
+
+    /// Make the smeared truth seeds and track candidates of a stored event
+    ///
+    /// The seeds are drawn in the same particle order as
+    /// @c traccc::event_data::generate_truth_candidates.
+    ///
+    /// @param det Detector the event was simulated in
+    /// @param evt Stored event
+    /// @param mr  Memory resource of the candidate container
+    template <typename detector_t>
+    traccc::track_candidate_container_types::host generate_truth_candidates(
+        const detector_t &det, const event_view &evt,
+        vecmem::memory_resource &mr)
+    {
+        traccc::track_candidate_container_types::host truth_candidates{&mr};
+        if (evt.particles.empty())
+        {
+            return truth_candidates;
+        }
+
+        /// Assume that all particle momentum are the same
+        traccc::seed_generator<detector_t> sg(det,
+                                              seed_stddevs(evt.particles[0]));
+
+        for (std::size_t i = 0; i < evt.particles.size(); ++i)
+        {
+            const auto measurements = evt.particle_measurements(i);
+            if (measurements.empty())
+            {
+                continue;
+            }
+
+            const traccc::particle &ptc = evt.particles[i];
+            const measurement_truth &truth =
+                evt.truths[evt.measurement_offsets[i]];
+
+            const traccc::free_track_parameters free_param(
+                truth.position, 0.f, truth.momentum, ptc.charge);
+            const auto seed_params = sg(
+                measurements[0].surface_link, free_param,
+                traccc::detail::particle_from_pdg_number<traccc::scalar>(
+                    ptc.particle_type));
+
+            truth_candidates.push_back(
+                seed_params,
+                vecmem::vector<traccc::track_candidate>(
+                    measurements.begin(), measurements.end(), &mr));
+        }
+
+        return truth_candidates;
+    }
+
+    /// Truth of every track candidate of a stored event
+    ///
+    /// @param evt Stored event
+    inline std::vector<track_truth> track_truths(const event_view &evt)
+    {
+        std::vector<track_truth> truths;
+        truths.reserve(evt.particles.size());
+
+        for (std::size_t i = 0; i < evt.particles.size(); ++i)
+        {
+            if (evt.measurement_offsets[i] == evt.measurement_offsets[i + 1])
+            {
+                continue;
+            }
+            truths.push_back({evt.truths[evt.measurement_offsets[i]].momentum,
+                              evt.particles[i].charge});
+        }
+
+        return truths;
+    }
+
+} // namespace bella
@@ -0,0 +1,48 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Local include(s).
+#include "traccc/options/details/interface.hpp"
+
+// System include(s).
+#include <cstddef>
+#include <string>
+
+namespace traccc::opts
+{
+
+    /// Convenience namespace shorthand
+    namespace po = boost::program_options;
+
+    /// Command line options for the binary BELLA event store
+    class event_store_options : public interface
+    {
+
+    public:
+        /// Constructor
+        event_store_options() : interface("BELLA Event Store Options")
+        {
+
+            m_desc.add_options()("event-store",
+                                 po::value(&(file))
+                                     ->default_value(""),
+                                 "Binary event store file");
+            m_desc.add_options()("event-store-queue-size",
+                                 po::value(&(queue_size))
+                                     ->default_value(16u),
+                                 "Number of events buffered for the writer "
+                                 "thread of a new event store");
+        }
+
+        std::string file;
+        std::size_t queue_size;
+
+    }; // class event_store_options
+
+} // namespace traccc::opts
@@ -0,0 +1,155 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// detray include(s).
+#include "detray/detectors/bfield.hpp"
+
+// Local include(s).
+#include "src/magnet_field.hpp"
+
+// System include(s).
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace bella
+{
+
+    /// Covfie field map type read from --bfield-file
+    using grid_field_type = covfie::field<detray::bfield::inhom_bknd_t>;
+
+    /// Regular grid of a field map, in mm
+    ///
+    /// The defaults are those of @c write_bfield. The upper bounds are
+    /// excluded.
+    struct field_grid
+    {
+        double spacing = 10.;
+        std::array<double, 3> min{-100., -500., -500.};
+        std::array<double, 3> max{1000., 500., 500.};
+    };
+
+    /// Samples the field of magnet boxes on the points of a grid
+    class magnet_grid_sampler
+    {
+
+    public:
+        /// Field values along one z row of the grid
+        using row_type = std::vector<std::array<float, 3>>;
+
+        /// Constructor
+        ///
+        /// @param magnets Magnet boxes, with the field in Tesla
+        /// @param grid    Grid to sample the field on
+        magnet_grid_sampler(const std::vector<magnet_box> &magnets,
+                            const field_grid &grid)
+        {
+            for (unsigned int i = 0; i < 3u; ++i)
+            {
+                m_axes[i] = make_axis(grid.min[i], grid.max[i], grid.spacing);
+            }
+
+            // The magnets are boxes, so the test factorizes into one mask per
+            // axis and the innermost loop is a branch-free multiply-add
+            for (const magnet_box &box : magnets)
+            {
+                m_magnets.push_back({make_mask(m_axes[0], box.min[0], box.max[0]),
+                                     make_mask(m_axes[1], box.min[1], box.max[1]),
+                                     make_mask(m_axes[2], box.min[2], box.max[2]),
+                                     box.field});
+            }
+        }
+
+        /// Grid points along the axis @c i
+        const std::vector<double> &axis(const unsigned int i) const
+        {
+            return m_axes[i];
+        }
+
+        /// Total number of grid points
+        std::size_t size() const
+        {
+            return m_axes[0].size() * m_axes[1].size() * m_axes[2].size();
+        }
+
+        /// Field of the magnets along the z row (@c i, @c j), in units of
+        /// @c unit
+        void fill_row(const std::size_t i, const std::size_t j,
+                      const float unit, row_type &row) const
+        {
+            std::fill(row.begin(), row.end(), std::array<float, 3>{0.f, 0.f, 0.f});
+            for (const magnet_masks &m : m_magnets)
+            {
+                const float w_xy = unit * m.x[i] * m.y[j];
+                if (w_xy == 0.f)
+                {
+                    continue;
+                }
+                for (std::size_t k = 0; k < row.size(); ++k)
+                {
+                    const float w = w_xy * m.z[k];
+                    row[k][0] += w * m.field[0];
+                    row[k][1] += w * m.field[1];
+                    row[k][2] += w * m.field[2];
+                }
+            }
+        }
+
+    private:
+        /// Per-axis masks and field of one magnet box
+        struct magnet_masks
+        {
+            std::vector<float> x;
+            std::vector<float> y;
+            std::vector<float> z;
+            std::array<float, 3> field;
+        };
+
+        /// Grid points along one axis, from @c min (included) to @c max
+        /// (excluded)
+        static std::vector<double> make_axis(const double min, const double max,
+                                             const double spacing)
+        {
+            if (!(spacing > 0.) || !(max > min))
+            {
+                throw std::invalid_argument("Invalid B field grid axis");
+            }
+
+            const std::size_t n =
+                static_cast<std::size_t>(std::ceil((max - min) / spacing));
+
+            std::vector<double> axis(n);
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                axis[i] = min + i * spacing;
+            }
+            return axis;
+        }
+
+        /// 1 where the grid point lies in [@c min, @c max], 0 elsewhere
+        static std::vector<float> make_mask(const std::vector<double> &axis,
+                                            const double min, const double max)
+        {
+            std::vector<float> mask(axis.size());
+            for (std::size_t i = 0; i < axis.size(); ++i)
+            {
+                mask[i] = (axis[i] >= min && axis[i] <= max) ? 1.f : 0.f;
+            }
+            return mask;
+        }
+
+        std::array<std::vector<double>, 3> m_axes;
+        std::vector<magnet_masks> m_magnets;
+
+    }; // class magnet_grid_sampler
+
+} // namespace bella
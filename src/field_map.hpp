@@ -0,0 +1,99 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Project include(s).
+#include "traccc/definitions/common.hpp"
+
+// Local include(s).
+#include "src/event_loop.hpp"
+#include "src/field_grid.hpp"
+#include "src/magnet_field.hpp"
+
+// Covfie include(s).
+#include <covfie/core/algebra/affine.hpp>
+#include <covfie/core/field.hpp>
+#include <covfie/core/parameter_pack.hpp>
+
+// System include(s).
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace bella
+{
+
+    /// Field map of magnet boxes, in the layout that covfie's
+    /// convert_bfield makes from the text field
+    ///
+    /// @param sampler   Magnet field on the grid points
+    /// @param grid      Grid of the map, the one of @c sampler
+    /// @param n_threads Number of threads filling the map
+    inline grid_field_type make_field_map(const magnet_grid_sampler &sampler,
+                                          const field_grid &grid,
+                                          const std::size_t n_threads)
+    {
+        using grid_backend_t = grid_field_type::backend_t::backend_t::backend_t;
+        using grid_t = covfie::field<grid_backend_t>;
+
+        const std::size_t nx = sampler.axis(0).size();
+        const std::size_t ny = sampler.axis(1).size();
+        const std::size_t nz = sampler.axis(2).size();
+
+        grid_t map(covfie::make_parameter_pack(
+            grid_backend_t::configuration_t{nx, ny, nz}));
+        typename grid_t::view_t map_view(map);
+
+        // Every x slice is a contiguous block of the preallocated grid, so
+        // the slices are filled independently on the worker threads
+        parallel_for(
+            n_threads, 0u, nx,
+            [&](const std::size_t i)
+            {
+                magnet_grid_sampler::row_type row(nz);
+                for (std::size_t j = 0; j < ny; ++j)
+                {
+                    // Tesla to the internal field unit, as in convert_bfield
+                    sampler.fill_row(i, j, traccc::unit<float>::T, row);
+                    for (std::size_t k = 0; k < nz; ++k)
+                    {
+                        map_view.at(i, j, k) = {row[k][0], row[k][1], row[k][2]};
+                    }
+                }
+            });
+
+        // Map global positions onto grid indices: translate first, then scale
+        const auto translation = covfie::algebra::affine<3>::translation(
+            static_cast<float>(-grid.min[0]), static_cast<float>(-grid.min[1]),
+            static_cast<float>(-grid.min[2]));
+        const float inv_spacing = static_cast<float>(1. / grid.spacing);
+        const auto scaling = covfie::algebra::affine<3>::scaling(
+            inv_spacing, inv_spacing, inv_spacing);
+
+        return grid_field_type(covfie::make_parameter_pack(
+            grid_field_type::backend_t::configuration_t(scaling * translation),
+            grid_field_type::backend_t::backend_t::configuration_t{},
+            map.backend()));
+    }
+
+    /// Field map of magnet boxes on the grid @c grid
+    ///
+    /// @param magnets   Magnet boxes, with the field in Tesla
+    /// @param grid      Grid of the map
+    /// @param n_threads Number of threads filling the map
+    inline grid_field_type make_field_map(const std::vector<magnet_box> &magnets,
+                                          const field_grid &grid,
+                                          const std::size_t n_threads)
+    {
+        return make_field_map(magnet_grid_sampler(magnets, grid), grid, n_threads);
+    }
+
+} // namespace bella
@@ -0,0 +1,63 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// detray include(s).
+#include "detray/detectors/bfield.hpp"
+
+// Local include(s).
+#include "src/field_grid.hpp"
+#include "src/field_options.hpp"
+#include "src/magnet_field.hpp"
+#include "src/mapped_field.hpp"
+
+// System include(s).
+#include <stdexcept>
+#include <vector>
+
+namespace bella
+{
+
+    /// Build the magnetic field selected by @c opts and call @c func with it
+    ///
+    /// @param opts    Field options
+    /// @param magnets Magnet boxes of the analytic field model
+    /// @param func    Generic callable receiving the field
+    ///
+    /// The field types differ, so @c func is generic and is instantiated
+    /// once per field model, e.g. with the stepper type derived from
+    /// @c typename std::remove_cvref_t<decltype(field)>::view_t.
+    template <typename func_t>
+    void with_field(const traccc::opts::field_options &opts,
+                    const std::vector<magnet_box> &magnets, func_t &&func)
+    {
+        if (opts.model == "grid")
+        {
+            const grid_field_type field =
+                detray::io::read_bfield<grid_field_type>(opts.bfield_file);
+            func(field);
+        }
+        else if (opts.model == "mapped")
+        {
+            // Mapped, not read: the map is shared with every other process
+            // of the node using the same file
+            const mapped_field field(opts.bfield_file);
+            func(field);
+        }
+        else if (opts.model == "magnets")
+        {
+            const magnet_field field(magnets, opts.edge_width);
+            func(field);
+        }
+        else
+        {
+            throw std::invalid_argument("Unknown B field model: " + opts.model);
+        }
+    }
+
+} // namespace bella
@@ -10,6 +10,10 @@
 // Local include(s).
 #include "traccc/options/details/interface.hpp"
 
+// System include(s).
+#include <string>
+#include <vector>
+
 namespace traccc::opts
 {
 
@@ -29,10 +33,110 @@ namespace traccc::opts
                                  po::value(&(bfield_file))
                                      ->default_value(""),
                                  "B field file name");
+            m_desc.add_options()("bfield-model",
+                                 po::value(&(model))
+                                     ->default_value("grid"),
+                                 "B field model: grid (covfie field map read "
+                                 "from --bfield-file), mapped (BELLA field "
+                                 "map memory-mapped from --bfield-file) or "
+                                 "magnets (analytic BELLA magnet boxes)");
+            m_desc.add_options()("bfield-edge-width",
+                                 po::value(&(edge_width))
+                                     ->default_value(10.f),
+                                 "Width of the linear field fall-off around "
+                                 "the magnet boxes with --bfield-model=magnets "
+                                 "[mm] (the field map spacing reproduces the "
+                                 "interpolated map, 0 gives sharp edges)");
         }
 
         std::string bfield_file;
+        std::string model;
+        float edge_width;
 
     }; // class track_propagation
 
+    /// Command line options describing the BELLA telescope layout
+    ///
+    /// The same options can be given as "name = value" lines of the file
+    /// named by --geometry-config. Options given on the command line take
+    /// precedence over the file.
+    class bella_geometry_options : public interface
+    {
+
+    public:
+        /// Constructor
+        bella_geometry_options() : interface("BELLA Geometry Options")
+        {
+
+            m_desc.add_options()("geometry-config",
+                                 po::value(&(config_file))
+                                     ->default_value(""),
+                                 "File with geometry options, one "
+                                 "\"name = value\" per line");
+            m_desc.add_options()("plane-positions",
+                                 po::value(&(plane_positions))
+                                     ->default_value("10,20,30,60,70,80,180,"
+                                                     "190,200,230,240,250"),
+                                 "Comma separated x positions of the "
+                                 "sensitive planes [mm]");
+            m_desc.add_options()("plane-material",
+                                 po::value(&(plane_material))
+                                     ->default_value("silicon"),
+                                 "Material of the sensitive planes");
+            m_desc.add_options()("plane-thickness",
+                                 po::value(&(plane_thickness))
+                                     ->default_value(1.f),
+                                 "Thickness of the sensitive planes [mm]");
+            m_desc.add_options()("plane-half-length",
+                                 po::value(&(plane_half_length))
+                                     ->default_value(100.f),
+                                 "Half length of the square sensitive "
+                                 "planes [mm]");
+            m_desc.add_options()("magnet",
+                                 po::value(&(magnets))
+                                     ->default_value({}, "the BELLA magnets"),
+                                 "Magnet box \"xmin,ymin,zmin,xmax,ymax,zmax,"
+                                 "bx,by,bz\" [mm, T], repeated for every "
+                                 "magnet (\"none\" for no magnet)");
+            m_desc.add_options()("passive",
+                                 po::value(&(passive_slabs))
+                                     ->default_value({}, "none"),
+                                 "Passive material slab \"x,material,"
+                                 "thickness\" [mm], e.g. an iron attenuator "
+                                 "\"120,iron,30\", repeated for every slab");
+        }
+
+        /// Take the options not given on the command line from the file
+        void read(const po::variables_map &vm) override
+        {
+            if (config_file.empty())
+            {
+                return;
+            }
+
+            po::variables_map file_vm;
+            po::store(po::parse_config_file<char>(config_file.c_str(), m_desc),
+                      file_vm);
+
+            for (const auto &[name, value] : file_vm)
+            {
+                if (value.defaulted() || name == "geometry-config" ||
+                    (vm.count(name) && !vm[name].defaulted()))
+                {
+                    continue;
+                }
+                m_desc.find(name, false).semantic()->notify(value.value());
+            }
+        }
+
+        std::string config_file;
+        std::string plane_positions;
+        std::string plane_material;
+        float plane_thickness;
+        float plane_half_length;
+        std::vector<std::string> magnets;
+        std::vector<std::string> passive_slabs;
+
+    }; // class bella_geometry_options
+
 } // namespace traccc::opts
@@ -0,0 +1,456 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Local include(s).
+#include "src/async_writer.hpp"
+#include "src/track_records.hpp"
+
+// System include(s).
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bella
+{
+
+    /// Interface of the writers of the fitting output
+    class record_writer
+    {
+
+    public:
+        virtual ~record_writer() = default;
+
+        /// Write the records of one event
+        virtual void write(const event_records &records) = 0;
+
+        /// Finish writing, throwing the errors of a background writer
+        virtual void close() {}
+
+    }; // class record_writer
+
+    /// Writer of the fitting output into residual.csv and state.csv
+    class csv_writer : public record_writer
+    {
+
+    public:
+        /// Constructor
+        ///
+        /// @param residual_path Path of the residual file
+        /// @param state_path    Path of the track state file
+        csv_writer(const std::string &residual_path = "residual.csv",
+                   const std::string &state_path = "state.csv")
+            : m_residual_path(residual_path), m_state_path(state_path)
+        {
+            // Residual file
+            m_residual_file.open(residual_path);
+            if (!m_residual_file)
+            {
+                throw std::runtime_error("Could not open " + residual_path);
+            }
+            m_residual_file << "fit_qop, fit_qopT, fit_qopz, ";
+            m_residual_file << "truth_qop, truth_qopT, truth_qopz,";
+            m_residual_file << "qop_residual, qopT_residual, qopz_residual";
+            m_residual_file << std::endl;
+
+            // Track state file
+            m_state_file.open(state_path);
+            if (!m_state_file)
+            {
+                throw std::runtime_error("Could not open " + state_path);
+            }
+            m_state_file << "event_id, fit_track_id, x, y, z";
+            m_state_file << std::endl;
+        }
+
+        /// Write the records of one event
+        void write(const event_records &records) override
+        {
+            for (const auto &r : records.residuals)
+            {
+                m_residual_file << r.fit_qop << "," << r.fit_qopT << "," << r.fit_qopz << ",";
+                m_residual_file << r.truth_qop << "," << r.truth_qopT << "," << r.truth_qopz << ",";
+                m_residual_file << r.fit_qop - r.truth_qop << ",";
+                m_residual_file << r.fit_qopT - r.truth_qopT << ",";
+                m_residual_file << r.fit_qopz - r.truth_qopz << " \n";
+            }
+
+            for (const auto &s : records.states)
+            {
+                m_state_file << s.event_id << "," << s.track_id << ","
+                             << s.x << "," << s.y << "," << s.z << "\n";
+            }
+        }
+
+        /// Write out both files, throwing if any of it failed
+        void close() override
+        {
+            if (!m_residual_file.is_open())
+            {
+                return;
+            }
+            m_residual_file.close();
+            m_state_file.close();
+            if (!m_residual_file)
+            {
+                throw std::runtime_error("Could not write " + m_residual_path);
+            }
+            if (!m_state_file)
+            {
+                throw std::runtime_error("Could not write " + m_state_path);
+            }
+        }
+
+    private:
+        std::string m_residual_path;
+        std::string m_state_path;
+        std::ofstream m_residual_file;
+        std::ofstream m_state_file;
+
+    }; // class csv_writer
+
+    /// Fixed-width binary records, written through an in-memory buffer
+    ///
+    /// Every file starts with a header: the magic "BELLAREC", the format
+    /// version, the number of columns and one 16 character name per column.
+    /// It is followed by the rows, each holding one little-endian 8 byte value
+    /// per column (the first two columns as uint64, the others as float64),
+    /// so the records map directly onto a numpy structured array. The layout
+    /// is row-major: the values of one record are contiguous, not those of
+    /// one column, so that rows can be appended while fitting.
+    template <typename row_t>
+    class binary_table
+    {
+
+    public:
+        /// Format version written into the header
+        static constexpr std::uint32_t version = 1u;
+
+        /// Number of rows buffered before writing to the file
+        static constexpr std::size_t buffer_rows = 1u << 16;
+
+        /// Constructor
+        ///
+        /// @param path    Path of the file
+        /// @param columns Names of the columns of @c row_t
+        binary_table(const std::string &path,
+                     const std::vector<std::string> &columns)
+            : m_path(path), m_file(path, std::ios::binary)
+        {
+            if (!m_file)
+            {
+                throw std::runtime_error("Could not open " + path);
+            }
+            if (columns.size() * sizeof(std::uint64_t) != sizeof(row_t))
+            {
+                throw std::logic_error("Column names do not match the row");
+            }
+
+            const std::uint32_t n_columns =
+                static_cast<std::uint32_t>(columns.size());
+            m_file.write("BELLAREC", 8);
+            m_file.write(reinterpret_cast<const char *>(&version), sizeof(version));
+            m_file.write(reinterpret_cast<const char *>(&n_columns), sizeof(n_columns));
+            for (const auto &c : columns)
+            {
+                std::array<char, 16> name{};
+                c.copy(name.data(), name.size());
+                m_file.write(name.data(), name.size());
+            }
+
+            m_buffer.reserve(buffer_rows);
+        }
+
+        /// Destructor, writing out the buffered rows if @c close was not
+        /// called. Errors are only reported by @c close.
+        ~binary_table()
+        {
+            if (m_file.is_open())
+            {
+                m_file.write(reinterpret_cast<const char *>(m_buffer.data()),
+                             static_cast<std::streamsize>(m_buffer.size() *
+                                                          sizeof(row_t)));
+            }
+        }
+
+        /// Add a row
+        void push_back(const row_t &row)
+        {
+            m_buffer.push_back(row);
+            if (m_buffer.size() >= buffer_rows)
+            {
+                flush();
+            }
+        }
+
+        /// Write the buffered rows to the file
+        void flush()
+        {
+            m_file.write(reinterpret_cast<const char *>(m_buffer.data()),
+                         static_cast<std::streamsize>(m_buffer.size() * sizeof(row_t)));
+            m_buffer.clear();
+            if (!m_file)
+            {
+                throw std::runtime_error("Could not write " + m_path);
+            }
+        }
+
+        /// Write out the buffered rows and close the file, throwing if any
+        /// of it failed
+        void close()
+        {
+            if (!m_file.is_open())
+            {
+                return;
+            }
+            flush();
+            m_file.close();
+            if (!m_file)
+            {
+                throw std::runtime_error("Could not write " + m_path);
+            }
+        }
+
+    private:
+        std::string m_path;
+        std::ofstream m_file;
+        std::vector<row_t> m_buffer;
+
+    }; // class binary_table
+
+    /// On-disk row of residual.bin
+    struct residual_row
+    {
+        std::uint64_t event_id;
+        std::uint64_t track_id;
+        double fit_qop;
+        double fit_qopT;
+        double fit_qopz;
+        double truth_qop;
+        double truth_qopT;
+        double truth_qopz;
+    };
+    static_assert(sizeof(residual_row) == 8u * sizeof(std::uint64_t));
+
+    /// On-disk row of state.bin
+    struct state_row
+    {
+        std::uint64_t event_id;
+        std::uint64_t track_id;
+        double x;
+        double y;
+        double z;
+    };
+    static_assert(sizeof(state_row) == 5u * sizeof(std::uint64_t));
+
+    /// Read the rows of a file written by @c binary_table
+    ///
+    /// @param path    Path of the file
+    /// @param columns Names the header has to list
+    template <typename row_t>
+    std::vector<row_t> read_binary_table(const std::string &path,
+                                         const std::vector<std::string> &columns)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            throw std::runtime_error("Could not open " + path);
+        }
+
+        std::array<char, 8> magic{};
+        std::uint32_t version = 0u;
+        std::uint32_t n_columns = 0u;
+        file.read(magic.data(), magic.size());
+        file.read(reinterpret_cast<char *>(&version), sizeof(version));
+        file.read(reinterpret_cast<char *>(&n_columns), sizeof(n_columns));
+        if (!file || std::string(magic.data(), magic.size()) != "BELLAREC" ||
+            version != binary_table<row_t>::version ||
+            n_columns != columns.size())
+        {
+            throw std::runtime_error(path + " is not a matching BELLA record file");
+        }
+        for (const auto &c : columns)
+        {
+            std::array<char, 16> name{};
+            file.read(name.data(), name.size());
+            const auto end = std::find(name.begin(), name.end(), '\0');
+            if (!file || std::string(name.begin(), end) != c)
+            {
+                throw std::runtime_error(path + " does not hold the column " + c);
+            }
+        }
+
+        std::vector<row_t> rows;
+        row_t row;
+        while (file.read(reinterpret_cast<char *>(&row), sizeof(row_t)))
+        {
+            rows.push_back(row);
+        }
+        return rows;
+    }
+
+    /// Column names of residual.bin
+    inline const std::vector<std::string> &residual_columns()
+    {
+        static const std::vector<std::string> columns{
+            "event_id", "track_id", "fit_qop", "fit_qopT",
+            "fit_qopz", "truth_qop", "truth_qopT", "truth_qopz"};
+        return columns;
+    }
+
+    /// Column names of state.bin
+    inline const std::vector<std::string> &state_columns()
+    {
+        static const std::vector<std::string> columns{"event_id", "track_id",
+                                                      "x", "y", "z"};
+        return columns;
+    }
+
+    /// Writer of the fitting output into residual.bin and state.bin
+    class binary_writer : public record_writer
+    {
+
+    public:
+        /// Constructor
+        ///
+        /// @param residual_path Path of the residual file
+        /// @param state_path    Path of the track state file
+        binary_writer(const std::string &residual_path = "residual.bin",
+                      const std::string &state_path = "state.bin")
+            : m_residuals(residual_path, residual_columns()),
+              m_states(state_path, state_columns())
+        {
+        }
+
+        /// Write the records of one event
+        void write(const event_records &records) override
+        {
+            for (const auto &r : records.residuals)
+            {
+                m_residuals.push_back({r.event_id, r.track_id, r.fit_qop,
+                                       r.fit_qopT, r.fit_qopz, r.truth_qop,
+                                       r.truth_qopT, r.truth_qopz});
+            }
+
+            for (const auto &s : records.states)
+            {
+                m_states.push_back({s.event_id, s.track_id, s.x, s.y, s.z});
+            }
+        }
+
+        /// Write out both files, throwing if any of it failed
+        void close() override
+        {
+            m_residuals.close();
+            m_states.close();
+        }
+
+    private:
+        binary_table<residual_row> m_residuals;
+        binary_table<state_row> m_states;
+
+    }; // class binary_writer
+
+    /// Writer discarding the fitting output, when only its summary is kept
+    class null_writer : public record_writer
+    {
+
+    public:
+        /// Write the records of one event
+        void write(const event_records &) override {}
+
+    }; // class null_writer
+
+    /// Writer handing the records to another writer on a dedicated thread
+    ///
+    /// @c write only copies the records into the buffer of an
+    /// @c async_writer, so the fitting threads do not wait for the file
+    /// system unless @c queue_size events are already waiting.
+    class async_record_writer : public record_writer
+    {
+
+    public:
+        /// Constructor
+        ///
+        /// @param writer     Writer of the files, used on the writer thread
+        /// @param queue_size Maximum number of events waiting to be written
+        async_record_writer(std::unique_ptr<record_writer> writer,
+                            const std::size_t queue_size)
+            : m_writer(std::move(writer)),
+              m_queue(queue_size, [this](event_records &&records)
+                      { m_writer->write(records); })
+        {
+        }
+
+        /// Write the records of one event
+        void write(const event_records &records) override
+        {
+            if (!m_queue.push(event_records(records)))
+            {
+                // The writer thread failed
+                close();
+            }
+        }
+
+        /// Write out the waiting records
+        void close() override
+        {
+            m_queue.close();
+            m_writer->close();
+        }
+
+    private:
+        std::unique_ptr<record_writer> m_writer;
+        async_writer<event_records> m_queue;
+
+    }; // class async_record_writer
+
+    /// Create the writer of the fitting output
+    ///
+    /// @param format     "csv", "binary" or "none"
+    /// @param suffix     Appended to the file names, e.g. "_0.1_GeV_90_theta"
+    /// @param queue_size Maximum number of events waiting for a writer
+    ///                   thread (0: written on the calling thread)
+    inline std::unique_ptr<record_writer> make_record_writer(
+        const std::string &format, const std::string &suffix = "",
+        const std::size_t queue_size = 0u)
+    {
+        std::unique_ptr<record_writer> writer;
+        if (format == "csv")
+        {
+            writer = std::make_unique<csv_writer>("residual" + suffix + ".csv",
+                                                  "state" + suffix + ".csv");
+        }
+        else if (format == "binary")
+        {
+            writer = std::make_unique<binary_writer>("residual" + suffix + ".bin",
+                                                     "state" + suffix + ".bin");
+        }
+        else if (format == "none")
+        {
+            return std::make_unique<null_writer>();
+        }
+        else
+        {
+            throw std::invalid_argument("Unknown output format: " + format);
+        }
+
+        if (queue_size == 0u)
+        {
+            return writer;
+        }
+        return std::make_unique<async_record_writer>(std::move(writer), queue_size);
+    }
+
+} // namespace bella
@@ -0,0 +1,68 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Local include(s).
+#include "src/residual_summary.hpp"
+#include "traccc/options/details/interface.hpp"
+
+// System include(s).
+#include <cstddef>
+#include <string>
+
+namespace traccc::opts
+{
+
+    /// Convenience namespace shorthand
+    namespace po = boost::program_options;
+
+    /// Command line options for the output of the BELLA fitter
+    class fit_output_options : public interface
+    {
+
+    public:
+        /// Constructor
+        fit_output_options() : interface("BELLA Fit Output Options")
+        {
+
+            m_desc.add_options()("output-format",
+                                 po::value(&(format))
+                                     ->default_value("csv"),
+                                 "Format of the residual and state output "
+                                 "(csv, binary or none)");
+            m_desc.add_options()("output-queue-size",
+                                 po::value(&(queue_size))
+                                     ->default_value(16u),
+                                 "Number of events buffered for the output "
+                                 "writer thread before the fitting waits "
+                                 "for it (0: written by the fitting "
+                                 "threads)");
+            m_desc.add_options()("summary-bins",
+                                 po::value(&(summary.bins))
+                                     ->default_value(100u),
+                                 "Number of bins of the residual summary "
+                                 "histograms");
+            m_desc.add_options()("summary-residual-range",
+                                 po::value(&(summary.residual_range))
+                                     ->default_value(0.5),
+                                 "Half range of the relative residual "
+                                 "histograms of the summary");
+            m_desc.add_options()("summary-pull-range",
+                                 po::value(&(summary.pull_range))
+                                     ->default_value(5.),
+                                 "Half range of the pull histograms of the "
+                                 "summary");
+        }
+
+        std::string format;
+        std::size_t queue_size;
+        bella::residual_summary::config summary;
+
+    }; // class fit_output_options
+
+} // namespace traccc::opts
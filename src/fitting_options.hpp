@@ -0,0 +1,76 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Local include(s).
+#include "traccc/options/details/interface.hpp"
+
+// System include(s).
+#include <cstddef>
+#include <string>
+
+namespace traccc::opts
+{
+
+    /// Convenience namespace shorthand
+    namespace po = boost::program_options;
+
+    /// Command line options controlling how the BELLA tracks are fitted
+    class fitting_options : public interface
+    {
+
+    public:
+        /// Constructor
+        fitting_options() : interface("BELLA Fitting Options")
+        {
+
+            m_desc.add_options()("fit-mode",
+                                 po::value(&(mode))
+                                     ->default_value("scalar"),
+                                 "Kalman fitter: scalar (traccc) or batched "
+                                 "(same-topology tracks fitted together, "
+                                 "the others with the scalar fitter; one "
+                                 "thread per event)");
+            m_desc.add_options()("fit-chunk-size",
+                                 po::value(&(chunk_size))
+                                     ->default_value(0u),
+                                 "Number of tracks fitted together in one "
+                                 "chunk of an event (0: whole event)");
+            m_desc.add_options()("fit-threads",
+                                 po::value(&(threads))
+                                     ->default_value(1u),
+                                 "Number of threads fitting the chunks of "
+                                 "one event");
+            m_desc.add_options()("prefetch-events",
+                                 po::value(&(prefetch))
+                                     ->default_value(2u),
+                                 "Number of events read ahead on a "
+                                 "background thread (0: read each event on "
+                                 "the thread fitting it)");
+            m_desc.add_options()("fit-particle",
+                                 po::value(&(particle))
+                                     ->default_value(13),
+                                 "PDG number of the particle hypothesis of "
+                                 "the batched fitter");
+            m_desc.add_options()("fit-max-step",
+                                 po::value(&(max_step))
+                                     ->default_value(2.f),
+                                 "Largest Runge-Kutta step of the batched "
+                                 "fitter in the field [mm]");
+        }
+
+        std::string mode;
+        std::size_t chunk_size;
+        std::size_t threads;
+        std::size_t prefetch;
+        int particle;
+        float max_step;
+
+    }; // class fitting_options
+
+} // namespace traccc::opts
@@ -0,0 +1,269 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Project include(s).
+#include "traccc/definitions/common.hpp"
+#include "traccc/definitions/primitives.hpp"
+#include "traccc/definitions/track_parametrization.hpp"
+#include "traccc/edm/track_candidate.hpp"
+#include "traccc/edm/track_parameters.hpp"
+
+// detray include(s).
+#include "detray/definitions/pdg_particle.hpp"
+
+// Local include(s).
+#include "src/raw_frame.hpp"
+#include "src/telescope_planes.hpp"
+
+// VecMem include(s).
+#include <vecmem/containers/vector.hpp>
+#include <vecmem/memory/memory_resource.hpp>
+
+// System include(s).
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace bella
+{
+
+    namespace detail
+    {
+        using vec3 = std::array<traccc::scalar, 3>;
+
+        inline vec3 sub(const vec3 &a, const vec3 &b)
+        {
+            return {a[0] - b[0], a[1] - b[1], a[2] - b[2]};
+        }
+
+        inline traccc::scalar dot(const vec3 &a, const vec3 &b)
+        {
+            return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+        }
+
+        inline vec3 cross(const vec3 &a, const vec3 &b)
+        {
+            return {a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2],
+                    a[0] * b[1] - a[1] * b[0]};
+        }
+
+        inline vec3 unit_vector(const vec3 &a)
+        {
+            const traccc::scalar n = std::sqrt(dot(a, a));
+            return {a[0] / n, a[1] / n, a[2] / n};
+        }
+    } // namespace detail
+
+    /// Seed on the surface of @c meas, at the measurement, with a diagonal
+    /// covariance
+    ///
+    /// @param meas         First measurement of the track
+    /// @param dir          Global direction of the track
+    /// @param qop          Seed qop
+    /// @param angle_stddev Standard deviation of phi and theta
+    /// @param qop_stddev   Standard deviation of qop
+    inline traccc::bound_track_parameters make_seed(
+        const traccc::measurement &meas, const detail::vec3 &dir,
+        const traccc::scalar qop, const traccc::scalar angle_stddev,
+        const traccc::scalar qop_stddev)
+    {
+        using traccc::scalar;
+
+        traccc::bound_track_parameters seed;
+        seed.set_surface_link(meas.surface_link);
+        seed.set_bound_local(meas.local);
+        seed.set_phi(std::atan2(dir[1], dir[0]));
+        seed.set_theta(std::acos(dir[2]));
+        seed.set_qop(qop);
+        seed.set_time(0.f);
+
+        const std::array<scalar, traccc::e_bound_size> stddevs{
+            std::sqrt(meas.variance[0]),
+            std::sqrt(meas.variance[1]),
+            angle_stddev,
+            angle_stddev,
+            qop_stddev,
+            1.f * traccc::unit<scalar>::ns};
+        auto cov = seed.covariance();
+        for (unsigned int i = 0; i < traccc::e_bound_size; ++i)
+        {
+            for (unsigned int j = 0; j < traccc::e_bound_size; ++j)
+            {
+                traccc::getter::element(cov, i, j) =
+                    i == j ? stddevs[i] * stddevs[i] : 0.f;
+            }
+        }
+        seed.set_covariance(cov);
+        return seed;
+    }
+
+    /// Configuration of the frame seeding
+    struct frame_seeding_config
+    {
+        /// Minimum number of planes with a hit (at least 3)
+        std::size_t min_planes = 3u;
+        /// Momentum assumed where the field along the track is too weak to
+        /// measure it [GeV]
+        traccc::scalar fallback_momentum = 0.1f;
+        /// Field integral across the track below which the fallback momentum
+        /// is used [T mm]
+        traccc::scalar min_field_integral = 1.f;
+        /// Step of the field integral along the hits [mm]
+        traccc::scalar field_step = 1.f;
+        /// Particle hypothesis, for the charge of the fallback momentum
+        detray::pdg_particle<traccc::scalar> ptc_type =
+            detray::muon<traccc::scalar>();
+        /// Standard deviation of the seed direction
+        traccc::scalar angle_stddev = 0.01f;
+        /// Relative standard deviation of the measured and the fallback qop
+        traccc::scalar qop_rel_stddev = 0.3f;
+        traccc::scalar fallback_qop_rel_stddev = 1.f;
+    };
+
+    /// Seeding of frames holding a single track, without truth
+    ///
+    /// A frame with at most one measurement on every plane, and at least
+    /// @c min_planes planes hit, becomes one track candidate. The seed sits
+    /// on the first measurement, points along the first two measurements,
+    /// and takes its qop from the bending between the first and the last
+    /// two measurements through the field integral along the hits:
+    /// the direction changes by qop (t x int B ds), as in the equation of
+    /// motion of the stepper. Frames with several hits on a plane are left
+    /// to the @c track_finder.
+    class frame_seeding
+    {
+
+    public:
+        /// Constructor
+        ///
+        /// @param planes Sensitive planes of the telescope, in plane order
+        /// @param cfg    Seeding configuration
+        frame_seeding(std::vector<sensitive_plane> planes,
+                      const frame_seeding_config &cfg = {})
+            : m_planes(std::move(planes)), m_cfg(cfg)
+        {
+        }
+
+        /// Seed the track of @c frame into @c candidates
+        ///
+        /// @param field      Field view of the stepper
+        /// @param frame      Measurements of the frame
+        /// @param candidates Track candidates the track is added to
+        /// @param mr         Memory resource of the candidate
+        /// @return whether the frame got a candidate
+        template <typename field_view_t>
+        bool operator()(
+            const field_view_t &field, const hit_frame &frame,
+            traccc::track_candidate_container_types::host &candidates,
+            vecmem::memory_resource &mr) const
+        {
+            using traccc::scalar;
+
+            vecmem::vector<traccc::track_candidate> measurements(&mr);
+            std::vector<detail::vec3> positions;
+            for (std::size_t i = 0; i < frame.n_planes(); ++i)
+            {
+                const auto plane_measurements = frame.plane_measurements(i);
+                if (plane_measurements.size() > 1u)
+                {
+                    return false;
+                }
+                if (plane_measurements.empty())
+                {
+                    continue;
+                }
+                const traccc::measurement &meas = plane_measurements[0];
+                const traccc::point3 xyz =
+                    m_planes.at(i).global(meas.local[0], meas.local[1]);
+                measurements.push_back(meas);
+                positions.push_back({xyz[0], xyz[1], xyz[2]});
+            }
+            if (measurements.size() < std::max<std::size_t>(m_cfg.min_planes, 3u))
+            {
+                return false;
+            }
+
+            const detail::vec3 dir =
+                detail::unit_vector(detail::sub(positions[1], positions[0]));
+
+            scalar qop_stddev_rel = m_cfg.qop_rel_stddev;
+            scalar qop = estimate_qop(field, positions, dir);
+            if (!std::isfinite(qop))
+            {
+                qop = m_cfg.ptc_type.charge() /
+                      (m_cfg.fallback_momentum * traccc::unit<scalar>::GeV);
+                qop_stddev_rel = m_cfg.fallback_qop_rel_stddev;
+            }
+
+            const traccc::bound_track_parameters seed =
+                make_seed(measurements[0], dir, qop, m_cfg.angle_stddev,
+                          qop_stddev_rel * std::abs(qop));
+            candidates.push_back(seed, std::move(measurements));
+            return true;
+        }
+
+    private:
+        /// qop from the bending along @c positions, NaN if the field across
+        /// the track is too weak
+        template <typename field_view_t>
+        traccc::scalar estimate_qop(const field_view_t &field,
+                                    const std::vector<detail::vec3> &positions,
+                                    const detail::vec3 &dir) const
+        {
+            using traccc::scalar;
+
+            // Field integral along the straight segments between the hits,
+            // in steps short against the magnet edges
+            detail::vec3 integral{0.f, 0.f, 0.f};
+            for (std::size_t k = 0; k + 1u < positions.size(); ++k)
+            {
+                const detail::vec3 step = detail::sub(positions[k + 1u], positions[k]);
+                const scalar length = std::sqrt(detail::dot(step, step));
+                const std::size_t n_steps = static_cast<std::size_t>(std::ceil(
+                    length / (m_cfg.field_step * traccc::unit<scalar>::mm)));
+                const scalar ds = length / static_cast<scalar>(n_steps);
+                for (std::size_t s = 0; s < n_steps; ++s)
+                {
+                    const scalar t = (static_cast<scalar>(s) + 0.5f) /
+                                     static_cast<scalar>(n_steps);
+                    const auto b = field.at(positions[k][0] + t * step[0],
+                                            positions[k][1] + t * step[1],
+                                            positions[k][2] + t * step[2]);
+                    integral[0] += b[0] * ds;
+                    integral[1] += b[1] * ds;
+                    integral[2] += b[2] * ds;
+                }
+            }
+
+            const detail::vec3 bend = detail::cross(dir, integral);
+            const scalar bend2 = detail::dot(bend, bend);
+            const scalar min_integral = m_cfg.min_field_integral *
+                                        traccc::unit<scalar>::T *
+                                        traccc::unit<scalar>::mm;
+            if (!(bend2 > min_integral * min_integral))
+            {
+                return std::numeric_limits<scalar>::quiet_NaN();
+            }
+
+            const std::size_t n = positions.size();
+            const detail::vec3 dir_out = detail::unit_vector(
+                detail::sub(positions[n - 1u], positions[n - 2u]));
+            return detail::dot(detail::sub(dir_out, dir), bend) / bend2;
+        }
+
+        std::vector<sensitive_plane> m_planes;
+        frame_seeding_config m_cfg;
+
+    }; // class frame_seeding
+
+} // namespace bella
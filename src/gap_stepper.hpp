@@ -0,0 +1,105 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Project include(s).
+#include "traccc/definitions/primitives.hpp"
+#include "traccc/definitions/qualifiers.hpp"
+
+// detray include(s).
+#include "detray/propagator/constrained_step.hpp"
+#include "detray/propagator/rk_stepper.hpp"
+
+// Local include(s).
+#include "src/magnet_field.hpp"
+
+// System include(s).
+#include <type_traits>
+
+namespace bella
+{
+
+    /// Runge-Kutta stepper that crosses the field-free gaps on a straight line
+    ///
+    /// Before every step the straight segment to the next navigation
+    /// candidate is tested against the magnet extents of the field. If the
+    /// field is zero all along it, the track is moved onto the candidate in
+    /// one step with all Runge-Kutta stages set to zero, which is the exact
+    /// (ray) solution and its Jacobian, without any field evaluation or step
+    /// size control. Inside and around the magnets the steps are the usual
+    /// adaptive RK4 steps of @c detray::rk_stepper.
+    ///
+    /// @tparam field_view_t Field view providing @c is_field_free
+    template <typename field_view_t, typename algebra_t = traccc::default_algebra,
+              typename constraint_t = detray::constrained_step<>>
+    class gap_stepper
+        : public detray::rk_stepper<field_view_t, algebra_t, constraint_t>
+    {
+
+    public:
+        using base_type = detray::rk_stepper<field_view_t, algebra_t, constraint_t>;
+        using state = typename base_type::state;
+
+        /// Take a step, on a straight line if it stays clear of the magnets
+        template <typename propagation_state_t>
+        TRACCC_HOST_DEVICE bool step(propagation_state_t &propagation,
+                                     const detray::stepping::config &cfg) const
+        {
+            state &stepping = propagation._stepping;
+            auto &navigation = propagation._navigation;
+
+            // Distance to the next candidate, cut by the step constraints
+            auto h = navigation();
+            const auto step_dir = h >= 0.f ? detray::step::direction::e_forward
+                                           : detray::step::direction::e_backward;
+            const auto constraint =
+                stepping.constraints().template size<>(step_dir);
+            if (detray::math::fabs(h) > detray::math::fabs(constraint))
+            {
+                h = h >= 0.f ? detray::math::fabs(constraint) : -detray::math::fabs(constraint);
+            }
+
+            const auto pos = stepping().pos();
+            const auto end = pos + h * stepping().dir();
+            if (!stepping._magnetic_field.is_field_free(pos, end))
+            {
+                return base_type::step(propagation, cfg);
+            }
+
+            // Zero field: every stage of the RK4 step vanishes
+            stepping._step_data = {};
+            stepping.set_step_size(h);
+            stepping.set_direction(step_dir);
+
+            stepping.advance_track();
+            if (cfg.do_covariance_transport)
+            {
+                stepping.advance_jacobian(cfg);
+            }
+
+            stepping._prev_step_size = stepping._step_size;
+            stepping.run_inspector(cfg, "Straight step complete: ");
+            ++stepping._n_total_trials;
+
+            return true;
+        }
+
+    }; // class gap_stepper
+
+    /// Stepper used with the magnetic field @c field_t
+    ///
+    /// The analytic magnet field knows where it is zero and crosses the gaps
+    /// on straight lines; a field map is stepped through with RK4 everywhere.
+    template <typename field_t>
+    using stepper_type = std::conditional_t<
+        std::is_same_v<field_t, magnet_field>,
+        gap_stepper<typename field_t::view_t>,
+        detray::rk_stepper<typename field_t::view_t, traccc::default_algebra,
+                           detray::constrained_step<>>>;
+
+} // namespace bella
@@ -0,0 +1,192 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Project include(s).
+#include "traccc/definitions/common.hpp"
+#include "traccc/definitions/primitives.hpp"
+
+// detray include(s).
+#include "detray/materials/material.hpp"
+#include "detray/materials/predefined_materials.hpp"
+
+// Local include(s).
+#include "src/field_options.hpp"
+#include "src/magnet_field.hpp"
+
+// System include(s).
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace bella
+{
+
+    /// Passive material slab, e.g. an attenuator or a magnet yoke, placed
+    /// across the beam like a sensitive plane
+    struct passive_slab
+    {
+        /// x position of the slab
+        traccc::scalar position;
+        /// Material name, see @c material_from_name
+        std::string material;
+        /// Thickness of the slab
+        traccc::scalar thickness;
+    };
+
+    /// Layout of the BELLA telescope, in mm and Tesla
+    ///
+    /// The defaults are the layout the experiment was built with.
+    struct geometry_config
+    {
+        /// x positions of the sensitive planes
+        std::vector<traccc::scalar> plane_positions{
+            10.f, 20.f, 30.f,    // 3 SCC
+            60.f, 70.f, 80.f,    // 3 SCC
+            180.f, 190.f, 200.f, // 3 SCC
+            230.f, 240.f, 250.f  // 3 SCC
+        };
+        /// Material of the sensitive planes
+        std::string plane_material = "silicon";
+        /// Thickness of the sensitive planes
+        traccc::scalar plane_thickness = 1.f;
+        /// Half length of the square sensitive planes
+        traccc::scalar plane_half_length = 100.f;
+        /// Magnet boxes
+        std::vector<magnet_box> magnets = bella_magnets();
+        /// Passive material slabs, of the size of the sensitive planes
+        std::vector<passive_slab> passive_slabs;
+    };
+
+    /// Predefined detray material called @c name
+    inline detray::material<traccc::scalar> material_from_name(
+        const std::string &name)
+    {
+        using traccc::scalar;
+
+        if (name == "silicon")
+        {
+            return detray::silicon<scalar>();
+        }
+        if (name == "iron")
+        {
+            return detray::iron<scalar>();
+        }
+        if (name == "aluminium")
+        {
+            return detray::aluminium<scalar>();
+        }
+        if (name == "beryllium")
+        {
+            return detray::beryllium<scalar>();
+        }
+        if (name == "tungsten")
+        {
+            return detray::tungsten<scalar>();
+        }
+        throw std::invalid_argument("Unknown material: " + name);
+    }
+
+    namespace detail
+    {
+
+        /// Parse a comma separated list of numbers
+        inline std::vector<float> parse_numbers(const std::string &list)
+        {
+            std::vector<float> numbers;
+
+            std::stringstream ss(list);
+            std::string value;
+            while (std::getline(ss, value, ','))
+            {
+                if (value.empty())
+                {
+                    continue;
+                }
+                std::size_t n_parsed = 0u;
+                numbers.push_back(std::stof(value, &n_parsed));
+                if (n_parsed != value.size())
+                {
+                    throw std::invalid_argument("Invalid number: " + value);
+                }
+            }
+            return numbers;
+        }
+
+    } // namespace detail
+
+    /// Telescope layout described by the geometry options
+    inline geometry_config make_geometry_config(
+        const traccc::opts::bella_geometry_options &opts)
+    {
+        geometry_config cfg;
+
+        const auto positions = detail::parse_numbers(opts.plane_positions);
+        cfg.plane_positions.assign(positions.begin(), positions.end());
+        if (cfg.plane_positions.empty())
+        {
+            throw std::invalid_argument("No sensitive plane positions");
+        }
+
+        cfg.plane_material = opts.plane_material;
+        // Fail early on a typo rather than in the detector builder
+        material_from_name(cfg.plane_material);
+
+        cfg.plane_thickness = opts.plane_thickness;
+        cfg.plane_half_length = opts.plane_half_length;
+
+        // No --magnet keeps the BELLA magnets
+        if (!opts.magnets.empty())
+        {
+            cfg.magnets.clear();
+        }
+        for (const std::string &magnet : opts.magnets)
+        {
+            if (magnet == "none")
+            {
+                continue;
+            }
+            const auto v = detail::parse_numbers(magnet);
+            if (v.size() != 9u)
+            {
+                throw std::invalid_argument("A magnet needs 9 numbers: " + magnet);
+            }
+            cfg.magnets.push_back(
+                {{v[0], v[1], v[2]}, {v[3], v[4], v[5]}, {v[6], v[7], v[8]}});
+        }
+
+        for (const std::string &slab : opts.passive_slabs)
+        {
+            // "x,material,thickness"
+            const auto first = slab.find(',');
+            const auto last = slab.rfind(',');
+            if (first == std::string::npos || first == last)
+            {
+                throw std::invalid_argument("A passive slab needs a position, "
+                                            "a material and a thickness: " +
+                                            slab);
+            }
+            const auto position = detail::parse_numbers(slab.substr(0, first));
+            const auto thickness = detail::parse_numbers(slab.substr(last + 1));
+            if (position.size() != 1u || thickness.size() != 1u)
+            {
+                throw std::invalid_argument("Invalid passive slab: " + slab);
+            }
+
+            passive_slab passive{position[0],
+                                 slab.substr(first + 1, last - first - 1),
+                                 thickness[0]};
+            material_from_name(passive.material);
+            cfg.passive_slabs.push_back(passive);
+        }
+
+        return cfg;
+    }
+
+} // namespace bella
@@ -0,0 +1,44 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Local include(s).
+#include "traccc/options/details/interface.hpp"
+
+// System include(s).
+#include <string>
+
+namespace traccc::opts
+{
+
+    /// Convenience namespace shorthand
+    namespace po = boost::program_options;
+
+    /// Command line options choosing where the fitted geometry comes from
+    class geometry_source_options : public interface
+    {
+
+    public:
+        /// Constructor
+        geometry_source_options() : interface("BELLA Geometry Source Options")
+        {
+
+            m_desc.add_options()("geometry-source",
+                                 po::value(&(source))
+                                     ->default_value("json"),
+                                 "Geometry of the fit: json (read from "
+                                 "--detector-file) or builder (rebuilt in "
+                                 "memory by the simulation's telescope "
+                                 "builder)");
+        }
+
+        std::string source;
+
+    }; // class geometry_source_options
+
+} // namespace traccc::opts
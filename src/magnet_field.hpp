@@ -0,0 +1,243 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Project include(s).
+#include "traccc/definitions/common.hpp"
+#include "traccc/definitions/qualifiers.hpp"
+
+// System include(s).
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace bella
+{
+
+    /// Box shaped region of uniform magnetic field
+    struct magnet_box
+    {
+        /// Lower corner of the box [mm]
+        std::array<float, 3> min;
+        /// Upper corner of the box [mm]
+        std::array<float, 3> max;
+        /// Field inside the box [T]
+        std::array<float, 3> field;
+    };
+
+    /// The BELLA magnets, the default of the geometry options
+    inline std::vector<magnet_box> bella_magnets()
+    {
+        return {{{40.f, -10.f, -10.f}, {50.f, 10.f, 10.f}, {0.f, 0.5f, 0.f}},
+                {{210.f, -10.f, -10.f}, {220.f, 10.f, 10.f}, {0.f, 0.5f, 0.f}}};
+    }
+
+    /// Field strength along one axis, relative to the box value
+    ///
+    /// One on [@c inner_min, @c inner_max], falling linearly to zero at
+    /// @c outer_min and @c outer_max, and zero outside.
+    struct field_profile
+    {
+        float outer_min;
+        float inner_min;
+        float inner_max;
+        float outer_max;
+
+        TRACCC_HOST_DEVICE
+        float operator()(const float v) const
+        {
+            if (v <= outer_min || v >= outer_max)
+            {
+                return 0.f;
+            }
+            if (v < inner_min)
+            {
+                return (v - outer_min) / (inner_min - outer_min);
+            }
+            if (v > inner_max)
+            {
+                return (outer_max - v) / (outer_max - inner_max);
+            }
+            return 1.f;
+        }
+    };
+
+    class magnet_field;
+
+    /// Field view of a few magnet boxes, usable in place of a covfie view
+    ///
+    /// Everything is stored by value, so the view can be copied to a device
+    /// as it is. Outside the boxes the field is zero after a bounding box
+    /// test per magnet, with no grid lookup.
+    class magnet_field_view
+    {
+
+    public:
+        /// Maximum number of magnets in one field
+        static constexpr std::size_t max_magnets = 4u;
+
+        using output_t = std::array<float, 3>;
+
+        /// Construct the view of a field
+        magnet_field_view(const magnet_field &field);
+
+        /// Field at the global position (@c x, @c y, @c z), in internal units
+        TRACCC_HOST_DEVICE
+        output_t at(const float x, const float y, const float z) const
+        {
+            output_t b{0.f, 0.f, 0.f};
+            for (unsigned int i = 0; i < m_n_magnets; ++i)
+            {
+                const magnet &m = m_magnets[i];
+                if (x <= m.profile[0].outer_min || x >= m.profile[0].outer_max ||
+                    y <= m.profile[1].outer_min || y >= m.profile[1].outer_max ||
+                    z <= m.profile[2].outer_min || z >= m.profile[2].outer_max)
+                {
+                    continue;
+                }
+                const float w = m.profile[0](x) * m.profile[1](y) * m.profile[2](z);
+                b[0] += w * m.field[0];
+                b[1] += w * m.field[1];
+                b[2] += w * m.field[2];
+            }
+            return b;
+        }
+
+        /// Whether the field is zero on the whole straight segment from
+        /// @c a to @c b
+        template <typename point3_t>
+        TRACCC_HOST_DEVICE bool is_field_free(const point3_t &a,
+                                              const point3_t &b) const
+        {
+            for (unsigned int i = 0; i < m_n_magnets; ++i)
+            {
+                if (crosses(m_magnets[i], a, b))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+    private:
+        /// One magnet in internal units
+        struct magnet
+        {
+            std::array<field_profile, 3> profile;
+            std::array<float, 3> field;
+        };
+
+        /// Whether the segment from @c a to @c b touches the region of
+        /// @c m where the field is not zero (slab test)
+        template <typename point3_t>
+        TRACCC_HOST_DEVICE static bool crosses(const magnet &m,
+                                               const point3_t &a,
+                                               const point3_t &b)
+        {
+            float t_min = 0.f;
+            float t_max = 1.f;
+            for (unsigned int i = 0; i < 3u; ++i)
+            {
+                const float lo = m.profile[i].outer_min;
+                const float hi = m.profile[i].outer_max;
+                const float start = static_cast<float>(a[i]);
+                const float delta = static_cast<float>(b[i]) - start;
+
+                if (delta == 0.f)
+                {
+                    if (start <= lo || start >= hi)
+                    {
+                        return false;
+                    }
+                    continue;
+                }
+
+                float t0 = (lo - start) / delta;
+                float t1 = (hi - start) / delta;
+                if (t0 > t1)
+                {
+                    const float t = t0;
+                    t0 = t1;
+                    t1 = t;
+                }
+                t_min = t0 > t_min ? t0 : t_min;
+                t_max = t1 < t_max ? t1 : t_max;
+                if (t_min >= t_max)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        std::array<magnet, max_magnets> m_magnets{};
+        unsigned int m_n_magnets = 0u;
+
+    }; // class magnet_field_view
+
+    /// Analytic magnetic field of the BELLA magnet boxes
+    ///
+    /// The field of every box falls off linearly over @c edge_width beyond
+    /// its faces. With @c edge_width equal to the spacing of a field map
+    /// whose grid points lie on the box faces, this is exactly the
+    /// trilinear interpolation of that map, as seen by the stepper through
+    /// the covfie field. An edge width of zero gives sharp box edges.
+    class magnet_field
+    {
+
+    public:
+        using view_t = magnet_field_view;
+
+        /// Constructor
+        ///
+        /// @param magnets    Magnet boxes, with the field in Tesla
+        /// @param edge_width Width of the linear fall-off [mm]
+        magnet_field(const std::vector<magnet_box> &magnets,
+                     const float edge_width)
+            : m_magnets(magnets), m_edge_width(edge_width)
+        {
+            if (m_magnets.size() > view_t::max_magnets)
+            {
+                throw std::invalid_argument("Too many magnets");
+            }
+            if (edge_width < 0.f)
+            {
+                throw std::invalid_argument("Negative magnet edge width");
+            }
+        }
+
+        /// Magnet boxes of the field
+        const std::vector<magnet_box> &magnets() const { return m_magnets; }
+
+        /// Width of the linear fall-off beyond the box faces [mm]
+        float edge_width() const { return m_edge_width; }
+
+    private:
+        std::vector<magnet_box> m_magnets;
+        float m_edge_width;
+
+    }; // class magnet_field
+
+    inline magnet_field_view::magnet_field_view(const magnet_field &field)
+    {
+        const float w = field.edge_width() * traccc::unit<float>::mm;
+        for (const magnet_box &box : field.magnets())
+        {
+            magnet &m = m_magnets[m_n_magnets++];
+            for (unsigned int i = 0; i < 3u; ++i)
+            {
+                const float lo = box.min[i] * traccc::unit<float>::mm;
+                const float hi = box.max[i] * traccc::unit<float>::mm;
+                m.profile[i] = {lo - w, lo, hi, hi + w};
+                m.field[i] = box.field[i] * traccc::unit<float>::T;
+            }
+        }
+    }
+
+} // namespace bella
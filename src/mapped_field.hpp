@@ -0,0 +1,265 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Project include(s).
+#include "traccc/definitions/common.hpp"
+#include "traccc/definitions/qualifiers.hpp"
+
+// Local include(s).
+#include "src/field_grid.hpp"
+
+// System include(s).
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+// POSIX include(s).
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace bella
+{
+
+    /// Field map file that is used in place from a memory mapping
+    ///
+    /// The file starts with a @c map_header, followed by the field of every
+    /// grid point as three floats in internal units, with z running fastest
+    /// and x slowest. The data starts at a 8 byte aligned offset and is read
+    /// through a shared, read-only mapping, so all processes of a node
+    /// reading the same file share one copy of it in the page cache.
+    namespace field_map_format
+    {
+
+        /// Format version
+        static constexpr std::uint32_t version = 1u;
+
+        /// Header of the file
+        struct map_header
+        {
+            std::array<char, 8> magic;
+            std::uint32_t version;
+            std::uint32_t reserved;
+            std::array<std::uint64_t, 3> n;
+            std::array<double, 3> min;
+            double spacing;
+        };
+
+        static constexpr std::array<char, 8> magic = {'B', 'E', 'L', 'L',
+                                                      'A', 'B', 'F', 'M'};
+
+    } // namespace field_map_format
+
+    /// Write the field of @c sampler into a mappable field map file
+    ///
+    /// @param path    Path of the file
+    /// @param sampler Magnet field on the grid points
+    /// @param grid    Grid of the map, the one of @c sampler
+    inline void write_mapped_field(const std::string &path,
+                                   const magnet_grid_sampler &sampler,
+                                   const field_grid &grid)
+    {
+        std::ofstream file(path, std::ios::binary);
+        if (!file)
+        {
+            throw std::runtime_error("Could not open " + path);
+        }
+
+        const field_map_format::map_header header{
+            field_map_format::magic,
+            field_map_format::version,
+            0u,
+            {sampler.axis(0).size(), sampler.axis(1).size(),
+             sampler.axis(2).size()},
+            grid.min,
+            grid.spacing};
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+        // One z row at a time, so the map is never held in memory
+        magnet_grid_sampler::row_type row(header.n[2]);
+        for (std::size_t i = 0; i < header.n[0]; ++i)
+        {
+            for (std::size_t j = 0; j < header.n[1]; ++j)
+            {
+                // Tesla to the internal field unit, as for the covfie map
+                sampler.fill_row(i, j, traccc::unit<float>::T, row);
+                file.write(reinterpret_cast<const char *>(row.data()),
+                           static_cast<std::streamsize>(row.size() *
+                                                        sizeof(row[0])));
+            }
+        }
+        if (!file)
+        {
+            throw std::runtime_error("Could not write " + path);
+        }
+    }
+
+    class mapped_field;
+
+    /// View of a memory-mapped field map, usable in place of a covfie view
+    ///
+    /// Interpolates trilinearly between the grid points, like the covfie
+    /// field map. Outside the grid the field of the nearest grid face is
+    /// used, where covfie would read out of bounds.
+    class mapped_field_view
+    {
+
+    public:
+        using output_t = std::array<float, 3>;
+
+        /// Construct the view of a field
+        mapped_field_view(const mapped_field &field);
+
+        /// Field at the global position (@c x, @c y, @c z), in internal units
+        TRACCC_HOST_DEVICE
+        output_t at(const float x, const float y, const float z) const
+        {
+            std::array<std::size_t, 3> i0;
+            std::array<float, 3> t;
+            locate(0u, x, i0[0], t[0]);
+            locate(1u, y, i0[1], t[1]);
+            locate(2u, z, i0[2], t[2]);
+
+            output_t b{0.f, 0.f, 0.f};
+            for (unsigned int c = 0; c < 8u; ++c)
+            {
+                const std::size_t di = c >> 2;
+                const std::size_t dj = (c >> 1) & 1u;
+                const std::size_t dk = c & 1u;
+                const float w = (di != 0u ? t[0] : 1.f - t[0]) *
+                                (dj != 0u ? t[1] : 1.f - t[1]) *
+                                (dk != 0u ? t[2] : 1.f - t[2]);
+                const float *v =
+                    m_data + 3u * (((i0[0] + di) * m_n[1] + i0[1] + dj) * m_n[2] +
+                                   i0[2] + dk);
+                b[0] += w * v[0];
+                b[1] += w * v[1];
+                b[2] += w * v[2];
+            }
+            return b;
+        }
+
+    private:
+        /// Lower grid index and interpolation weight of @c v along @c axis
+        TRACCC_HOST_DEVICE
+        void locate(const unsigned int axis, const float v, std::size_t &i,
+                    float &t) const
+        {
+            float u = (v - m_min[axis]) * m_inv_spacing;
+            const float last = static_cast<float>(m_n[axis] - 1u);
+            u = u < 0.f ? 0.f : (u > last ? last : u);
+
+            // The last cell is used for points on the upper face
+            i = static_cast<std::size_t>(u);
+            i = i + 1u < m_n[axis] ? i : m_n[axis] - 2u;
+            t = u - static_cast<float>(i);
+        }
+
+        const float *m_data;
+        std::array<std::size_t, 3> m_n;
+        std::array<float, 3> m_min;
+        float m_inv_spacing;
+
+    }; // class mapped_field_view
+
+    /// Field map used in place from a read-only mapping of its file
+    ///
+    /// The map is neither read nor copied at construction; the pages are
+    /// faulted in on first use from the page cache shared by every process
+    /// mapping the same file.
+    class mapped_field
+    {
+
+    public:
+        using view_t = mapped_field_view;
+
+        /// Constructor
+        ///
+        /// @param path Path of a file written by @c write_mapped_field
+        explicit mapped_field(const std::string &path)
+        {
+            const int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+            {
+                throw std::runtime_error("Could not open " + path);
+            }
+
+            struct stat st;
+            if (::fstat(fd, &st) != 0)
+            {
+                ::close(fd);
+                throw std::runtime_error("Could not stat " + path);
+            }
+            m_size = static_cast<std::size_t>(st.st_size);
+            if (m_size < sizeof(field_map_format::map_header))
+            {
+                ::close(fd);
+                throw std::runtime_error(path + " is not a BELLA field map");
+            }
+
+            void *data = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (data == MAP_FAILED)
+            {
+                throw std::runtime_error("Could not map " + path);
+            }
+            m_data = static_cast<const char *>(data);
+
+            m_header = *reinterpret_cast<const field_map_format::map_header *>(m_data);
+            const std::size_t n_points = m_header.n[0] * m_header.n[1] * m_header.n[2];
+            if (m_header.magic != field_map_format::magic ||
+                m_header.version != field_map_format::version ||
+                m_header.n[0] < 2u || m_header.n[1] < 2u || m_header.n[2] < 2u ||
+                m_size != sizeof(m_header) + 3u * sizeof(float) * n_points)
+            {
+                ::munmap(const_cast<char *>(m_data), m_size);
+                throw std::runtime_error(path + " is not a BELLA field map");
+            }
+        }
+
+        /// Destructor
+        ~mapped_field() { ::munmap(const_cast<char *>(m_data), m_size); }
+
+        mapped_field(const mapped_field &) = delete;
+        mapped_field &operator=(const mapped_field &) = delete;
+
+        /// Header of the map, with its grid
+        const field_map_format::map_header &header() const { return m_header; }
+
+        /// Field values of the grid points
+        const float *values() const
+        {
+            return reinterpret_cast<const float *>(m_data + sizeof(m_header));
+        }
+
+    private:
+        const char *m_data = nullptr;
+        std::size_t m_size = 0u;
+        field_map_format::map_header m_header;
+
+    }; // class mapped_field
+
+    inline mapped_field_view::mapped_field_view(const mapped_field &field)
+        : m_data(field.values())
+    {
+        const auto &header = field.header();
+        for (unsigned int i = 0; i < 3u; ++i)
+        {
+            m_n[i] = static_cast<std::size_t>(header.n[i]);
+            m_min[i] = static_cast<float>(header.min[i] * traccc::unit<double>::mm);
+        }
+        m_inv_spacing =
+            static_cast<float>(1. / (header.spacing * traccc::unit<double>::mm));
+    }
+
+} // namespace bella
@@ -0,0 +1,155 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Project include(s).
+#include "traccc/definitions/primitives.hpp"
+#include "traccc/edm/measurement.hpp"
+#include "traccc/edm/particle.hpp"
+
+// detray include(s).
+#include "detray/definitions/pdg_particle.hpp"
+#include "detray/propagator/base_actor.hpp"
+
+// Local include(s).
+#include "src/bounded_queue.hpp"
+#include "src/event_store.hpp"
+
+// System include(s).
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace bella
+{
+
+    /// Simulation writer that keeps the smeared measurements in memory
+    ///
+    /// Drop-in replacement of @c traccc::smearing_writer for
+    /// @c traccc::simulator: instead of writing csv files, every simulated
+    /// event is collected into a @c truth_event and pushed into a queue when
+    /// the simulator finishes the event. The queue is a @c bounded_queue
+    /// feeding the fitting, or an @c async_writer writing the events out on
+    /// its own thread.
+    template <typename smearer_t,
+              typename queue_t = bounded_queue<truth_event>>
+    struct memory_writer : detray::actor
+    {
+
+        struct config
+        {
+            smearer_t smearer;
+            /// Particle type, for the charge and pdg number of the particles
+            detray::pdg_particle<traccc::scalar> ptc_type;
+            /// Queue receiving the events, owned by the caller
+            queue_t *events = nullptr;
+        };
+
+        struct state
+        {
+            /// Constructor with the same signature as the smearing writer;
+            /// @c directory is not used
+            state(std::size_t event_id, config &&writer_cfg,
+                  const std::string & /*directory*/)
+                : m_meas_smearer(writer_cfg.smearer),
+                  m_ptc_type(writer_cfg.ptc_type),
+                  m_events(writer_cfg.events)
+            {
+                m_event.event_id = event_id;
+            }
+
+            /// Hand the finished event to the queue
+            ~state()
+            {
+                // Close the measurement range of the last particle
+                if (!m_event.particles.empty())
+                {
+                    m_event.measurement_offsets.push_back(
+                        m_event.measurements.size());
+                }
+
+                if (m_events != nullptr)
+                {
+                    m_events->push(std::move(m_event));
+                }
+            }
+
+            state(const state &) = delete;
+            state &operator=(const state &) = delete;
+
+            std::size_t m_particle_id = 0u;
+            smearer_t m_meas_smearer;
+            detray::pdg_particle<traccc::scalar> m_ptc_type;
+            queue_t *m_events;
+            truth_event m_event;
+
+            void set_seed(const uint_fast64_t sd) { m_meas_smearer.set_seed(sd); }
+
+            template <typename track_parameters_t>
+            void write_particle(const track_parameters_t &track)
+            {
+                // Close the measurement range of the previous particle
+                if (!m_event.particles.empty())
+                {
+                    m_event.measurement_offsets.push_back(
+                        m_event.measurements.size());
+                }
+
+                traccc::particle ptc{};
+                ptc.particle_id = m_particle_id;
+                ptc.particle_type = m_ptc_type.pdg_num();
+                ptc.pos = track.pos();
+                ptc.time = track.time();
+                ptc.momentum = momentum(track);
+                ptc.mass = m_ptc_type.mass();
+                ptc.charge = m_ptc_type.charge();
+                m_event.particles.push_back(ptc);
+            }
+
+            /// Momentum vector of free track parameters
+            template <typename track_parameters_t>
+            traccc::vector3 momentum(const track_parameters_t &track) const
+            {
+                return (m_ptc_type.charge() / track.qop()) * track.dir();
+            }
+        };
+
+        template <typename propagator_state_t>
+        void operator()(state &writer_state,
+                        propagator_state_t &propagation) const
+        {
+            const auto &navigation = propagation._navigation;
+
+            if (!navigation.is_on_sensitive())
+            {
+                return;
+            }
+
+            const auto &stepping = propagation._stepping;
+            const auto &bound_params = stepping._bound_params;
+
+            // Smeared measurement on the local plane coordinates
+            const auto offset = writer_state.m_meas_smearer.get_offset();
+            const auto &stddev = writer_state.m_meas_smearer.stddev;
+            const auto local = bound_params.bound_local();
+
+            traccc::measurement meas{};
+            meas.local = {local[0] + offset[0], local[1] + offset[1]};
+            meas.variance = {stddev[0] * stddev[0], stddev[1] * stddev[1]};
+            meas.surface_link = navigation.barcode();
+            meas.meas_dim = 2u;
+            meas.measurement_id = writer_state.m_event.measurements.size();
+
+            writer_state.m_event.measurements.push_back(meas);
+            writer_state.m_event.truths.push_back(
+                {stepping().pos(), writer_state.momentum(stepping())});
+        }
+    };
+
+} // namespace bella
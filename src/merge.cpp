@@ -0,0 +1,127 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+// Project include(s).
+#include "traccc/options/program_options.hpp"
+
+// Local include(s).
+#include "src/fit_output.hpp"
+#include "src/merge_options.hpp"
+#include "src/residual_summary.hpp"
+#include "src/summary_io.hpp"
+
+// System include(s).
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+
+    /// Concatenate the rows of the binary record files @c inputs into
+    /// @c output, ordered by event and track
+    template <typename row_t>
+    std::size_t merge_tables(const std::vector<std::string> &inputs,
+                             const std::vector<std::string> &columns,
+                             const std::string &output)
+    {
+        std::vector<row_t> rows;
+        for (const std::string &path : inputs)
+        {
+            const auto shard_rows = bella::read_binary_table<row_t>(path, columns);
+            rows.insert(rows.end(), shard_rows.begin(), shard_rows.end());
+        }
+
+        // Stable, so the states of one track keep their order
+        std::stable_sort(rows.begin(), rows.end(),
+                         [](const row_t &a, const row_t &b)
+                         {
+                             return std::tie(a.event_id, a.track_id) <
+                                    std::tie(b.event_id, b.track_id);
+                         });
+
+        bella::binary_table<row_t> table(output, columns);
+        for (const row_t &row : rows)
+        {
+            table.push_back(row);
+        }
+        table.close();
+        return rows.size();
+    }
+
+} // namespace
+
+// The main routine
+//
+int main(int argc, char *argv[])
+{
+    // Program options.
+    traccc::opts::merge_options merge_opts;
+    traccc::opts::program_options program_opts{
+        "Merge the Outputs of the Shards of a Job Array",
+        {merge_opts},
+        argc,
+        argv};
+
+    if (merge_opts.residuals.empty() && merge_opts.states.empty() &&
+        merge_opts.summaries.empty())
+    {
+        throw std::invalid_argument("Nothing to merge");
+    }
+
+    if (!merge_opts.residuals.empty())
+    {
+        const std::string path = merge_opts.output + "_residual.bin";
+        const std::size_t n = merge_tables<bella::residual_row>(
+            merge_opts.residuals, bella::residual_columns(), path);
+        std::cout << "Merged " << n << " tracks of "
+                  << merge_opts.residuals.size() << " files into " << path
+                  << std::endl;
+    }
+
+    if (!merge_opts.states.empty())
+    {
+        const std::string path = merge_opts.output + "_state.bin";
+        const std::size_t n = merge_tables<bella::state_row>(
+            merge_opts.states, bella::state_columns(), path);
+        std::cout << "Merged " << n << " track states of "
+                  << merge_opts.states.size() << " files into " << path
+                  << std::endl;
+    }
+
+    if (!merge_opts.summaries.empty())
+    {
+        std::optional<bella::residual_summary> merged;
+        for (const std::string &path : merge_opts.summaries)
+        {
+            const bella::residual_summary summary =
+                bella::read_residual_summary(path);
+            if (merged)
+            {
+                merged->merge(summary);
+            }
+            else
+            {
+                merged.emplace(summary);
+            }
+        }
+
+        const std::string path = merge_opts.output + "_residual_summary.json";
+        merged->write(path);
+        merged->report(std::cout);
+        std::cout << "Merged " << merge_opts.summaries.size()
+                  << " summaries into " << path << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
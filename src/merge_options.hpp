@@ -0,0 +1,56 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Local include(s).
+#include "traccc/options/details/interface.hpp"
+
+// System include(s).
+#include <string>
+#include <vector>
+
+namespace traccc::opts
+{
+
+    /// Convenience namespace shorthand
+    namespace po = boost::program_options;
+
+    /// Command line options for merging the outputs of several shards
+    class merge_options : public interface
+    {
+
+    public:
+        /// Constructor
+        merge_options() : interface("BELLA Merge Options")
+        {
+
+            m_desc.add_options()("residual-inputs",
+                                 po::value(&(residuals))->multitoken(),
+                                 "Binary residual files of the shards");
+            m_desc.add_options()("state-inputs",
+                                 po::value(&(states))->multitoken(),
+                                 "Binary state files of the shards");
+            m_desc.add_options()("summary-inputs",
+                                 po::value(&(summaries))->multitoken(),
+                                 "Residual summaries of the shards");
+            m_desc.add_options()("merge-output",
+                                 po::value(&(output))
+                                     ->default_value("merged"),
+                                 "Prefix of the merged files, written as "
+                                 "<prefix>_residual.bin, <prefix>_state.bin "
+                                 "and <prefix>_residual_summary.json");
+        }
+
+        std::vector<std::string> residuals;
+        std::vector<std::string> states;
+        std::vector<std::string> summaries;
+        std::string output;
+
+    }; // class merge_options
+
+} // namespace traccc::opts
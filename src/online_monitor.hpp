@@ -0,0 +1,119 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Project include(s).
+#include "traccc/definitions/common.hpp"
+
+// Local include(s).
+#include "src/residual_summary.hpp"
+#include "src/track_records.hpp"
+
+// System include(s).
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <initializer_list>
+#include <iomanip>
+#include <ostream>
+
+namespace bella
+{
+
+    /// Fitted momentum and latency of the reconstructed frames, reported
+    /// while the data is taken
+    ///
+    /// Every @c interval frames one line is printed with the momentum of the
+    /// tracks and the latency from reading a frame to its fitted tracks
+    /// over that interval, and the totals are kept for the final report.
+    class online_monitor
+    {
+
+    public:
+        using clock = std::chrono::steady_clock;
+
+        /// Constructor
+        ///
+        /// @param os       Stream the reports are printed to
+        /// @param interval Frames per report (0: only the final report)
+        /// @param charge   Charge of the particle hypothesis, for |p|
+        online_monitor(std::ostream &os, const std::size_t interval,
+                       const traccc::scalar charge)
+            : m_os(os), m_interval(interval), m_charge(std::abs(charge))
+        {
+        }
+
+        /// Add the fitted tracks of one frame, read at @c read_time
+        void add(const event_records &records, const bool seeded,
+                 const clock::time_point read_time)
+        {
+            const double latency =
+                std::chrono::duration<double, std::milli>(clock::now() - read_time)
+                    .count();
+            for (interval_stats *s : {&m_current, &m_total})
+            {
+                ++s->frames;
+                s->seeded += seeded ? 1u : 0u;
+                s->latency.add(latency);
+                for (const residual_record &r : records.residuals)
+                {
+                    const double p =
+                        m_charge / std::abs(r.fit_qop) / traccc::unit<double>::GeV;
+                    if (std::isfinite(p))
+                    {
+                        s->momentum.add(p);
+                    }
+                }
+            }
+
+            if (m_interval != 0u && m_current.frames == m_interval)
+            {
+                print("frames", m_current);
+                m_current = {};
+            }
+        }
+
+        /// Print the totals
+        void report() { print("total", m_total); }
+
+    private:
+        struct interval_stats
+        {
+            std::size_t frames = 0u;
+            std::size_t seeded = 0u;
+            running_stats momentum;
+            running_stats latency;
+        };
+
+        void print(const char *label, const interval_stats &s) const
+        {
+            const auto flags = m_os.flags();
+            const auto precision = m_os.precision();
+
+            m_os << std::left << std::setw(8) << label << std::right
+                 << std::setw(10) << s.frames << " frames, " << std::setw(10)
+                 << s.seeded << " seeded, p = " << std::fixed
+                 << std::setprecision(4) << s.momentum.mean() << " +- "
+                 << s.momentum.rms() << " GeV (" << s.momentum.count()
+                 << " tracks), latency " << std::setprecision(2)
+                 << s.latency.mean() << " ms mean, " << s.latency.max()
+                 << " ms max" << std::endl;
+
+            m_os.flags(flags);
+            m_os.precision(precision);
+        }
+
+        std::ostream &m_os;
+        std::size_t m_interval;
+        traccc::scalar m_charge;
+        interval_stats m_current;
+        interval_stats m_total;
+
+    }; // class online_monitor
+
+} // namespace bella
@@ -0,0 +1,143 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+// Project include(s).
+#include "traccc/options/detector.hpp"
+#include "traccc/options/input_data.hpp"
+#include "traccc/options/program_options.hpp"
+#include "traccc/utils/event_data.hpp"
+
+// Detray include(s).
+#include "detray/core/detector.hpp"
+#include "detray/core/detector_metadata.hpp"
+#include "detray/io/frontend/detector_reader.hpp"
+
+// Local include(s).
+#include "src/async_writer.hpp"
+#include "src/event_store.hpp"
+#include "src/event_store_options.hpp"
+#include "src/field_options.hpp"
+#include "src/geometry_config.hpp"
+#include "src/raw_data_options.hpp"
+#include "src/raw_frame.hpp"
+#include "src/telescope_planes.hpp"
+
+// VecMem include(s).
+#include <vecmem/memory/host_memory_resource.hpp>
+
+// System include(s).
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+using namespace traccc;
+
+// The main routine
+//
+int main(int argc, char *argv[])
+{
+    // Program options.
+    traccc::opts::detector detector_opts;
+    traccc::opts::input_data input_opts;
+    traccc::opts::event_store_options store_opts;
+    traccc::opts::raw_data_options raw_opts;
+    traccc::opts::bella_geometry_options geometry_opts;
+    traccc::opts::program_options program_opts{
+        "Pack Simulated Events into a BELLA Event Store",
+        {detector_opts, input_opts, store_opts, raw_opts, geometry_opts},
+        argc,
+        argv};
+
+    if (store_opts.file.empty() && raw_opts.output.empty())
+    {
+        throw std::invalid_argument(
+            "No --event-store file or --raw-output stream given");
+    }
+
+    /// Type declarations
+    using host_detector_type = detray::detector<detray::default_metadata,
+                                                detray::host_container_types>;
+
+    // Memory resources used by the application.
+    vecmem::host_memory_resource host_mr;
+
+    // Read the detector
+    detray::io::detector_reader_config reader_cfg{};
+    reader_cfg.add_file(detector_opts.detector_file);
+    if (!detector_opts.material_file.empty())
+    {
+        reader_cfg.add_file(detector_opts.material_file);
+    }
+    if (!detector_opts.grid_file.empty())
+    {
+        reader_cfg.add_file(detector_opts.grid_file);
+    }
+    const auto [host_det, names] =
+        detray::io::read_detector<host_detector_type>(host_mr, reader_cfg);
+
+    // Read every event once and append it to the store, and digitize it
+    // into the raw hit stream, e.g. to replay simulated events through the
+    // raw data reconstruction. The store is written on a writer thread
+    // while the next events are read.
+    std::unique_ptr<bella::event_store_writer> writer;
+    std::unique_ptr<bella::async_writer<bella::truth_event>> store_queue;
+    if (!store_opts.file.empty())
+    {
+        writer = std::make_unique<bella::event_store_writer>(store_opts.file);
+        store_queue = std::make_unique<bella::async_writer<bella::truth_event>>(
+            store_opts.queue_size,
+            [&writer](bella::truth_event &&evt) { writer->add(evt.view()); });
+    }
+
+    std::unique_ptr<bella::raw_frame_writer> raw_writer;
+    std::unique_ptr<bella::hit_decoder> digitizer;
+    if (!raw_opts.output.empty())
+    {
+        const bella::geometry_config geometry =
+            bella::make_geometry_config(geometry_opts);
+        raw_writer = std::make_unique<bella::raw_frame_writer>(raw_opts.output);
+        digitizer = std::make_unique<bella::hit_decoder>(
+            bella::sensitive_planes(host_det),
+            bella::pixel_layout{raw_opts.pixel_pitch,
+                                geometry.plane_half_length});
+    }
+
+    for (auto event = input_opts.skip;
+         event < input_opts.events + input_opts.skip; ++event)
+    {
+        traccc::event_data evt_data(input_opts.directory, event, host_mr,
+                                    input_opts.use_acts_geom_source, &host_det,
+                                    input_opts.format, false);
+
+        bella::truth_event evt = bella::make_truth_event(event, evt_data);
+        if (raw_writer)
+        {
+            raw_writer->add(digitizer->digitize(evt.view()));
+        }
+        if (store_queue && !store_queue->push(std::move(evt)))
+        {
+            // The writer thread failed
+            break;
+        }
+    }
+
+    if (writer)
+    {
+        store_queue->close();
+        writer->close();
+        std::cout << "Packed " << input_opts.events << " events into "
+                  << store_opts.file << std::endl;
+    }
+    if (raw_writer)
+    {
+        std::cout << "Digitized " << input_opts.events << " events into "
+                  << raw_opts.output << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,165 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Project include(s).
+#include "traccc/simulation/simulator.hpp"
+
+// detray include(s).
+#include "detray/definitions/pdg_particle.hpp"
+#include "detray/propagator/actor_chain.hpp"
+#include "detray/propagator/propagator.hpp"
+
+// Local include(s).
+#include "src/event_loop.hpp"
+#include "src/gap_stepper.hpp"
+#include "src/philox.hpp"
+#include "src/track_generator.hpp"
+
+// System include(s).
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace bella
+{
+
+    /// Simulation of the events of one generator configuration on several
+    /// threads
+    ///
+    /// Runs the same navigation and actors as @c traccc::simulator, but
+    /// distributes the events over the threads, and steps with the stepper
+    /// of the fitters, so the analytic magnet field is crossed on straight
+    /// lines in its field-free gaps. Every particle is generated,
+    /// scattered and smeared with engines seeded from its own counter-based
+    /// stream of (seed, event, particle), so an event is the same whichever
+    /// thread simulates it, however many threads there are, and whichever
+    /// other events the job simulates. The writer state of an event
+    /// lives on the thread simulating it and writes the event out, so the
+    /// writer has to accept events in any order, as the csv
+    /// @c traccc::smearing_writer and the queue of @c bella::memory_writer do.
+    template <typename detector_t, typename field_t, typename writer_t>
+    class parallel_simulator
+    {
+
+    public:
+        /// The traccc simulator this one mirrors
+        using simulator_type =
+            traccc::simulator<detector_t, field_t, generator_type, writer_t>;
+        using config = typename simulator_type::config;
+        using propagator_type =
+            detray::propagator<stepper_type<field_t>,
+                               typename simulator_type::navigator_type,
+                               typename simulator_type::actor_chain_type>;
+
+        /// Constructor, with the arguments of @c traccc::simulator
+        ///
+        /// @param ptc_type   Simulated particle type
+        /// @param n_events   Number of events
+        /// @param det        Detector the particles are propagated through
+        /// @param field      Magnetic field
+        /// @param gen_cfg    Configuration of the track generator of an event
+        /// @param writer_cfg Writer configuration, copied for every event
+        /// @param directory  Output directory passed to the writer
+        /// @param seed       Key of the random streams
+        parallel_simulator(const detray::pdg_particle<traccc::scalar> &ptc_type,
+                           const std::size_t n_events, const detector_t &det,
+                           const field_t &field,
+                           const generator_type::configuration &gen_cfg,
+                           typename writer_t::config writer_cfg,
+                           std::string directory, const std::uint64_t seed = 0u)
+            : m_seed(seed),
+              m_ptc_type(ptc_type),
+              m_events(n_events),
+              m_detector(det),
+              m_field(field),
+              m_gen_cfg(gen_cfg),
+              m_writer_cfg(std::move(writer_cfg)),
+              m_directory(std::move(directory))
+        {
+        }
+
+        config &get_config() { return m_cfg; }
+
+        /// Simulate every event on @c n_threads threads
+        void run(const std::size_t n_threads) const { run(n_threads, 0u, m_events); }
+
+        /// Simulate the events [@c begin, @c end) on @c n_threads threads,
+        /// e.g. the block of one shard
+        void run(const std::size_t n_threads, const std::size_t begin,
+                 const std::size_t end) const
+        {
+            parallel_for(n_threads, begin, end,
+                         [this](const std::size_t event)
+                         { simulate_event(event); });
+        }
+
+        /// Simulate the single event @c event on the calling thread
+        void simulate_event(const std::size_t event) const
+        {
+            using algebra_type = typename simulator_type::algebra_type;
+
+            typename writer_t::config writer_cfg = m_writer_cfg;
+            typename writer_t::state writer_state(event, std::move(writer_cfg),
+                                                  m_directory);
+
+            typename detray::parameter_transporter<algebra_type>::state
+                transporter{};
+            typename detray::random_scatterer<algebra_type>::state scatterer{};
+            typename detray::parameter_resetter<algebra_type>::state resetter{};
+
+            auto actor_states = detray::tie(transporter, scatterer, resetter,
+                                            writer_state);
+
+            // One track per generator, so every particle has its own stream
+            generator_type::configuration gen_cfg = m_gen_cfg;
+            gen_cfg.n_tracks(1u);
+
+            const propagator_type propagator(m_cfg.propagation);
+            for (std::uint32_t particle = 0u; particle < m_gen_cfg.n_tracks();
+                 ++particle)
+            {
+                gen_cfg.seed(stream_seed(m_seed, event, particle,
+                                         random_stream::e_generator));
+                scatterer.set_seed(stream_seed(m_seed, event, particle,
+                                               random_stream::e_scattering));
+                writer_state.set_seed(stream_seed(m_seed, event, particle,
+                                                  random_stream::e_smearing));
+
+                generator_type generator(gen_cfg);
+                const auto track = *generator.begin();
+                writer_state.write_particle(track);
+
+                typename propagator_type::state propagation(track, m_field,
+                                                            m_detector);
+                propagation._stepping
+                    .template set_constraint<detray::step::constraint::e_accuracy>(
+                        m_cfg.propagation.stepping.step_constraint);
+                propagation._stepping.set_particle(m_ptc_type);
+
+                propagator.propagate(propagation, actor_states);
+
+                ++writer_state.m_particle_id;
+            }
+        }
+
+    private:
+        std::uint64_t m_seed;
+        detray::pdg_particle<traccc::scalar> m_ptc_type;
+        std::size_t m_events;
+        const detector_t &m_detector;
+        const field_t &m_field;
+        generator_type::configuration m_gen_cfg;
+        typename writer_t::config m_writer_cfg;
+        std::string m_directory;
+        config m_cfg{};
+
+    }; // class parallel_simulator
+
+} // namespace bella
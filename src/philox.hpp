@@ -0,0 +1,127 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// System include(s).
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace bella
+{
+
+    /// Philox4x32-10 block function (Salmon et al., SC'11)
+    ///
+    /// A keyed bijection of the 128 bit counter, so different counters,
+    /// or keys, give statistically independent blocks of random bits.
+    ///
+    /// @param ctr Counter
+    /// @param key Key
+    constexpr std::array<std::uint32_t, 4> philox4x32(
+        std::array<std::uint32_t, 4> ctr, std::array<std::uint32_t, 2> key)
+    {
+        constexpr std::uint64_t m0 = 0xD2511F53u;
+        constexpr std::uint64_t m1 = 0xCD9E8D57u;
+        constexpr std::uint32_t w0 = 0x9E3779B9u;
+        constexpr std::uint32_t w1 = 0xBB67AE85u;
+
+        for (int round = 0; round < 10; ++round)
+        {
+            const std::uint64_t p0 = m0 * ctr[0];
+            const std::uint64_t p1 = m1 * ctr[2];
+            ctr = {static_cast<std::uint32_t>(p1 >> 32) ^ ctr[1] ^ key[0],
+                   static_cast<std::uint32_t>(p1),
+                   static_cast<std::uint32_t>(p0 >> 32) ^ ctr[3] ^ key[1],
+                   static_cast<std::uint32_t>(p0)};
+            key[0] += w0;
+            key[1] += w1;
+        }
+        return ctr;
+    }
+
+    /// Random streams of the simulation, one per use within a particle
+    enum class random_stream : std::uint32_t
+    {
+        e_generator = 0u,
+        e_scattering = 1u,
+        e_smearing = 2u,
+    };
+
+    /// Counter-based random stream of one particle of one event
+    ///
+    /// The key is the user seed and the counter holds the event, the
+    /// particle, the stream and the block index, so every (seed, event,
+    /// particle, stream) has its own stream of 2^24 blocks, reproducible
+    /// without running any other particle or event first. Satisfies
+    /// UniformRandomBitGenerator.
+    class philox_stream
+    {
+
+    public:
+        using result_type = std::uint32_t;
+
+        /// Constructor
+        ///
+        /// @param seed     User seed
+        /// @param event    Event index
+        /// @param particle Particle index within the event
+        /// @param stream   Use of the random numbers
+        philox_stream(const std::uint64_t seed, const std::uint64_t event,
+                      const std::uint32_t particle, const random_stream stream)
+            : m_key{static_cast<std::uint32_t>(seed),
+                    static_cast<std::uint32_t>(seed >> 32)},
+              m_ctr{static_cast<std::uint32_t>(event),
+                    static_cast<std::uint32_t>(event >> 32), particle,
+                    static_cast<std::uint32_t>(stream) << 24}
+        {
+        }
+
+        static constexpr result_type min() { return 0u; }
+        static constexpr result_type max()
+        {
+            return std::numeric_limits<result_type>::max();
+        }
+
+        /// Next 32 random bits
+        result_type operator()()
+        {
+            if (m_index == m_block.size())
+            {
+                m_block = philox4x32(m_ctr, m_key);
+                ++m_ctr[3];
+                m_index = 0u;
+            }
+            return m_block[m_index++];
+        }
+
+        /// Next 64 random bits, e.g. to seed a conventional engine
+        std::uint64_t next64()
+        {
+            const std::uint64_t hi = (*this)();
+            return (hi << 32) | (*this)();
+        }
+
+    private:
+        std::array<std::uint32_t, 2> m_key;
+        std::array<std::uint32_t, 4> m_ctr;
+        std::array<std::uint32_t, 4> m_block{};
+        std::size_t m_index = 4u;
+
+    }; // class philox_stream
+
+    /// Seed of the engine of one (seed, event, particle, stream)
+    inline std::uint64_t stream_seed(const std::uint64_t seed,
+                                     const std::uint64_t event,
+                                     const std::uint32_t particle,
+                                     const random_stream stream)
+    {
+        return philox_stream(seed, event, particle, stream).next64();
+    }
+
+} // namespace bella
@@ -0,0 +1,42 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Local include(s).
+#include "traccc/options/details/interface.hpp"
+
+// System include(s).
+#include <cstddef>
+
+namespace traccc::opts
+{
+
+    /// Convenience namespace shorthand
+    namespace po = boost::program_options;
+
+    /// Command line options of the in-process simulation and fitting
+    class pipeline_options : public interface
+    {
+
+    public:
+        /// Constructor
+        pipeline_options() : interface("BELLA Pipeline Options")
+        {
+
+            m_desc.add_options()("event-queue-size",
+                                 po::value(&(queue_size))
+                                     ->default_value(16u),
+                                 "Maximum number of simulated events waiting "
+                                 "to be fitted");
+        }
+
+        std::size_t queue_size;
+
+    }; // class pipeline_options
+
+} // namespace traccc::opts
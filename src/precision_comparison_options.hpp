@@ -0,0 +1,56 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Project include(s).
+#include "traccc/options/details/interface.hpp"
+
+// System include(s).
+#include <string>
+
+namespace traccc::opts
+{
+
+    /// Convenience namespace shorthand
+    namespace po = boost::program_options;
+
+    /// Command line options for the comparison of two fits of the same events
+    class precision_comparison_options : public interface
+    {
+
+    public:
+        /// Constructor
+        precision_comparison_options()
+            : interface("BELLA Precision Comparison Options")
+        {
+
+            m_desc.add_options()("reference-residuals",
+                                 po::value(&(reference))
+                                     ->default_value("double/residual.bin"),
+                                 "Binary residual file of the reference "
+                                 "(double) build");
+            m_desc.add_options()("test-residuals",
+                                 po::value(&(test))
+                                     ->default_value("float/residual.bin"),
+                                 "Binary residual file of the tested "
+                                 "(float) build");
+            m_desc.add_options()("tolerance",
+                                 po::value(&(tolerance))
+                                     ->default_value(0.01),
+                                 "Largest accepted RMS of the fit differences, "
+                                 "relative to the RMS of the reference "
+                                 "residuals");
+        }
+
+        std::string reference;
+        std::string test;
+        double tolerance;
+
+    }; // class precision_comparison_options
+
+} // namespace traccc::opts
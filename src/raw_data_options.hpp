@@ -0,0 +1,84 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Local include(s).
+#include "traccc/options/details/interface.hpp"
+
+// System include(s).
+#include <cstddef>
+#include <string>
+
+namespace traccc::opts
+{
+
+    /// Convenience namespace shorthand
+    namespace po = boost::program_options;
+
+    /// Command line options of the raw BELLA telescope data
+    class raw_data_options : public interface
+    {
+
+    public:
+        /// Constructor
+        raw_data_options() : interface("BELLA Raw Data Options")
+        {
+
+            m_desc.add_options()("raw-input",
+                                 po::value(&(input))
+                                     ->default_value(""),
+                                 "Raw hit stream to reconstruct, - for the "
+                                 "standard input");
+            m_desc.add_options()("raw-output",
+                                 po::value(&(output))
+                                     ->default_value(""),
+                                 "Raw hit stream the packed events are "
+                                 "digitized into");
+            m_desc.add_options()("pixel-pitch",
+                                 po::value(&(pixel_pitch))
+                                     ->default_value(0.05f),
+                                 "Pixel pitch of the sensitive planes [mm]");
+            m_desc.add_options()("frames-per-batch",
+                                 po::value(&(frames_per_batch))
+                                     ->default_value(16u),
+                                 "Number of frames decoded and fitted "
+                                 "together (1 for the lowest latency)");
+            m_desc.add_options()("frame-queue-size",
+                                 po::value(&(queue_size))
+                                     ->default_value(4u),
+                                 "Maximum number of decoded batches waiting "
+                                 "to be fitted");
+            m_desc.add_options()("monitor-interval",
+                                 po::value(&(monitor_interval))
+                                     ->default_value(1000u),
+                                 "Number of frames per line of the online "
+                                 "momentum report (0: final report only)");
+            m_desc.add_options()("seed-min-planes",
+                                 po::value(&(seed_min_planes))
+                                     ->default_value(3u),
+                                 "Minimum number of planes with a hit for a "
+                                 "frame to be seeded");
+            m_desc.add_options()("seed-fallback-momentum",
+                                 po::value(&(seed_fallback_momentum))
+                                     ->default_value(0.1f),
+                                 "Seed momentum of the tracks crossing too "
+                                 "little field to measure it [GeV]");
+        }
+
+        std::string input;
+        std::string output;
+        float pixel_pitch;
+        std::size_t frames_per_batch;
+        std::size_t queue_size;
+        std::size_t monitor_interval;
+        std::size_t seed_min_planes;
+        float seed_fallback_momentum;
+
+    }; // class raw_data_options
+
+} // namespace traccc::opts
@@ -0,0 +1,334 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+// Project include(s).
+#include "traccc/definitions/common.hpp"
+#include "traccc/definitions/primitives.hpp"
+#include "traccc/edm/track_candidate.hpp"
+#include "traccc/fitting/fitting_algorithm.hpp"
+#include "traccc/fitting/kalman_filter/kalman_fitter.hpp"
+#include "traccc/options/detector.hpp"
+#include "traccc/options/program_options.hpp"
+#include "traccc/options/threading.hpp"
+#include "traccc/options/track_propagation.hpp"
+
+// Detray include(s).
+#include "detray/navigation/navigator.hpp"
+
+// Local include(s).
+#include "src/batched_kalman_fitter.hpp"
+#include "src/chunked_fitting.hpp"
+#include "src/detector_io.hpp"
+#include "src/event_loop.hpp"
+#include "src/field_model.hpp"
+#include "src/field_options.hpp"
+#include "src/fit_output.hpp"
+#include "src/fit_output_options.hpp"
+#include "src/fitting_options.hpp"
+#include "src/frame_seeding.hpp"
+#include "src/gap_stepper.hpp"
+#include "src/geometry_config.hpp"
+#include "src/geometry_source_options.hpp"
+#include "src/online_monitor.hpp"
+#include "src/raw_data_options.hpp"
+#include "src/raw_frame.hpp"
+#include "src/stage_timing.hpp"
+#include "src/telescope_metadata.hpp"
+#include "src/telescope_planes.hpp"
+#include "src/timing_options.hpp"
+#include "src/track_finder.hpp"
+#include "src/track_finding_options.hpp"
+#include "src/track_records.hpp"
+#include "src/truth_fitting.hpp"
+
+// VecMem include(s).
+#include <vecmem/memory/binary_page_memory_resource.hpp>
+#include <vecmem/memory/host_memory_resource.hpp>
+#include <vecmem/memory/synchronized_memory_resource.hpp>
+
+// System include(s).
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using namespace traccc;
+
+namespace
+{
+    /// Frames decoded together, with the time their reading started
+    struct frame_batch
+    {
+        std::vector<bella::hit_frame> frames;
+        bella::online_monitor::clock::time_point read_time;
+    };
+
+    /// Fit output of one frame
+    struct frame_result
+    {
+        bella::event_records records;
+        std::size_t n_tracks = 0u;
+        std::size_t n_invalid = 0u;
+    };
+
+    /// Fit output of one batch
+    struct batch_result
+    {
+        std::vector<frame_result> frames;
+        bella::online_monitor::clock::time_point read_time;
+    };
+} // namespace
+
+// The main routine
+//
+int main(int argc, char *argv[])
+{
+    // Program options.
+    traccc::opts::detector detector_opts;
+    traccc::opts::track_propagation propagation_opts;
+    traccc::opts::field_options field_opts;
+    traccc::opts::threading threading_opts;
+    traccc::opts::fitting_options fitting_opts;
+    traccc::opts::fit_output_options output_opts;
+    traccc::opts::raw_data_options raw_opts;
+    traccc::opts::track_finding_options finding_opts;
+    traccc::opts::geometry_source_options source_opts;
+    traccc::opts::bella_geometry_options geometry_opts;
+    traccc::opts::timing_options timing_opts;
+    traccc::opts::program_options program_opts{
+        "Track Fitting of Raw Telescope Data on the Host",
+        {detector_opts, propagation_opts, field_opts, threading_opts,
+         fitting_opts, output_opts, raw_opts, finding_opts, source_opts,
+         geometry_opts, timing_opts},
+        argc,
+        argv};
+
+    if (raw_opts.input.empty())
+    {
+        throw std::invalid_argument("No --raw-input stream given");
+    }
+
+    // Memory resources used by the application.
+    vecmem::host_memory_resource host_mr;
+
+    // Time spent per stage, reported at exit with --timing
+    bella::stage_timing timing(timing_opts.active());
+    auto stage_start = bella::stage_timing::clock::now();
+
+    /*****************************
+     * Build a geometry
+     *****************************/
+
+    const bella::geometry_config geometry =
+        bella::make_geometry_config(geometry_opts);
+    const auto [host_det, names] =
+        bella::load_telescope(detector_opts, source_opts, geometry, host_mr);
+    timing.add_since("detector", stage_start);
+
+    // Pixel hits to measurements, with the plane numbers of the raw data
+    const bella::hit_decoder decoder(
+        bella::sensitive_planes(host_det),
+        bella::pixel_layout{raw_opts.pixel_pitch, geometry.plane_half_length});
+
+    bella::frame_seeding_config seeding_cfg;
+    seeding_cfg.min_planes = raw_opts.seed_min_planes;
+    seeding_cfg.fallback_momentum = raw_opts.seed_fallback_momentum;
+    const bella::frame_seeding seeding(decoder.planes(), seeding_cfg);
+
+    // Frames of several tracks go to the track finder
+    const std::string &mode = finding_opts.candidates;
+    if (mode != "auto" && mode != "single" && mode != "finder")
+    {
+        throw std::invalid_argument("Unknown track candidates for raw data: " +
+                                    mode);
+    }
+    std::optional<bella::track_finder> finder;
+    if (mode != "single")
+    {
+        bella::track_finder_config finder_cfg =
+            bella::make_track_finder_config(finding_opts);
+        finder_cfg.fallback_momentum = raw_opts.seed_fallback_momentum;
+        finder.emplace(host_det, finder_cfg);
+    }
+
+    // Output files and the momentum report of the shift
+    const auto output_writer =
+        bella::make_record_writer(output_opts.format, "", output_opts.queue_size);
+    bella::online_monitor monitor(std::cout, raw_opts.monitor_interval,
+                                  seeding_cfg.ptc_type.charge());
+    std::size_t n_invalid = 0u;
+
+    // Pooled memory of the batch containers
+    vecmem::binary_page_memory_resource pool_mr(host_mr);
+    vecmem::synchronized_memory_resource event_mr(pool_mr);
+
+    // Read and decode the next batch of frames. Runs on the reader thread
+    // of the loop only, so the stream needs no locking.
+    bella::raw_frame_reader reader(raw_opts.input);
+    auto read_batch = [&]() -> std::optional<frame_batch>
+    {
+        frame_batch batch;
+        batch.frames.reserve(raw_opts.frames_per_batch);
+
+        bella::raw_frame frame;
+        while (batch.frames.size() < std::max<std::size_t>(raw_opts.frames_per_batch, 1u) &&
+               reader.read(frame))
+        {
+            if (batch.frames.empty())
+            {
+                batch.read_time = bella::online_monitor::clock::now();
+            }
+            bella::scoped_timer timer(timing, "decoding");
+            batch.frames.push_back(decoder.decode(frame));
+        }
+
+        if (batch.frames.empty())
+        {
+            return std::nullopt;
+        }
+        return batch;
+    };
+
+    /*****************************
+     * Do the reconstruction
+     *****************************/
+
+    std::optional<bella::batched_kalman_fitter> batched_fitter;
+    if (fitting_opts.mode == "batched")
+    {
+        batched_fitter.emplace(host_det, bella::make_batched_fitter_config(fitting_opts));
+    }
+    else if (fitting_opts.mode != "scalar")
+    {
+        throw std::invalid_argument("Unknown fit mode: " + fitting_opts.mode);
+    }
+
+    stage_start = bella::stage_timing::clock::now();
+    bella::with_field(field_opts, geometry.magnets, [&](const auto &field)
+    {
+        timing.add_since("field", stage_start);
+
+        using b_field_t = std::remove_cvref_t<decltype(field)>;
+        using rk_stepper_type = bella::stepper_type<b_field_t>;
+
+        using host_navigator_type =
+            detray::navigator<const bella::host_detector_type>;
+        using host_fitter_type =
+            traccc::kalman_fitter<rk_stepper_type, host_navigator_type>;
+
+        typename traccc::fitting_algorithm<host_fitter_type>::config_type fit_cfg;
+        fit_cfg.propagation = propagation_opts;
+
+        traccc::fitting_algorithm<host_fitter_type> host_fitting(fit_cfg);
+
+        const typename b_field_t::view_t field_view(field);
+
+        // Seed and fit all frames of one batch together
+        auto fit_batch = [&](const std::size_t, frame_batch &batch)
+        {
+            batch_result result;
+            result.read_time = batch.read_time;
+            result.frames.resize(batch.frames.size());
+
+            traccc::track_candidate_container_types::host candidates{&event_mr};
+            {
+                bella::scoped_timer timer(timing, "seeding");
+                for (std::size_t i = 0; i < batch.frames.size(); ++i)
+                {
+                    const bella::hit_frame &frame = batch.frames[i];
+                    std::size_t n_tracks = 0u;
+                    if (mode != "finder" &&
+                        seeding(field_view, frame, candidates, event_mr))
+                    {
+                        n_tracks = 1u;
+                    }
+                    else if (finder)
+                    {
+                        n_tracks = (*finder)(field_view, frame, candidates, event_mr);
+                    }
+                    result.frames[i].n_tracks = n_tracks;
+                    result.frames[i].n_invalid = frame.n_invalid;
+                }
+            }
+            if (candidates.size() == 0u)
+            {
+                return result;
+            }
+
+            bella::scoped_timer timer(timing, "fitting");
+            auto track_states =
+                batched_fitter
+                    ? (*batched_fitter)(field, candidates, host_fitting, event_mr)
+                    : bella::chunked_fit(host_fitting, host_det, field, candidates,
+                                         fitting_opts.chunk_size,
+                                         fitting_opts.threads, event_mr);
+
+            // There is no truth: its columns are NaN
+            const scalar nan = std::numeric_limits<scalar>::quiet_NaN();
+            const bella::track_truth no_truth{{nan, nan, nan}, nan};
+
+            std::size_t first = 0u;
+            for (std::size_t i = 0; i < batch.frames.size(); ++i)
+            {
+                const std::size_t n = result.frames[i].n_tracks;
+                if (n != 0u)
+                {
+                    result.frames[i].records = bella::collect_records(
+                        batch.frames[i].frame_id, host_det,
+                        std::vector<bella::track_truth>(n, no_truth), track_states,
+                        first, n);
+                    first += n;
+                }
+            }
+            return result;
+        };
+
+        // Write and monitor the frames of one batch. Called in stream order.
+        auto write_batch = [&](const batch_result &result)
+        {
+            bella::scoped_timer timer(timing, "output");
+            for (const frame_result &frame : result.frames)
+            {
+                output_writer->write(frame.records);
+                monitor.add(frame.records, frame.n_tracks != 0u, result.read_time);
+                n_invalid += frame.n_invalid;
+                timing.count(1u, frame.records.residuals.size());
+            }
+        };
+
+        // Batches are decoded on the reader thread while the previous ones
+        // are fitted on --cpu-threads workers
+        bella::streamed_event_loop(threading_opts.threads, 0u,
+                                   raw_opts.queue_size, read_batch, fit_batch,
+                                   write_batch);
+    });
+
+    output_writer->close();
+
+    monitor.report();
+    if (n_invalid != 0u)
+    {
+        std::cout << "Dropped " << n_invalid
+                  << " hits outside of the planes or pixel matrices" << std::endl;
+    }
+
+    timing.report(std::cout);
+    if (!timing_opts.output.empty())
+    {
+        timing.dump(timing_opts.output);
+    }
+
+    return EXIT_SUCCESS;
+}
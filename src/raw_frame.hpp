@@ -0,0 +1,376 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Project include(s).
+#include "traccc/definitions/common.hpp"
+#include "traccc/definitions/primitives.hpp"
+#include "traccc/edm/measurement.hpp"
+
+// Local include(s).
+#include "src/event_store.hpp"
+#include "src/telescope_planes.hpp"
+
+// System include(s).
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bella
+{
+
+    /// Raw hit stream of the BELLA telescope
+    ///
+    /// The stream starts with a @c file_header, followed by the frames, each
+    /// a @c frame_header and its @c n_hits raw hits. It is read front to
+    /// back, so it may be a pipe or fifo fed by the data acquisition.
+    namespace raw_frame_format
+    {
+
+        /// Format version
+        static constexpr std::uint32_t version = 1u;
+
+        /// Header of the stream
+        struct file_header
+        {
+            std::array<char, 8> magic;
+            std::uint32_t version;
+            std::uint32_t reserved;
+        };
+
+        /// Header of one readout frame
+        struct frame_header
+        {
+            std::uint64_t frame_id;
+            /// Trigger time stamp of the data acquisition
+            std::uint64_t timestamp;
+            std::uint32_t n_hits;
+            std::uint32_t reserved;
+        };
+
+        /// One fired pixel
+        struct raw_hit
+        {
+            /// Sensitive plane, counted in ascending x
+            std::uint16_t plane;
+            /// Pixel along the first local axis
+            std::uint16_t column;
+            /// Pixel along the second local axis
+            std::uint16_t row;
+            /// Charge or time over threshold, as read out
+            std::uint16_t value;
+        };
+
+        static constexpr std::array<char, 8> magic = {'B', 'E', 'L', 'L',
+                                                      'A', 'R', 'A', 'W'};
+
+    } // namespace raw_frame_format
+
+    using raw_hit = raw_frame_format::raw_hit;
+
+    /// One readout frame
+    struct raw_frame
+    {
+        std::uint64_t frame_id = 0u;
+        std::uint64_t timestamp = 0u;
+        std::vector<raw_hit> hits;
+    };
+
+    /// Sequential reader of a raw hit stream
+    class raw_frame_reader
+    {
+
+    public:
+        /// Constructor
+        ///
+        /// @param path Path of the stream, "-" for the standard input
+        explicit raw_frame_reader(const std::string &path)
+        {
+            if (path == "-")
+            {
+                m_in = &std::cin;
+            }
+            else
+            {
+                m_file.open(path, std::ios::binary);
+                if (!m_file)
+                {
+                    throw std::runtime_error("Could not open " + path);
+                }
+                m_in = &m_file;
+            }
+
+            raw_frame_format::file_header header{};
+            if (!m_in->read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+                header.magic != raw_frame_format::magic ||
+                header.version != raw_frame_format::version)
+            {
+                throw std::runtime_error(path + " is not a BELLA raw hit stream");
+            }
+        }
+
+        raw_frame_reader(const raw_frame_reader &) = delete;
+        raw_frame_reader &operator=(const raw_frame_reader &) = delete;
+
+        /// Read the next frame into @c frame, waiting for it to arrive
+        ///
+        /// @return false at the end of the stream
+        bool read(raw_frame &frame)
+        {
+            raw_frame_format::frame_header header{};
+            if (!m_in->read(reinterpret_cast<char *>(&header), sizeof(header)))
+            {
+                if (m_in->gcount() != 0)
+                {
+                    throw std::runtime_error("Truncated raw frame header");
+                }
+                return false;
+            }
+
+            frame.frame_id = header.frame_id;
+            frame.timestamp = header.timestamp;
+            frame.hits.resize(header.n_hits);
+            if (!m_in->read(reinterpret_cast<char *>(frame.hits.data()),
+                            static_cast<std::streamsize>(header.n_hits *
+                                                         sizeof(raw_hit))))
+            {
+                throw std::runtime_error("Truncated raw frame " +
+                                         std::to_string(header.frame_id));
+            }
+            return true;
+        }
+
+    private:
+        std::ifstream m_file;
+        std::istream *m_in = nullptr;
+
+    }; // class raw_frame_reader
+
+    /// Writer of a raw hit stream
+    class raw_frame_writer
+    {
+
+    public:
+        /// Constructor
+        ///
+        /// @param path Path of the stream
+        explicit raw_frame_writer(const std::string &path)
+            : m_file(path, std::ios::binary)
+        {
+            if (!m_file)
+            {
+                throw std::runtime_error("Could not open " + path);
+            }
+
+            const raw_frame_format::file_header header{
+                raw_frame_format::magic, raw_frame_format::version, 0u};
+            m_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        }
+
+        /// Append one frame
+        void add(const raw_frame &frame)
+        {
+            const raw_frame_format::frame_header header{
+                frame.frame_id, frame.timestamp,
+                static_cast<std::uint32_t>(frame.hits.size()), 0u};
+            m_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            m_file.write(reinterpret_cast<const char *>(frame.hits.data()),
+                         static_cast<std::streamsize>(frame.hits.size() *
+                                                      sizeof(raw_hit)));
+        }
+
+    private:
+        std::ofstream m_file;
+
+    }; // class raw_frame_writer
+
+    /// Square pixels covering a square sensitive plane
+    struct pixel_layout
+    {
+        /// Pixel pitch [mm]
+        traccc::scalar pitch = 0.05f;
+        /// Half length of the plane [mm]
+        traccc::scalar half_length = 100.f;
+
+        /// Number of pixels along one local axis
+        std::size_t n_pixels() const
+        {
+            return static_cast<std::size_t>(std::ceil(2.f * half_length / pitch));
+        }
+    };
+
+    /// Measurements of one frame, grouped by plane
+    struct hit_frame
+    {
+        std::uint64_t frame_id = 0u;
+        std::uint64_t timestamp = 0u;
+        std::vector<traccc::measurement> measurements;
+        /// Offset of the measurements of every plane (n_planes + 1 entries)
+        std::vector<std::size_t> plane_offsets;
+        /// Hits outside of the planes or pixel matrices, dropped
+        std::size_t n_invalid = 0u;
+
+        /// Number of planes
+        std::size_t n_planes() const { return plane_offsets.size() - 1u; }
+
+        /// Measurements of the plane @c i
+        std::span<const traccc::measurement> plane_measurements(
+            const std::size_t i) const
+        {
+            return std::span<const traccc::measurement>(measurements)
+                .subspan(plane_offsets[i], plane_offsets[i + 1] - plane_offsets[i]);
+        }
+    };
+
+    /// Conversion between raw pixel hits and measurements on the planes
+    class hit_decoder
+    {
+
+    public:
+        /// Constructor
+        ///
+        /// @param planes Sensitive planes, the plane numbers of the raw hits
+        /// @param layout Pixel matrix of every plane
+        hit_decoder(std::vector<sensitive_plane> planes, const pixel_layout &layout)
+            : m_planes(std::move(planes)),
+              m_pitch(layout.pitch * traccc::unit<traccc::scalar>::mm),
+              m_half_length(layout.half_length * traccc::unit<traccc::scalar>::mm),
+              m_n_pixels(layout.n_pixels())
+        {
+            if (!(layout.pitch > 0.f))
+            {
+                throw std::invalid_argument("Non-positive pixel pitch");
+            }
+            if (m_n_pixels > 0x10000u)
+            {
+                throw std::invalid_argument(
+                    "The pixel matrix does not fit the raw hit format");
+            }
+        }
+
+        /// Sensitive planes, in plane number order
+        const std::vector<sensitive_plane> &planes() const { return m_planes; }
+
+        /// Measurements of the hits of @c frame, one per fired pixel
+        ///
+        /// The measurement sits at the pixel centre with the variance of a
+        /// uniform distribution over the pixel.
+        hit_frame decode(const raw_frame &frame) const
+        {
+            hit_frame out;
+            out.frame_id = frame.frame_id;
+            out.timestamp = frame.timestamp;
+            out.plane_offsets.assign(m_planes.size() + 1u, 0u);
+
+            // Counting sort by plane
+            for (const raw_hit &hit : frame.hits)
+            {
+                if (valid(hit))
+                {
+                    ++out.plane_offsets[hit.plane + 1u];
+                }
+                else
+                {
+                    ++out.n_invalid;
+                }
+            }
+            for (std::size_t i = 0; i < m_planes.size(); ++i)
+            {
+                out.plane_offsets[i + 1u] += out.plane_offsets[i];
+            }
+
+            out.measurements.resize(out.plane_offsets.back());
+            std::vector<std::size_t> next(out.plane_offsets.begin(),
+                                          out.plane_offsets.end() - 1);
+            const traccc::scalar variance = m_pitch * m_pitch / 12.f;
+
+            for (const raw_hit &hit : frame.hits)
+            {
+                if (!valid(hit))
+                {
+                    continue;
+                }
+                const std::size_t index = next[hit.plane]++;
+
+                traccc::measurement &meas = out.measurements[index];
+                meas.local = {centre(hit.column), centre(hit.row)};
+                meas.variance = {variance, variance};
+                meas.surface_link = m_planes[hit.plane].barcode;
+                meas.meas_dim = 2u;
+                meas.measurement_id = index;
+            }
+
+            return out;
+        }
+
+        /// Raw frame of the measurements of a simulated event, e.g. to run
+        /// the raw data path on simulated events
+        raw_frame digitize(const event_view &evt) const
+        {
+            raw_frame frame;
+            frame.frame_id = evt.event_id;
+            frame.hits.reserve(evt.measurements.size());
+
+            for (const traccc::measurement &meas : evt.measurements)
+            {
+                std::size_t plane = 0u;
+                while (plane < m_planes.size() &&
+                       m_planes[plane].barcode != meas.surface_link)
+                {
+                    ++plane;
+                }
+                const long column = pixel(meas.local[0]);
+                const long row = pixel(meas.local[1]);
+                if (plane == m_planes.size() || column < 0 || row < 0)
+                {
+                    continue;
+                }
+                frame.hits.push_back({static_cast<std::uint16_t>(plane),
+                                      static_cast<std::uint16_t>(column),
+                                      static_cast<std::uint16_t>(row), 1u});
+            }
+
+            return frame;
+        }
+
+    private:
+        bool valid(const raw_hit &hit) const
+        {
+            return hit.plane < m_planes.size() && hit.column < m_n_pixels &&
+                   hit.row < m_n_pixels;
+        }
+
+        /// Local position of the centre of the pixel @c i
+        traccc::scalar centre(const std::uint16_t i) const
+        {
+            return (static_cast<traccc::scalar>(i) + 0.5f) * m_pitch - m_half_length;
+        }
+
+        /// Pixel of the local position @c l, -1 outside of the matrix
+        long pixel(const traccc::scalar l) const
+        {
+            const long i = static_cast<long>(std::floor((l + m_half_length) / m_pitch));
+            return i >= 0 && static_cast<std::size_t>(i) < m_n_pixels ? i : -1;
+        }
+
+        std::vector<sensitive_plane> m_planes;
+        traccc::scalar m_pitch;
+        traccc::scalar m_half_length;
+        std::size_t m_n_pixels;
+
+    }; // class hit_decoder
+
+} // namespace bella
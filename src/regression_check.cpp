@@ -0,0 +1,268 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+// Project include(s).
+#include "traccc/options/program_options.hpp"
+
+// Local include(s).
+#include "src/regression_options.hpp"
+#include "src/residual_summary.hpp"
+#include "src/summary_io.hpp"
+
+// System include(s).
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <ios>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+
+    /// Timing reports of the regression run, written with --timing-output
+    constexpr std::array<const char *, 2> timing_files{
+        "simulation_timing.json", "fitting_timing.json"};
+
+    /// Residual summary of the regression run
+    constexpr const char *summary_file = "residual_summary.json";
+
+    /// Exit code of a check without its baseline, which ctest counts as
+    /// skipped (SKIP_RETURN_CODE)
+    constexpr int missing_baseline = 77;
+
+    /// Compare the stage times of one timing report with the baseline
+    bool check_timing(const std::string &file,
+                      const traccc::opts::regression_options &opts)
+    {
+        const nlohmann::json baseline =
+            bella::read_json(opts.baseline_dir + "/" + file);
+        const nlohmann::json result = bella::read_json(opts.result_dir + "/" + file);
+        const std::streamsize precision = std::cout.precision();
+
+        std::cout << file << ": " << result.at("events").get<std::size_t>()
+                  << " events, " << result.at("tracks").get<std::size_t>()
+                  << " tracks, " << result.at("tracks_per_s").get<double>()
+                  << " tracks/s (baseline "
+                  << baseline.at("tracks_per_s").get<double>() << ")"
+                  << std::endl;
+
+        // The times are only comparable for the same configuration
+        if (result.at("events") != baseline.at("events") ||
+            result.at("tracks") != baseline.at("tracks"))
+        {
+            std::cout << "  the run processed other events or tracks than the "
+                         "baseline"
+                      << std::endl;
+            return false;
+        }
+
+        std::map<std::string, double> times;
+        for (const nlohmann::json &stage : result.at("stages"))
+        {
+            times[stage.at("name").get<std::string>()] =
+                stage.at("total_s").get<double>();
+        }
+
+        bool passed = true;
+        for (const nlohmann::json &stage : baseline.at("stages"))
+        {
+            const std::string name = stage.at("name").get<std::string>();
+            const double base = stage.at("total_s").get<double>();
+            if (base < opts.min_stage_time)
+            {
+                continue;
+            }
+
+            const auto it = times.find(name);
+            if (it == times.end())
+            {
+                std::cout << "  " << name << ": missing" << std::endl;
+                passed = false;
+                continue;
+            }
+
+            const double ratio = it->second / base;
+            const bool ok = ratio <= 1. + opts.time_tolerance;
+            passed = passed && ok;
+            std::cout << "  " << std::left << std::setw(16) << name << std::right
+                      << std::fixed << std::setprecision(3) << std::setw(10)
+                      << base << " s -> " << std::setw(10) << it->second
+                      << " s (x" << std::setprecision(2) << ratio << ")"
+                      << (ok ? "" : "  SLOWER") << std::defaultfloat
+                      << std::endl;
+        }
+        std::cout.precision(precision);
+        return passed;
+    }
+
+    /// Whether @c test is within @c tolerance of @c ref, relatively
+    bool within(const double test, const double ref, const double tolerance)
+    {
+        return std::abs(test - ref) <= tolerance * std::abs(ref);
+    }
+
+    /// Compare the residual distributions with the baseline
+    bool check_residuals(const traccc::opts::regression_options &opts)
+    {
+        const bella::residual_summary baseline = bella::read_residual_summary(
+            opts.baseline_dir + "/" + summary_file);
+        const bella::residual_summary result =
+            bella::read_residual_summary(opts.result_dir + "/" + summary_file);
+        const std::streamsize precision = std::cout.precision();
+
+        bool passed = within(static_cast<double>(result.tracks()),
+                             static_cast<double>(baseline.tracks()),
+                             opts.rms_tolerance);
+        std::cout << summary_file << ": " << result.tracks()
+                  << " tracks (baseline " << baseline.tracks() << ")"
+                  << std::endl;
+
+        std::cout << std::left << std::setw(8) << "" << std::right
+                  << std::setw(14) << "ref mean" << std::setw(14) << "test mean"
+                  << std::setw(14) << "ref rms" << std::setw(14) << "test rms"
+                  << std::setw(14) << "ref pull rms" << std::setw(14)
+                  << "test pull rms" << std::endl;
+        for (std::size_t i = 0; i < bella::residual_summary::names.size(); ++i)
+        {
+            const auto &ref = baseline.quantities()[i];
+            const auto &test = result.quantities()[i];
+
+            // E.g. qopz of tracks perpendicular to z has no valid residual
+            if (ref.relative.count() == 0u)
+            {
+                continue;
+            }
+
+            bool ok = test.relative.count() > 0u;
+            if (ok)
+            {
+                // Mean shifted by more than its statistical error, widths
+                // changed by more than the tolerance
+                const double error = std::sqrt(
+                    ref.relative.rms() * ref.relative.rms() /
+                        static_cast<double>(ref.relative.count()) +
+                    test.relative.rms() * test.relative.rms() /
+                        static_cast<double>(test.relative.count()));
+                ok = std::abs(test.relative.mean() - ref.relative.mean()) <=
+                         opts.mean_sigmas * error &&
+                     within(test.relative.rms(), ref.relative.rms(),
+                            opts.rms_tolerance) &&
+                     within(test.pull.rms(), ref.pull.rms(), opts.rms_tolerance);
+            }
+            passed = passed && ok;
+
+            std::cout << std::left << std::setw(8) << bella::residual_summary::names[i]
+                      << std::right << std::scientific << std::setprecision(4)
+                      << std::setw(14) << ref.relative.mean() << std::setw(14)
+                      << test.relative.mean() << std::setw(14)
+                      << ref.relative.rms() << std::setw(14) << test.relative.rms()
+                      << std::setw(14) << ref.pull.rms() << std::setw(14)
+                      << test.pull.rms() << (ok ? "" : "  CHANGED")
+                      << std::defaultfloat << std::endl;
+        }
+        std::cout.precision(precision);
+        return passed;
+    }
+
+} // namespace
+
+// The main routine
+//
+int main(int argc, char *argv[])
+{
+    // Program options.
+    traccc::opts::regression_options regression_opts;
+    traccc::opts::program_options program_opts{
+        "Compare a Regression Run with the Recorded Baseline",
+        {regression_opts},
+        argc,
+        argv};
+
+    namespace fs = std::filesystem;
+
+    // Keep the files of this run as the new baseline
+    if (regression_opts.record)
+    {
+        // The timing files only apply to this machine; the residual summary
+        // is the one to commit to the source tree
+        fs::create_directories(regression_opts.baseline_dir);
+        for (const char *file : timing_files)
+        {
+            fs::copy_file(fs::path(regression_opts.result_dir) / file,
+                          fs::path(regression_opts.baseline_dir) / file,
+                          fs::copy_options::overwrite_existing);
+        }
+        fs::copy_file(fs::path(regression_opts.result_dir) / summary_file,
+                      fs::path(regression_opts.baseline_dir) / summary_file,
+                      fs::copy_options::overwrite_existing);
+        std::cout << "Recorded the baseline in " << regression_opts.baseline_dir
+                  << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    const std::string &check = regression_opts.check;
+    if (check != "throughput" && check != "residuals" && check != "all")
+    {
+        throw std::invalid_argument("Unknown check: " + check);
+    }
+    // Checks whose baseline was not recorded are skipped, e.g. the
+    // throughput on a machine other than the reference one
+    auto has_baseline = [&](const char *file)
+    {
+        const bool found = fs::exists(fs::path(regression_opts.baseline_dir) / file);
+        if (!found)
+        {
+            std::cout << "No baseline " << file << " in "
+                      << regression_opts.baseline_dir
+                      << ", record one with --record (the "
+                         "bella_regression_baseline target)"
+                      << std::endl;
+        }
+        return found;
+    };
+
+    bool passed = true;
+    bool checked = false;
+    if (check != "residuals")
+    {
+        bool found = true;
+        for (const char *file : timing_files)
+        {
+            found = has_baseline(file) && found;
+        }
+        if (found)
+        {
+            for (const char *file : timing_files)
+            {
+                passed = check_timing(file, regression_opts) && passed;
+            }
+            checked = true;
+        }
+    }
+    if (check != "throughput" && has_baseline(summary_file))
+    {
+        passed = check_residuals(regression_opts) && passed;
+        checked = true;
+    }
+    if (!checked)
+    {
+        std::cout << "SKIPPED: " << check << ", no baseline" << std::endl;
+        return missing_baseline;
+    }
+
+    std::cout << (passed ? "PASSED" : "FAILED") << ": " << check
+              << " against the baseline in " << regression_opts.baseline_dir
+              << std::endl;
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
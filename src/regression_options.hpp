@@ -0,0 +1,84 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Project include(s).
+#include "traccc/options/details/interface.hpp"
+
+// System include(s).
+#include <string>
+
+namespace traccc::opts
+{
+
+    /// Convenience namespace shorthand
+    namespace po = boost::program_options;
+
+    /// Command line options of the performance regression check
+    class regression_options : public interface
+    {
+
+    public:
+        /// Constructor
+        regression_options() : interface("BELLA Regression Check Options")
+        {
+
+            m_desc.add_options()("check",
+                                 po::value(&(check))
+                                     ->default_value("all"),
+                                 "What is compared against the baseline: "
+                                 "throughput, residuals or all");
+            m_desc.add_options()("baseline-dir",
+                                 po::value(&(baseline_dir))
+                                     ->default_value("regression"),
+                                 "Directory of the recorded timing and "
+                                 "residual summary files");
+            m_desc.add_options()("result-dir",
+                                 po::value(&(result_dir))
+                                     ->default_value("."),
+                                 "Directory of the timing and residual "
+                                 "summary files of the checked run");
+            m_desc.add_options()("record",
+                                 po::bool_switch(&(record))
+                                     ->default_value(false),
+                                 "Record the checked run as the new baseline "
+                                 "instead of comparing it");
+            m_desc.add_options()("time-tolerance",
+                                 po::value(&(time_tolerance))
+                                     ->default_value(0.25),
+                                 "Maximum relative increase of the time of "
+                                 "a stage");
+            m_desc.add_options()("min-stage-time",
+                                 po::value(&(min_stage_time))
+                                     ->default_value(0.05),
+                                 "Baseline time below which a stage is too "
+                                 "noisy to be compared [s]");
+            m_desc.add_options()("mean-sigmas",
+                                 po::value(&(mean_sigmas))
+                                     ->default_value(5.),
+                                 "Maximum shift of a residual mean, in "
+                                 "standard errors");
+            m_desc.add_options()("rms-tolerance",
+                                 po::value(&(rms_tolerance))
+                                     ->default_value(0.2),
+                                 "Maximum relative change of a residual or "
+                                 "pull RMS, and of the number of tracks");
+        }
+
+        std::string check;
+        std::string baseline_dir;
+        std::string result_dir;
+        bool record;
+        double time_tolerance;
+        double min_stage_time;
+        double mean_sigmas;
+        double rms_tolerance;
+
+    }; // class regression_options
+
+} // namespace traccc::opts
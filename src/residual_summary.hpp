@@ -0,0 +1,421 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Local include(s).
+#include "src/track_records.hpp"
+
+// System include(s).
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bella
+{
+
+    /// Streaming count, mean, spread and range of a quantity
+    ///
+    /// Uses Welford's update, and Chan's formula to merge two instances, so
+    /// samples filled on several threads can be combined at the end.
+    class running_stats
+    {
+
+    public:
+        /// Add a value
+        void add(const double x)
+        {
+            ++m_count;
+            const double delta = x - m_mean;
+            m_mean += delta / static_cast<double>(m_count);
+            m_m2 += delta * (x - m_mean);
+            m_min = std::min(m_min, x);
+            m_max = std::max(m_max, x);
+        }
+
+        /// Add the values of @c other
+        void merge(const running_stats &other)
+        {
+            if (other.m_count == 0u)
+            {
+                return;
+            }
+            const double n_a = static_cast<double>(m_count);
+            const double n_b = static_cast<double>(other.m_count);
+            const double n = n_a + n_b;
+            const double delta = other.m_mean - m_mean;
+
+            m_mean += delta * n_b / n;
+            m_m2 += other.m_m2 + delta * delta * n_a * n_b / n;
+            m_count += other.m_count;
+            m_min = std::min(m_min, other.m_min);
+            m_max = std::max(m_max, other.m_max);
+        }
+
+        /// Statistics restored from their written summary, e.g. to merge
+        /// the summaries of several jobs
+        static running_stats from_summary(const std::size_t count,
+                                          const double mean, const double rms,
+                                          const double min, const double max)
+        {
+            running_stats s;
+            s.m_count = count;
+            s.m_mean = mean;
+            s.m_m2 = count > 1u ? rms * rms * static_cast<double>(count - 1u) : 0.;
+            s.m_min = count > 0u ? min : s.m_min;
+            s.m_max = count > 0u ? max : s.m_max;
+            return s;
+        }
+
+        std::size_t count() const { return m_count; }
+        double mean() const { return m_mean; }
+        double min() const { return m_min; }
+        double max() const { return m_max; }
+
+        /// Standard deviation of the values, which ROOT calls the RMS
+        double rms() const
+        {
+            return m_count > 1u
+                       ? std::sqrt(m_m2 / static_cast<double>(m_count - 1u))
+                       : 0.;
+        }
+
+    private:
+        std::size_t m_count = 0u;
+        double m_mean = 0.;
+        double m_m2 = 0.;
+        double m_min = std::numeric_limits<double>::infinity();
+        double m_max = -std::numeric_limits<double>::infinity();
+
+    }; // class running_stats
+
+    /// Histogram of equal-width bins over [@c min, @c max), with under- and
+    /// overflow counts
+    class fixed_histogram
+    {
+
+    public:
+        /// Constructor
+        ///
+        /// @param n_bins Number of bins
+        /// @param min    Lower edge of the first bin
+        /// @param max    Upper edge of the last bin
+        fixed_histogram(const std::size_t n_bins, const double min,
+                        const double max)
+            : m_min(min), m_max(max), m_bins(n_bins, 0u)
+        {
+            if (n_bins == 0u || !(max > min))
+            {
+                throw std::invalid_argument("Invalid histogram binning");
+            }
+        }
+
+        /// Histogram restored from its written counts
+        ///
+        /// @param min       Lower edge of the first bin
+        /// @param max       Upper edge of the last bin
+        /// @param bins      Counts of the bins
+        /// @param underflow Count below @c min
+        /// @param overflow  Count above @c max
+        fixed_histogram(const double min, const double max,
+                        std::vector<std::size_t> bins,
+                        const std::size_t underflow, const std::size_t overflow)
+            : fixed_histogram(bins.size(), min, max)
+        {
+            m_bins = std::move(bins);
+            m_underflow = underflow;
+            m_overflow = overflow;
+        }
+
+        /// Count a value
+        void fill(const double x)
+        {
+            if (x < m_min)
+            {
+                ++m_underflow;
+            }
+            else if (x >= m_max)
+            {
+                ++m_overflow;
+            }
+            else
+            {
+                const auto bin = static_cast<std::size_t>(
+                    (x - m_min) / (m_max - m_min) *
+                    static_cast<double>(m_bins.size()));
+                ++m_bins[std::min(bin, m_bins.size() - 1u)];
+            }
+        }
+
+        /// Add the counts of @c other, which has to have the same binning
+        void merge(const fixed_histogram &other)
+        {
+            if (other.m_bins.size() != m_bins.size() || other.m_min != m_min ||
+                other.m_max != m_max)
+            {
+                throw std::logic_error("Merging histograms of different binning");
+            }
+            for (std::size_t i = 0; i < m_bins.size(); ++i)
+            {
+                m_bins[i] += other.m_bins[i];
+            }
+            m_underflow += other.m_underflow;
+            m_overflow += other.m_overflow;
+        }
+
+        double min() const { return m_min; }
+        double max() const { return m_max; }
+        const std::vector<std::size_t> &bins() const { return m_bins; }
+        std::size_t underflow() const { return m_underflow; }
+        std::size_t overflow() const { return m_overflow; }
+
+    private:
+        double m_min;
+        double m_max;
+        std::vector<std::size_t> m_bins;
+        std::size_t m_underflow = 0u;
+        std::size_t m_overflow = 0u;
+
+    }; // class fixed_histogram
+
+    /// Online resolution summary of the fitted tracks
+    ///
+    /// For each of qop, qopT and qopz it keeps the statistics of the
+    /// residual (fit - truth), of the relative residual (fit - truth) / truth
+    /// and of the pull (fit - truth) / sigma, and histograms of the latter two.
+    /// The relative residual is histogrammed as its range does not depend on
+    /// the momentum. Tracks whose value is not finite for a quantity, e.g.
+    /// qopz of a track perpendicular to z, are only counted as invalid.
+    ///
+    /// Instances filled on different threads, scan points or processes
+    /// with the same configuration can be merged.
+    class residual_summary
+    {
+
+    public:
+        /// Binning of the histograms
+        struct config
+        {
+            /// Number of bins of every histogram
+            std::size_t bins = 100u;
+            /// Half range of the relative residual histograms
+            double residual_range = 0.5;
+            /// Half range of the pull histograms
+            double pull_range = 5.;
+        };
+
+        /// Statistics of one of qop, qopT and qopz
+        struct quantity_summary
+        {
+            explicit quantity_summary(const config &cfg)
+                : relative_hist(cfg.bins, -cfg.residual_range, cfg.residual_range),
+                  pull_hist(cfg.bins, -cfg.pull_range, cfg.pull_range)
+            {
+            }
+
+            void add(const double fit, const double truth, const double sigma)
+            {
+                const double res = fit - truth;
+                const double rel = res / truth;
+                if (!std::isfinite(res) || !std::isfinite(rel))
+                {
+                    ++invalid;
+                    return;
+                }
+                residual.add(res);
+                relative.add(rel);
+                relative_hist.fill(rel);
+
+                // Tracks without a usable covariance only miss the pull
+                if (sigma > 0. && std::isfinite(sigma))
+                {
+                    pull.add(res / sigma);
+                    pull_hist.fill(res / sigma);
+                }
+            }
+
+            void merge(const quantity_summary &other)
+            {
+                residual.merge(other.residual);
+                relative.merge(other.relative);
+                pull.merge(other.pull);
+                relative_hist.merge(other.relative_hist);
+                pull_hist.merge(other.pull_hist);
+                invalid += other.invalid;
+            }
+
+            running_stats residual;
+            running_stats relative;
+            running_stats pull;
+            fixed_histogram relative_hist;
+            fixed_histogram pull_hist;
+            std::size_t invalid = 0u;
+        };
+
+        /// Names of the summarized quantities
+        static constexpr std::array<const char *, 3> names{"qop", "qopT", "qopz"};
+
+        /// Constructor
+        explicit residual_summary(const config &cfg)
+            : m_cfg(cfg), m_quantities(names.size(), quantity_summary{cfg})
+        {
+        }
+
+        /// Summary restored from its written statistics
+        ///
+        /// @param cfg        Binning of the histograms
+        /// @param tracks     Number of summarized tracks
+        /// @param quantities Statistics of qop, qopT and qopz
+        residual_summary(const config &cfg, const std::size_t tracks,
+                         std::vector<quantity_summary> quantities)
+            : m_cfg(cfg), m_quantities(std::move(quantities)), m_tracks(tracks)
+        {
+            if (m_quantities.size() != names.size())
+            {
+                throw std::invalid_argument("Expected a summary of qop, qopT and qopz");
+            }
+        }
+
+        /// Add one fitted track
+        void add(const residual_record &r)
+        {
+            m_quantities[0].add(r.fit_qop, r.truth_qop, r.fit_qop_err);
+            m_quantities[1].add(r.fit_qopT, r.truth_qopT, r.fit_qopT_err);
+            m_quantities[2].add(r.fit_qopz, r.truth_qopz, r.fit_qopz_err);
+            ++m_tracks;
+        }
+
+        /// Add the fitted tracks of one event
+        void add(const event_records &records)
+        {
+            for (const residual_record &r : records.residuals)
+            {
+                add(r);
+            }
+        }
+
+        /// Add the tracks of @c other
+        void merge(const residual_summary &other)
+        {
+            for (std::size_t i = 0; i < m_quantities.size(); ++i)
+            {
+                m_quantities[i].merge(other.m_quantities[i]);
+            }
+            m_tracks += other.m_tracks;
+        }
+
+        /// Binning of the histograms
+        const config &get_config() const { return m_cfg; }
+
+        /// Number of added tracks
+        std::size_t tracks() const { return m_tracks; }
+
+        /// Statistics of qop, qopT and qopz
+        const std::vector<quantity_summary> &quantities() const
+        {
+            return m_quantities;
+        }
+
+        /// Print the resolution of every quantity
+        void report(std::ostream &os) const
+        {
+            const auto flags = os.flags();
+            const auto precision = os.precision();
+
+            os << "Resolution of " << m_tracks << " tracks\n";
+            os << std::left << std::setw(8) << "" << std::right
+               << std::setw(14) << "mean res" << std::setw(14) << "rms res"
+               << std::setw(14) << "rms rel res" << std::setw(14)
+               << "mean pull" << std::setw(14) << "rms pull" << std::setw(10)
+               << "invalid" << "\n";
+            for (std::size_t i = 0; i < m_quantities.size(); ++i)
+            {
+                const quantity_summary &q = m_quantities[i];
+                os << std::left << std::setw(8) << names[i] << std::right
+                   << std::scientific << std::setprecision(4) << std::setw(14)
+                   << q.residual.mean() << std::setw(14) << q.residual.rms()
+                   << std::setw(14) << q.relative.rms() << std::setw(14)
+                   << q.pull.mean() << std::setw(14) << q.pull.rms()
+                   << std::setw(10) << q.invalid << "\n";
+            }
+            os << std::flush;
+
+            os.flags(flags);
+            os.precision(precision);
+        }
+
+        /// Write the statistics and histograms as JSON into the file @c path
+        void write(const std::string &path) const
+        {
+            std::ofstream file(path);
+            if (!file)
+            {
+                throw std::runtime_error("Could not open " + path);
+            }
+
+            // Round trip exactly, as from_summary and bella_merge read it back
+            file << std::setprecision(std::numeric_limits<double>::max_digits10);
+            file << "{\n  \"tracks\": " << m_tracks << ",\n  \"quantities\": {";
+            for (std::size_t i = 0; i < m_quantities.size(); ++i)
+            {
+                const quantity_summary &q = m_quantities[i];
+                file << (i == 0u ? "\n" : ",\n") << "    \"" << names[i]
+                     << "\": {\n      \"invalid\": " << q.invalid;
+                write_stats(file, "residual", q.residual);
+                write_stats(file, "relative_residual", q.relative);
+                write_stats(file, "pull", q.pull);
+                write_histogram(file, "relative_residual_histogram",
+                                q.relative_hist);
+                write_histogram(file, "pull_histogram", q.pull_hist);
+                file << "\n    }";
+            }
+            file << "\n  }\n}\n";
+        }
+
+    private:
+        static void write_stats(std::ostream &os, const char *name,
+                                const running_stats &s)
+        {
+            os << ",\n      \"" << name << "\": {\"count\": " << s.count()
+               << ", \"mean\": " << s.mean() << ", \"rms\": " << s.rms();
+            if (s.count() > 0u)
+            {
+                os << ", \"min\": " << s.min() << ", \"max\": " << s.max();
+            }
+            os << "}";
+        }
+
+        static void write_histogram(std::ostream &os, const char *name,
+                                    const fixed_histogram &h)
+        {
+            os << ",\n      \"" << name << "\": {\"min\": " << h.min()
+               << ", \"max\": " << h.max() << ", \"underflow\": "
+               << h.underflow() << ", \"overflow\": " << h.overflow()
+               << ", \"bins\": [";
+            for (std::size_t i = 0; i < h.bins().size(); ++i)
+            {
+                os << (i == 0u ? "" : ", ") << h.bins()[i];
+            }
+            os << "]}";
+        }
+
+        config m_cfg;
+        std::vector<quantity_summary> m_quantities;
+        std::size_t m_tracks = 0u;
+
+    }; // class residual_summary
+
+} // namespace bella
@@ -0,0 +1,119 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Project include(s).
+#include "traccc/definitions/common.hpp"
+#include "traccc/definitions/primitives.hpp"
+#include "traccc/options/generation.hpp"
+
+// Local include(s).
+#include "src/scan_options.hpp"
+#include "src/track_generator.hpp"
+
+// System include(s).
+#include <array>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace bella
+{
+
+    /// One (momentum, theta) point of a parameter scan
+    struct scan_point
+    {
+        /// Momentum [GeV]
+        traccc::scalar mom;
+        /// Theta [degree]
+        traccc::scalar theta;
+        /// Name of the point in output files, e.g. "0.1_GeV_90_theta"
+        std::string label;
+
+        /// Set the momentum and theta of a generator configuration
+        void apply(generator_type::configuration &gen_cfg) const
+        {
+            using traccc::scalar;
+            using traccc::unit;
+
+            gen_cfg.mom_range(std::array<scalar, 2>{mom * unit<scalar>::GeV,
+                                                    mom * unit<scalar>::GeV});
+            gen_cfg.theta_range(
+                std::array<scalar, 2>{theta * unit<scalar>::degree,
+                                      theta * unit<scalar>::degree});
+        }
+    };
+
+    namespace detail
+    {
+
+        /// Split a comma separated list, or format @c fallback if it is empty
+        inline std::vector<std::string> scan_values(const std::string &list,
+                                                    const traccc::scalar fallback)
+        {
+            std::vector<std::string> values;
+
+            std::stringstream ss(list);
+            std::string value;
+            while (std::getline(ss, value, ','))
+            {
+                if (!value.empty())
+                {
+                    values.push_back(value);
+                }
+            }
+
+            if (values.empty())
+            {
+                std::ostringstream os;
+                os << fallback;
+                values.push_back(os.str());
+            }
+            return values;
+        }
+
+    } // namespace detail
+
+    /// All points of the scan, with the momentum or theta of the generation
+    /// options for the dimension that is not scanned
+    inline std::vector<scan_point> make_scan_points(
+        const traccc::opts::scan_options &scan_opts,
+        const traccc::opts::generation &generation_opts)
+    {
+        using traccc::scalar;
+        using traccc::unit;
+
+        const auto moms = detail::scan_values(
+            scan_opts.mom, generation_opts.mom_range[0] / unit<scalar>::GeV);
+        const auto thetas = detail::scan_values(
+            scan_opts.theta,
+            generation_opts.theta_range[0] / unit<scalar>::degree);
+
+        std::vector<scan_point> points;
+        for (const auto &theta : thetas)
+        {
+            for (const auto &mom : moms)
+            {
+                try
+                {
+                    points.push_back({static_cast<scalar>(std::stod(mom)),
+                                      static_cast<scalar>(std::stod(theta)),
+                                      mom + "_GeV_" + theta + "_theta"});
+                }
+                catch (const std::logic_error &)
+                {
+                    throw std::invalid_argument("Invalid scan point " + mom +
+                                                " GeV, " + theta + " degree");
+                }
+            }
+        }
+        return points;
+    }
+
+} // namespace bella
@@ -0,0 +1,51 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Local include(s).
+#include "traccc/options/details/interface.hpp"
+
+// System include(s).
+#include <string>
+
+namespace traccc::opts
+{
+
+    /// Convenience namespace shorthand
+    namespace po = boost::program_options;
+
+    /// Command line options of a (momentum, theta) parameter scan
+    class scan_options : public interface
+    {
+
+    public:
+        /// Constructor
+        scan_options() : interface("BELLA Scan Options")
+        {
+
+            m_desc.add_options()("scan-mom",
+                                 po::value(&(mom))
+                                     ->default_value(""),
+                                 "Comma separated particle momenta [GeV] to "
+                                 "scan");
+            m_desc.add_options()("scan-theta",
+                                 po::value(&(theta))
+                                     ->default_value(""),
+                                 "Comma separated theta angles [degree] to "
+                                 "scan");
+        }
+
+        /// Whether a scan was requested
+        bool enabled() const { return !mom.empty() || !theta.empty(); }
+
+        std::string mom;
+        std::string theta;
+
+    }; // class scan_options
+
+} // namespace traccc::opts
@@ -0,0 +1,105 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Local include(s).
+#include "src/shard_options.hpp"
+
+// System include(s).
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bella
+{
+
+    /// Shard @c index of @c count of a job array
+    ///
+    /// Every shard takes one contiguous block of the events, so the shards
+    /// of a job array together process every event exactly once. With scan
+    /// points, the blocks are taken of the (point, event) pairs numbered
+    /// point by point, so that each shard runs only some of the points.
+    struct shard
+    {
+        std::size_t index = 0u;
+        std::size_t count = 1u;
+
+        /// Whether the events are split at all
+        bool enabled() const { return count > 1u; }
+
+        /// The block of [@c begin, @c end) of this shard
+        std::pair<std::size_t, std::size_t> range(const std::size_t begin,
+                                                  const std::size_t end) const
+        {
+            const std::size_t n = end - begin;
+            return {begin + n * index / count, begin + n * (index + 1u) / count};
+        }
+
+        /// The block of the events of each of @c n_points scan points of
+        /// @c n_events events, empty for the points of other shards
+        ///
+        /// With at least as many points as shards every shard runs whole
+        /// points, apart from the points split at the block boundaries.
+        std::vector<std::pair<std::size_t, std::size_t>> point_ranges(
+            const std::size_t n_points, const std::size_t n_events) const
+        {
+            const auto [first, last] = range(0u, n_points * n_events);
+            std::vector<std::pair<std::size_t, std::size_t>> ranges(
+                n_points, {0u, 0u});
+            for (std::size_t p = 0; p < n_points; ++p)
+            {
+                const std::size_t begin = std::max(first, p * n_events);
+                const std::size_t end = std::min(last, (p + 1u) * n_events);
+                if (begin < end)
+                {
+                    ranges[p] = {begin - p * n_events, end - p * n_events};
+                }
+            }
+            return ranges;
+        }
+
+        /// Appended to the output file names, e.g. "_shard_3_of_8"
+        std::string suffix() const
+        {
+            return enabled() ? "_shard_" + std::to_string(index) + "_of_" +
+                                   std::to_string(count)
+                             : "";
+        }
+    };
+
+    /// Make the shard given as "i/N" by the shard options
+    inline shard make_shard(const traccc::opts::shard_options &opts)
+    {
+        const std::size_t slash = opts.shard.find('/');
+        shard s;
+        try
+        {
+            if (slash == std::string::npos)
+            {
+                throw std::invalid_argument("no '/'");
+            }
+            s.index = std::stoul(opts.shard.substr(0u, slash));
+            s.count = std::stoul(opts.shard.substr(slash + 1u));
+        }
+        catch (const std::exception &)
+        {
+            throw std::invalid_argument("Invalid --shard, expected i/N: " +
+                                        opts.shard);
+        }
+        if (s.count == 0u || s.index >= s.count)
+        {
+            throw std::invalid_argument("Invalid --shard, expected 0 <= i < N: " +
+                                        opts.shard);
+        }
+        return s;
+    }
+
+} // namespace bella
@@ -0,0 +1,45 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Local include(s).
+#include "traccc/options/details/interface.hpp"
+
+// System include(s).
+#include <string>
+
+namespace traccc::opts
+{
+
+    /// Convenience namespace shorthand
+    namespace po = boost::program_options;
+
+    /// Command line options of one shard of a job array
+    class shard_options : public interface
+    {
+
+    public:
+        /// Constructor
+        shard_options() : interface("BELLA Shard Options")
+        {
+
+            m_desc.add_options()("shard",
+                                 po::value(&(shard))
+                                     ->default_value("0/1"),
+                                 "Process only shard i of N, given as i/N: "
+                                 "the i-th of N equal blocks of the events, "
+                                 "counted over all scan points; "
+                                 "do_telescope_simulation needs "
+                                 "--parallel-simulation with it");
+        }
+
+        std::string shard;
+
+    }; // class shard_options
+
+} // namespace traccc::opts
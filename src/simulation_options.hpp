@@ -0,0 +1,59 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Local include(s).
+#include "traccc/options/details/interface.hpp"
+
+// System include(s).
+#include <cstdint>
+
+namespace traccc::opts
+{
+
+    /// Convenience namespace shorthand
+    namespace po = boost::program_options;
+
+    /// Command line options of the BELLA simulation
+    class simulation_options : public interface
+    {
+
+    public:
+        /// Constructor
+        simulation_options() : interface("BELLA Simulation Options")
+        {
+
+            m_desc.add_options()("parallel-simulation",
+                                 po::bool_switch(&(parallel))
+                                     ->default_value(false),
+                                 "Simulate the events on --cpu-threads "
+                                 "threads, with per-event random streams "
+                                 "(scan points are then run one after the "
+                                 "other)");
+            m_desc.add_options()("seed",
+                                 po::value(&(seed))
+                                     ->default_value(0u),
+                                 "Key of the counter-based random streams "
+                                 "of the parallel simulation; jobs with "
+                                 "different seeds simulate different events "
+                                 "(needs --parallel-simulation)");
+        }
+
+        /// Whether --seed was given, also when given its default
+        void read(const po::variables_map &vm) override
+        {
+            seed_given = vm.count("seed") > 0u && !vm["seed"].defaulted();
+        }
+
+        bool parallel;
+        std::uint64_t seed;
+        bool seed_given = false;
+
+    }; // class simulation_options
+
+} // namespace traccc::opts
@@ -0,0 +1,244 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// System include(s).
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bella
+{
+
+    /// Time spent in the stages of an executable, and its throughput
+    ///
+    /// Every stage collects one sample per timed call, e.g. one per event
+    /// for the event load, so the report gives the per-stage totals and the
+    /// percentiles of the samples. The stages may be timed on several
+    /// threads at once; their totals are then summed over the threads,
+    /// while the rates are taken over the wall time since construction.
+    /// A disabled timing records nothing.
+    class stage_timing
+    {
+
+    public:
+        using clock = std::chrono::steady_clock;
+
+        /// Constructor
+        ///
+        /// @param enabled Whether anything is recorded
+        explicit stage_timing(const bool enabled) : m_enabled(enabled) {}
+
+        /// Whether anything is recorded
+        bool enabled() const { return m_enabled; }
+
+        /// Add one sample of @c seconds to the stage @c stage
+        void add(const std::string &stage, const double seconds)
+        {
+            if (!m_enabled)
+            {
+                return;
+            }
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_index.find(stage);
+            if (it == m_index.end())
+            {
+                it = m_index.emplace(stage, m_stages.size()).first;
+                m_stages.push_back({stage, {}});
+            }
+            m_stages[it->second].samples.push_back(seconds);
+        }
+
+        /// Add the time since @c start to the stage @c stage
+        void add_since(const std::string &stage, const clock::time_point start)
+        {
+            add(stage, std::chrono::duration<double>(clock::now() - start).count());
+        }
+
+        /// Count @c n_events processed events holding @c n_tracks tracks
+        void count(const std::size_t n_events, const std::size_t n_tracks)
+        {
+            if (!m_enabled)
+            {
+                return;
+            }
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_events += n_events;
+            m_tracks += n_tracks;
+        }
+
+        /// Print the per-stage totals and percentiles and the rates
+        void report(std::ostream &os) const
+        {
+            if (!m_enabled)
+            {
+                return;
+            }
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const double wall = wall_time();
+            const auto flags = os.flags();
+            const auto precision = os.precision();
+
+            os << "Timing over " << std::fixed << std::setprecision(3) << wall
+               << " s wall time (stage totals summed over threads)\n";
+            os << std::left << std::setw(16) << "stage" << std::right
+               << std::setw(8) << "calls" << std::setw(12) << "total [s]"
+               << std::setw(12) << "p50 [ms]" << std::setw(12) << "p90 [ms]"
+               << std::setw(12) << "p99 [ms]" << std::setw(12) << "max [ms]"
+               << "\n";
+            for (const stage &s : m_stages)
+            {
+                const summary sum = summarize(s);
+                os << std::left << std::setw(16) << s.name << std::right
+                   << std::setw(8) << s.samples.size() << std::setw(12)
+                   << sum.total << std::setw(12) << 1e3 * sum.p50
+                   << std::setw(12) << 1e3 * sum.p90 << std::setw(12)
+                   << 1e3 * sum.p99 << std::setw(12) << 1e3 * sum.max << "\n";
+            }
+            os << m_events << " events, " << m_tracks << " tracks: "
+               << m_events / wall << " events/s, " << m_tracks / wall
+               << " tracks/s" << std::endl;
+
+            os.flags(flags);
+            os.precision(precision);
+        }
+
+        /// Write the report as JSON into the file @c path
+        void dump(const std::string &path) const
+        {
+            if (!m_enabled)
+            {
+                return;
+            }
+            std::ofstream file(path);
+            if (!file)
+            {
+                throw std::runtime_error("Could not open " + path);
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const double wall = wall_time();
+
+            file << std::setprecision(9);
+            file << "{\n  \"wall_time_s\": " << wall
+                 << ",\n  \"events\": " << m_events
+                 << ",\n  \"tracks\": " << m_tracks
+                 << ",\n  \"events_per_s\": " << m_events / wall
+                 << ",\n  \"tracks_per_s\": " << m_tracks / wall
+                 << ",\n  \"stages\": [";
+            for (std::size_t i = 0; i < m_stages.size(); ++i)
+            {
+                const stage &s = m_stages[i];
+                const summary sum = summarize(s);
+                file << (i == 0u ? "\n" : ",\n") << "    {\"name\": \"" << s.name
+                     << "\", \"calls\": " << s.samples.size()
+                     << ", \"total_s\": " << sum.total
+                     << ", \"mean_s\": " << sum.total / s.samples.size()
+                     << ", \"p50_s\": " << sum.p50 << ", \"p90_s\": " << sum.p90
+                     << ", \"p99_s\": " << sum.p99 << ", \"max_s\": " << sum.max
+                     << "}";
+            }
+            file << "\n  ]\n}\n";
+        }
+
+    private:
+        /// Samples of one stage, in seconds
+        struct stage
+        {
+            std::string name;
+            std::vector<double> samples;
+        };
+
+        /// Total and percentiles of the samples of one stage
+        struct summary
+        {
+            double total = 0.;
+            double p50 = 0.;
+            double p90 = 0.;
+            double p99 = 0.;
+            double max = 0.;
+        };
+
+        static summary summarize(const stage &s)
+        {
+            std::vector<double> sorted = s.samples;
+            std::sort(sorted.begin(), sorted.end());
+
+            // Nearest-rank percentile
+            auto percentile = [&sorted](const double p)
+            {
+                const std::size_t rank = static_cast<std::size_t>(
+                    p * static_cast<double>(sorted.size() - 1u) + 0.5);
+                return sorted[rank];
+            };
+
+            summary sum;
+            for (const double t : sorted)
+            {
+                sum.total += t;
+            }
+            sum.p50 = percentile(0.5);
+            sum.p90 = percentile(0.9);
+            sum.p99 = percentile(0.99);
+            sum.max = sorted.back();
+            return sum;
+        }
+
+        double wall_time() const
+        {
+            return std::chrono::duration<double>(clock::now() - m_start).count();
+        }
+
+        bool m_enabled;
+        clock::time_point m_start = clock::now();
+
+        mutable std::mutex m_mutex;
+        std::vector<stage> m_stages;
+        std::map<std::string, std::size_t> m_index;
+        std::size_t m_events = 0u;
+        std::size_t m_tracks = 0u;
+
+    }; // class stage_timing
+
+    /// Adds the time between its construction and destruction to a stage
+    class scoped_timer
+    {
+
+    public:
+        /// Constructor
+        ///
+        /// @param timing Timing the sample is added to
+        /// @param stage  Name of the timed stage
+        scoped_timer(stage_timing &timing, std::string stage)
+            : m_timing(timing), m_stage(std::move(stage))
+        {
+        }
+
+        /// Destructor, adding the sample
+        ~scoped_timer() { m_timing.add_since(m_stage, m_start); }
+
+        scoped_timer(const scoped_timer &) = delete;
+        scoped_timer &operator=(const scoped_timer &) = delete;
+
+    private:
+        stage_timing &m_timing;
+        std::string m_stage;
+        stage_timing::clock::time_point m_start = stage_timing::clock::now();
+
+    }; // class scoped_timer
+
+} // namespace bella
@@ -0,0 +1,93 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Local include(s).
+#include "src/residual_summary.hpp"
+
+// nlohmann include(s).
+#include <nlohmann/json.hpp>
+
+// System include(s).
+#include <cstddef>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bella
+{
+
+    namespace detail
+    {
+        inline running_stats read_stats(const nlohmann::json &j)
+        {
+            const std::size_t count = j.at("count").get<std::size_t>();
+            return running_stats::from_summary(
+                count, j.at("mean").get<double>(), j.at("rms").get<double>(),
+                count > 0u ? j.at("min").get<double>() : 0.,
+                count > 0u ? j.at("max").get<double>() : 0.);
+        }
+
+        inline fixed_histogram read_histogram(const nlohmann::json &j)
+        {
+            return fixed_histogram(j.at("min").get<double>(),
+                                   j.at("max").get<double>(),
+                                   j.at("bins").get<std::vector<std::size_t>>(),
+                                   j.at("underflow").get<std::size_t>(),
+                                   j.at("overflow").get<std::size_t>());
+        }
+    } // namespace detail
+
+    /// Read a JSON file
+    inline nlohmann::json read_json(const std::string &path)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            throw std::runtime_error("Could not open " + path);
+        }
+        return nlohmann::json::parse(file);
+    }
+
+    /// Read a summary written by @c residual_summary::write
+    inline residual_summary read_residual_summary(const std::string &path)
+    {
+        const nlohmann::json j = read_json(path);
+        const nlohmann::json &quantities = j.at("quantities");
+
+        // The binning is that of the histograms of the first quantity
+        const nlohmann::json &first = quantities.at(residual_summary::names[0]);
+        residual_summary::config cfg;
+        cfg.bins = first.at("pull_histogram").at("bins").size();
+        cfg.residual_range =
+            first.at("relative_residual_histogram").at("max").get<double>();
+        cfg.pull_range = first.at("pull_histogram").at("max").get<double>();
+
+        std::vector<residual_summary::quantity_summary> summaries;
+        for (const char *name : residual_summary::names)
+        {
+            const nlohmann::json &q = quantities.at(name);
+
+            residual_summary::quantity_summary s(cfg);
+            s.invalid = q.at("invalid").get<std::size_t>();
+            s.residual = detail::read_stats(q.at("residual"));
+            s.relative = detail::read_stats(q.at("relative_residual"));
+            s.pull = detail::read_stats(q.at("pull"));
+            s.relative_hist =
+                detail::read_histogram(q.at("relative_residual_histogram"));
+            s.pull_hist = detail::read_histogram(q.at("pull_histogram"));
+            summaries.push_back(std::move(s));
+        }
+
+        return residual_summary(cfg, j.at("tracks").get<std::size_t>(),
+                                std::move(summaries));
+    }
+
+} // namespace bella
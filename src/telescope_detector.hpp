@@ -0,0 +1,175 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Project include(s).
+#include "traccc/definitions/common.hpp"
+#include "traccc/definitions/primitives.hpp"
+
+// detray include(s).
+#include "detray/geometry/mask.hpp"
+#include "detray/geometry/shapes/rectangle2D.hpp"
+#include "detray/materials/material.hpp"
+#include "detray/materials/material_slab.hpp"
+#include "detray/navigation/detail/ray.hpp"
+#include "detray/test/utils/detectors/build_telescope_detector.hpp"
+
+// Local include(s).
+#include "src/geometry_config.hpp"
+#include "src/telescope_metadata.hpp"
+
+// VecMem include(s).
+#include <vecmem/memory/memory_resource.hpp>
+
+// System include(s).
+#include <algorithm>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace bella
+{
+
+    /// Turn the modules at the passive slab positions of @c cfg into passive
+    /// surfaces with the slab material
+    ///
+    /// The slabs keep the homogeneous material of the telescope metadata, so
+    /// the material interactor finds their material in a single lookup like
+    /// on the sensitive planes. Passive surfaces get no measurements, and
+    /// the Kalman fitter only applies their material.
+    ///
+    /// The brute force surface lookup the navigator reads holds its own
+    /// copies of the surface descriptors, so the surface is made passive in
+    /// both the detector surfaces and the lookup.
+    ///
+    /// @param det Telescope built with modules at the slab positions
+    /// @param cfg Layout of the telescope
+    inline void add_passive_material(host_detector_type &det,
+                                     const geometry_config &cfg)
+    {
+        using traccc::scalar;
+
+        // Half a micrometre, far below any module spacing
+        const scalar tolerance = 0.5f * traccc::unit<scalar>::um;
+
+        for (const passive_slab &slab : cfg.passive_slabs)
+        {
+            const scalar x = slab.position * traccc::unit<scalar>::mm;
+
+            bool found = false;
+            for (auto &sf : det.surfaces())
+            {
+                if (!sf.is_sensitive())
+                {
+                    continue;
+                }
+                const auto &center =
+                    det.transform_store().at(sf.transform()).translation();
+                if (detray::math::fabs(center[0] - x) > tolerance)
+                {
+                    continue;
+                }
+
+                // The copy in the surface lookup, found by its barcode
+                // before the id changes
+                const auto barcode = sf.barcode();
+                auto &lookup = det.accelerator_store().template get<
+                    telescope_metadata::accel_ids::e_brute_force>();
+                for (auto &lookup_sf : lookup.all())
+                {
+                    if (lookup_sf.barcode() == barcode)
+                    {
+                        lookup_sf.set_id(detray::surface_id::e_passive);
+                    }
+                }
+                sf.set_id(detray::surface_id::e_passive);
+
+                auto &slabs = det.material_store().template get<
+                    host_detector_type::materials::id::e_slab>();
+                slabs.at(sf.material().index()) = detray::material_slab<scalar>(
+                    material_from_name(slab.material),
+                    slab.thickness * traccc::unit<scalar>::mm);
+
+                found = true;
+                break;
+            }
+            if (!found)
+            {
+                throw std::logic_error("No telescope module for a passive slab");
+            }
+        }
+    }
+
+    /// Build the BELLA telescope detector
+    ///
+    /// The detector is a @c bella::host_detector_type.
+    ///
+    /// @param mr  Memory resource of the detector
+    /// @param cfg Layout of the telescope
+    /// @return The detector and its volume name map
+    inline auto build_detector(vecmem::memory_resource &mr,
+                               const geometry_config &cfg = {})
+    {
+        using traccc::scalar;
+
+        // Plane alignment direction (Planes are aligned along the x-axis)
+        const traccc::vector3 align_axis{1.f, 0.f, 0.f};
+        detray::detail::ray<traccc::default_algebra> pilot_track{
+            {0, 0, 0}, 0, align_axis, -1};
+
+        // Positions of the sensitive planes and the passive slabs (in mm
+        // unit). The telescope builder places all of them as modules, in
+        // ascending x.
+        std::vector<scalar> module_positions;
+        for (const scalar x : cfg.plane_positions)
+        {
+            module_positions.push_back(x * traccc::unit<scalar>::mm);
+        }
+        for (const passive_slab &slab : cfg.passive_slabs)
+        {
+            module_positions.push_back(slab.position * traccc::unit<scalar>::mm);
+        }
+        std::sort(module_positions.begin(), module_positions.end());
+        if (std::adjacent_find(module_positions.begin(), module_positions.end()) !=
+            module_positions.end())
+        {
+            throw std::invalid_argument("Two telescope modules at the same position");
+        }
+
+        // Set sensitive planes material, thickness and its size
+        detray::material<scalar> sensitive_mat =
+            material_from_name(cfg.plane_material);
+        const scalar sensitive_thickness =
+            cfg.plane_thickness * traccc::unit<scalar>::mm;
+        detray::mask<detray::rectangle2D> sensitive_rect{
+            0u, cfg.plane_half_length * traccc::unit<scalar>::mm,
+            cfg.plane_half_length * traccc::unit<scalar>::mm};
+
+        // Create the telescope geometry with all modules
+        detray::tel_det_config<detray::rectangle2D,
+                               detray::detail::ray<traccc::default_algebra>>
+            tel_cfg{sensitive_rect, pilot_track};
+        tel_cfg.positions(module_positions);
+        tel_cfg.module_material(sensitive_mat);
+        tel_cfg.mat_thickness(sensitive_thickness);
+        tel_cfg.envelope(100.f * traccc::unit<scalar>::mm);
+
+        auto detector = detray::build_telescope_detector(mr, tel_cfg);
+
+        // The fitters read the written geometry back into the same type
+        static_assert(std::is_same_v<std::remove_cvref_t<decltype(std::get<0>(detector))>,
+                                     host_detector_type>,
+                      "The telescope builder does not make a bella::host_detector_type");
+
+        add_passive_material(std::get<0>(detector), cfg);
+
+        return detector;
+    }
+
+} // namespace bella
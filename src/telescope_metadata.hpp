@@ -0,0 +1,33 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// detray include(s).
+#include "detray/core/detector.hpp"
+#include "detray/detectors/telescope_metadata.hpp"
+#include "detray/geometry/shapes/rectangle2D.hpp"
+
+namespace bella
+{
+
+    /// Detector metadata of the BELLA telescope
+    ///
+    /// Only rectangular planes (and portals), homogeneous material slabs and
+    /// brute force surface lookup, so the navigator is compiled for exactly
+    /// the surfaces BELLA has instead of the variants of the default
+    /// metadata.
+    using telescope_metadata = detray::telescope_metadata<detray::rectangle2D>;
+
+    /// BELLA telescope detector in host or device containers
+    template <typename container_t = detray::host_container_types>
+    using telescope_detector = detray::detector<telescope_metadata, container_t>;
+
+    /// BELLA telescope detector on the host
+    using host_detector_type = telescope_detector<>;
+
+} // namespace bella
@@ -0,0 +1,84 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Project include(s).
+#include "traccc/definitions/primitives.hpp"
+
+// detray include(s).
+#include "detray/geometry/barcode.hpp"
+#include "detray/geometry/tracking_surface.hpp"
+
+// System include(s).
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace bella
+{
+
+    /// One sensitive plane of the telescope, with its local frame in global
+    /// coordinates
+    struct sensitive_plane
+    {
+        detray::geometry::barcode barcode;
+        /// Global position of the plane
+        traccc::scalar x;
+        /// Global position of the local origin
+        traccc::point3 origin;
+        /// Global directions of the two local axes
+        traccc::vector3 u;
+        traccc::vector3 v;
+
+        /// Global position of the local point (@c l0, @c l1)
+        traccc::point3 global(const traccc::scalar l0,
+                              const traccc::scalar l1) const
+        {
+            return origin + l0 * u + l1 * v;
+        }
+    };
+
+    /// Sensitive planes of a telescope, in ascending x
+    ///
+    /// The plane index in this order is the plane number of the raw data.
+    ///
+    /// @param det Telescope with planes perpendicular to x
+    template <typename detector_t>
+    std::vector<sensitive_plane> sensitive_planes(const detector_t &det)
+    {
+        const traccc::vector3 beam{1.f, 0.f, 0.f};
+
+        std::vector<sensitive_plane> planes;
+        for (const auto &desc : det.surfaces())
+        {
+            if (!desc.is_sensitive())
+            {
+                continue;
+            }
+
+            const detray::tracking_surface sf{det, desc.barcode()};
+            const auto origin = sf.bound_to_global({}, {0.f, 0.f}, beam);
+            const auto u = sf.bound_to_global({}, {1.f, 0.f}, beam) - origin;
+            const auto v = sf.bound_to_global({}, {0.f, 1.f}, beam) - origin;
+            if (std::abs(u[0]) > 1e-6f || std::abs(v[0]) > 1e-6f)
+            {
+                throw std::logic_error(
+                    "The telescope planes are not perpendicular to x");
+            }
+
+            planes.push_back({desc.barcode(), origin[0], origin, u, v});
+        }
+
+        std::sort(planes.begin(), planes.end(),
+                  [](const sensitive_plane &a, const sensitive_plane &b)
+                  { return a.x < b.x; });
+        return planes;
+    }
+
+} // namespace bella
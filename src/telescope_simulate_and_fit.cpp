@@ -0,0 +1,379 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+// Project include(s).
+#include "traccc/definitions/common.hpp"
+#include "traccc/definitions/primitives.hpp"
+#include "traccc/fitting/fitting_algorithm.hpp"
+#include "traccc/fitting/kalman_filter/kalman_fitter.hpp"
+#include "traccc/options/generation.hpp"
+#include "traccc/options/program_options.hpp"
+#include "traccc/options/threading.hpp"
+#include "traccc/options/track_propagation.hpp"
+#include "traccc/simulation/measurement_smearer.hpp"
+#include "traccc/simulation/simulator.hpp"
+
+// Detray include(s).
+#include "detray/detectors/bfield.hpp"
+#include "detray/navigation/navigator.hpp"
+#include "detray/propagator/propagator.hpp"
+#include "detray/propagator/rk_stepper.hpp"
+
+// Local include(s).
+#include "src/batched_kalman_fitter.hpp"
+#include "src/bounded_queue.hpp"
+#include "src/chunked_fitting.hpp"
+#include "src/event_loop.hpp"
+#include "src/event_store.hpp"
+#include "src/field_model.hpp"
+#include "src/field_options.hpp"
+#include "src/geometry_config.hpp"
+#include "src/fit_output.hpp"
+#include "src/fit_output_options.hpp"
+#include "src/fitting_options.hpp"
+#include "src/gap_stepper.hpp"
+#include "src/memory_writer.hpp"
+#include "src/parallel_simulator.hpp"
+#include "src/pipeline_options.hpp"
+#include "src/residual_summary.hpp"
+#include "src/scan.hpp"
+#include "src/scan_options.hpp"
+#include "src/shard.hpp"
+#include "src/shard_options.hpp"
+#include "src/simulation_options.hpp"
+#include "src/telescope_detector.hpp"
+#include "src/telescope_planes.hpp"
+#include "src/track_finder.hpp"
+#include "src/track_finding_options.hpp"
+#include "src/track_generator.hpp"
+#include "src/truth_fitting.hpp"
+
+// VecMem include(s).
+#include <vecmem/memory/host_memory_resource.hpp>
+
+// System include(s).
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+using namespace traccc;
+
+// The main routine
+//
+int main(int argc, char *argv[])
+{
+    // Program options.
+    traccc::opts::generation generation_opts;
+    traccc::opts::track_propagation propagation_opts;
+    traccc::opts::field_options field_opts;
+    traccc::opts::threading threading_opts;
+    traccc::opts::fitting_options fitting_opts;
+    traccc::opts::fit_output_options output_opts;
+    traccc::opts::pipeline_options pipeline_opts;
+    traccc::opts::scan_options scan_opts;
+    traccc::opts::bella_geometry_options geometry_opts;
+    traccc::opts::simulation_options simulation_opts;
+    traccc::opts::shard_options shard_opts;
+    traccc::opts::track_finding_options finding_opts;
+    traccc::opts::program_options program_opts{
+        "Telescope-Detector Simulation and Truth Track Fitting",
+        {generation_opts, propagation_opts, field_opts, threading_opts,
+         fitting_opts, output_opts, pipeline_opts, scan_opts, geometry_opts,
+         simulation_opts, shard_opts, finding_opts},
+        argc,
+        argv};
+
+    // A shard simulates and fits its block of the events of all scan points,
+    // which needs the BELLA simulation with its per-particle random streams
+    const bella::shard shard = bella::make_shard(shard_opts);
+    const bool bella_simulation = simulation_opts.parallel || shard.enabled();
+    if (simulation_opts.seed_given && !bella_simulation)
+    {
+        throw std::invalid_argument(
+            "--seed needs --parallel-simulation or --shard");
+    }
+    // Memory resource
+    vecmem::host_memory_resource host_mr;
+
+    /*****************************
+     * Build the Bella Detector
+     *****************************/
+
+    const bella::geometry_config geometry =
+        bella::make_geometry_config(geometry_opts);
+    const auto [det, name_map] = bella::build_detector(host_mr, geometry);
+
+    /// Type declarations
+    using detector_type = std::remove_cvref_t<decltype(det)>;
+    using smearer_type = traccc::measurement_smearer<traccc::default_algebra>;
+    using writer_type = bella::memory_writer<smearer_type>;
+
+    // Smearing value for measurements (measurement noise)
+    smearer_type meas_smearer(50.f * traccc::unit<scalar>::mm,
+                              50.f * traccc::unit<scalar>::mm);
+
+    // With --fit-mode=batched the tracks crossing every plane are fitted in
+    // batches, and only the others by the traccc fitter
+    std::optional<bella::batched_kalman_fitter> batched_fitter;
+    if (fitting_opts.mode == "batched")
+    {
+        batched_fitter.emplace(det, bella::make_batched_fitter_config(fitting_opts));
+    }
+    else if (fitting_opts.mode != "scalar")
+    {
+        throw std::invalid_argument("Unknown fit mode: " + fitting_opts.mode);
+    }
+
+    // With --track-candidates=finder the tracks are found in the measurements
+    // instead of taken from the truth
+    std::optional<bella::track_finder> finder;
+    std::vector<bella::sensitive_plane> planes;
+    if (finding_opts.candidates == "finder")
+    {
+        finder.emplace(det, bella::make_track_finder_config(finding_opts));
+        planes = bella::sensitive_planes(det);
+    }
+    else if (finding_opts.candidates != "auto" &&
+             finding_opts.candidates != "truth")
+    {
+        throw std::invalid_argument("Unknown track candidates for simulated "
+                                    "events: " + finding_opts.candidates);
+    }
+
+    // The stepper, and with it the fitter, is specialized on the B field type.
+    // The magnet field model crosses the field-free gaps on straight lines.
+    bella::with_field(field_opts, geometry.magnets, [&](const auto &field)
+    {
+        using b_field_t = std::remove_cvref_t<decltype(field)>;
+
+        using rk_stepper_type = bella::stepper_type<b_field_t>;
+        using host_navigator_type = detray::navigator<const detector_type>;
+        using host_fitter_type =
+            traccc::kalman_fitter<rk_stepper_type, host_navigator_type>;
+
+        // Fitting algorithm object
+        typename traccc::fitting_algorithm<host_fitter_type>::config_type fit_cfg;
+        fit_cfg.propagation = propagation_opts;
+
+        traccc::fitting_algorithm<host_fitter_type> host_fitting(fit_cfg);
+
+        const typename b_field_t::view_t field_view(field);
+
+        /*****************************
+         * Simulate and fit concurrently
+         *****************************/
+
+        // Simulate the events [first_event, last_event) of one generator
+        // configuration on one thread, or on @c n_fitters with
+        // --parallel-simulation, and fit them on @c n_fitters others while
+        // they are produced. Every fitting thread summarizes its own tracks
+        // into a copy of @c summary, which are merged when the thread is done.
+        auto run_pipeline = [&](const bella::generator_type::configuration &gen_cfg,
+                                const std::size_t first_event,
+                                const std::size_t last_event,
+                                const std::size_t n_fitters,
+                                bella::record_writer &output_writer,
+                                bella::residual_summary &summary)
+        {
+            // Events travel from the simulation to the fitting through this queue
+            bella::bounded_queue<bella::truth_event> events(pipeline_opts.queue_size);
+
+            // Write the records of one event. Called in event order.
+            auto write_event = [&](const bella::event_records &records)
+            {
+                std::cout << "Number of fitted tracks: " << records.residuals.size()
+                          << std::endl;
+
+                output_writer.write(records);
+            };
+            bella::ordered_consumer<bella::event_records, decltype(write_event)>
+                consumer(first_event, write_event);
+
+            std::mutex error_mutex;
+            std::exception_ptr error;
+            auto record_error = [&]()
+            {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error)
+                {
+                    error = std::current_exception();
+                }
+                // Unblock the other side of the queue
+                events.close();
+            };
+
+            // Only the simulator that runs is built, on the simulation thread
+            auto simulate_events = [&]()
+            {
+                try
+                {
+                    typename writer_type::config writer_cfg{
+                        meas_smearer, generation_opts.ptc_type, &events};
+
+                    if (bella_simulation)
+                    {
+                        bella::parallel_simulator<const detector_type, b_field_t,
+                                                  writer_type>
+                            sim(generation_opts.ptc_type, generation_opts.events,
+                                det, field, gen_cfg, std::move(writer_cfg), "",
+                                simulation_opts.seed);
+                        sim.get_config().propagation = propagation_opts;
+                        sim.run(simulation_opts.parallel ? n_fitters : 1u,
+                                first_event, last_event);
+                    }
+                    else
+                    {
+                        auto sim = traccc::simulator<const detector_type, b_field_t,
+                                                     bella::generator_type,
+                                                     writer_type>(
+                            generation_opts.ptc_type, generation_opts.events, det,
+                            field, bella::generator_type(gen_cfg),
+                            std::move(writer_cfg), "");
+                        sim.get_config().propagation = propagation_opts;
+                        sim.run();
+                    }
+                }
+                catch (...)
+                {
+                    record_error();
+                }
+                events.close();
+            };
+
+            std::mutex summary_mutex;
+            auto fit_events = [&]()
+            {
+                bella::residual_summary thread_summary(summary.get_config());
+                try
+                {
+                    while (auto evt = events.pop())
+                    {
+                        const bella::event_view evt_view = evt->view();
+
+                        // Truth candidates, or the found ones with the truth
+                        // of their particles
+                        traccc::track_candidate_container_types::host
+                            track_candidates{&host_mr};
+                        std::vector<bella::track_truth> truths;
+                        if (finder)
+                        {
+                            (*finder)(field_view,
+                                      bella::make_hit_frame(evt_view, planes),
+                                      track_candidates, host_mr);
+                            truths = bella::matched_truths(evt_view, track_candidates);
+                        }
+                        else
+                        {
+                            track_candidates = bella::generate_truth_candidates(
+                                det, evt_view, host_mr);
+                            truths = bella::track_truths(evt_view);
+                        }
+
+                        // Run fitting
+                        auto track_states =
+                            batched_fitter
+                                ? (*batched_fitter)(field, track_candidates,
+                                                    host_fitting, host_mr)
+                                : bella::chunked_fit(host_fitting, det, field,
+                                                     track_candidates,
+                                                     fitting_opts.chunk_size,
+                                                     fitting_opts.threads, host_mr);
+
+                        auto records = bella::collect_records(
+                            evt->event_id, det, truths, track_states);
+                        thread_summary.add(records);
+                        consumer.push(evt->event_id, std::move(records));
+                    }
+                }
+                catch (...)
+                {
+                    record_error();
+                }
+
+                std::lock_guard<std::mutex> lock(summary_mutex);
+                summary.merge(thread_summary);
+            };
+
+            std::thread simulation(simulate_events);
+
+            std::vector<std::thread> fitters;
+            for (std::size_t i = 0; i < std::max<std::size_t>(n_fitters, 1u); ++i)
+            {
+                fitters.emplace_back(fit_events);
+            }
+            for (auto &f : fitters)
+            {
+                f.join();
+            }
+            simulation.join();
+
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        };
+
+        if (!scan_opts.enabled())
+        {
+            const auto output_writer = bella::make_record_writer(
+                output_opts.format, shard.suffix(), output_opts.queue_size);
+            bella::residual_summary summary(output_opts.summary);
+            const auto [first_event, last_event] =
+                shard.range(0u, generation_opts.events);
+            run_pipeline(bella::make_generator_config(generation_opts),
+                         first_event, last_event, threading_opts.threads,
+                         *output_writer, summary);
+            output_writer->close();
+
+            summary.report(std::cout);
+            summary.write("residual_summary" + shard.suffix() + ".json");
+        }
+        else
+        {
+            // Run the scan points in parallel, one fitting thread each, sharing
+            // the detector and the field. A shard runs only its block of the
+            // events of all points, and writes no files of the others.
+            const auto points = bella::make_scan_points(scan_opts, generation_opts);
+            const auto ranges =
+                shard.point_ranges(points.size(), generation_opts.events);
+
+            bella::parallel_for(
+                threading_opts.threads, 0u, points.size(),
+                [&](const std::size_t i)
+                {
+                    const auto [first_event, last_event] = ranges[i];
+                    if (first_event == last_event)
+                    {
+                        return;
+                    }
+
+                    auto gen_cfg = bella::make_generator_config(generation_opts);
+                    points[i].apply(gen_cfg);
+
+                    const std::string suffix = "_" + points[i].label + shard.suffix();
+                    const auto output_writer = bella::make_record_writer(
+                        output_opts.format, suffix, output_opts.queue_size);
+                    bella::residual_summary summary(output_opts.summary);
+                    run_pipeline(gen_cfg, first_event, last_event, 1u,
+                                 *output_writer, summary);
+                    output_writer->close();
+
+                    summary.write("residual_summary" + suffix + ".json");
+                });
+        }
+    });
+
+    return EXIT_SUCCESS;
+}
@@ -13,6 +13,7 @@
 #include "traccc/options/output_data.hpp"
 #include "traccc/options/program_options.hpp"
 #include "traccc/options/telescope_detector.hpp"
+#include "traccc/options/threading.hpp"
 #include "traccc/options/track_propagation.hpp"
 #include "traccc/simulation/measurement_smearer.hpp"
 #include "traccc/simulation/simulator.hpp"
@@ -20,16 +21,27 @@
 
 // detray include(s).
 #include "detray/detectors/bfield.hpp"
-#include "detray/geometry/mask.hpp"
-#include "detray/geometry/shapes/rectangle2D.hpp"
 #include "detray/io/frontend/detector_writer.hpp"
-#include "detray/materials/material.hpp"
-#include "detray/navigation/detail/ray.hpp"
-#include "detray/test/utils/detectors/build_telescope_detector.hpp"
-#include "detray/test/utils/simulation/event_generator/track_generators.hpp"
 
 // Local include(s).
+#include "src/async_writer.hpp"
+#include "src/event_loop.hpp"
+#include "src/event_store.hpp"
+#include "src/event_store_options.hpp"
+#include "src/field_model.hpp"
 #include "src/field_options.hpp"
+#include "src/geometry_config.hpp"
+#include "src/memory_writer.hpp"
+#include "src/parallel_simulator.hpp"
+#include "src/scan.hpp"
+#include "src/scan_options.hpp"
+#include "src/shard.hpp"
+#include "src/shard_options.hpp"
+#include "src/simulation_options.hpp"
+#include "src/stage_timing.hpp"
+#include "src/telescope_detector.hpp"
+#include "src/timing_options.hpp"
+#include "src/track_generator.hpp"
 
 // VecMem include(s).
 #include <vecmem/memory/host_memory_resource.hpp>
@@ -37,6 +49,15 @@
 // Boost include(s).
 #include <boost/filesystem.hpp>
 
+// System include(s).
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
 using namespace traccc;
 
 // The main routine
@@ -48,105 +69,55 @@ int main(int argc, char *argv[])
     traccc::opts::output_data output_opts;
     traccc::opts::track_propagation propagation_opts;
     traccc::opts::field_options field_opts;
+    traccc::opts::threading threading_opts;
+    traccc::opts::scan_options scan_opts;
+    traccc::opts::bella_geometry_options geometry_opts;
+    traccc::opts::timing_options timing_opts;
+    traccc::opts::simulation_options simulation_opts;
+    traccc::opts::shard_options shard_opts;
+    traccc::opts::event_store_options store_opts;
     traccc::opts::program_options program_opts{
         "Telescope-Detector Simulation",
-        {generation_opts, output_opts, propagation_opts, field_opts},
+        {generation_opts, output_opts, propagation_opts, field_opts,
+         threading_opts, scan_opts, geometry_opts, timing_opts,
+         simulation_opts, shard_opts, store_opts},
         argc,
         argv};
 
-    // Use deterministic random number generator for testing
-    using uniform_gen_t =
-        detray::detail::random_numbers<scalar,
-                                       std::uniform_real_distribution<scalar>>;
-
+    // A shard simulates its block of the events of all scan points. Only
+    // the parallel simulation can start at any event with the same streams.
+    const bella::shard shard = bella::make_shard(shard_opts);
+    if (shard.enabled() && !simulation_opts.parallel)
+    {
+        throw std::invalid_argument("--shard needs --parallel-simulation");
+    }
+    // Only the parallel simulation draws from the seeded streams
+    if (simulation_opts.seed_given && !simulation_opts.parallel)
+    {
+        throw std::invalid_argument("--seed needs --parallel-simulation");
+    }
     // Memory resource
     vecmem::host_memory_resource host_mr;
 
+    // Time spent per stage, reported at exit with --timing
+    bella::stage_timing timing(timing_opts.active());
+    auto stage_start = bella::stage_timing::clock::now();
+
     /*****************************
      * Build the Bella Detector
      *****************************/
 
-    // Plane alignment direction (Planes are aligned along the x-axis)
-    const vector3 align_axis{1.f, 0.f, 0.f};
-    detray::detail::ray<traccc::default_algebra> pilot_track{
-        {0, 0, 0}, 0, align_axis, -1};
-
-    // Positions of 12 sensitive planes (in mm unit)
-    std::vector<scalar> sensitive_positions{
-        10.f, 20.f, 30.f,    // 3 SCC
-        60.f, 70.f, 80.f,    // 3 SCC
-        180.f, 190.f, 200.f, // 3 SCC
-        230.f, 240.f, 250.f  // 3 SCC
-    };
-
-    // Set sensitive planes material, thickness and its size
-    detray::material<scalar> sensitive_mat = detray::silicon<scalar>();
-    const scalar sensitive_thickness = 1.f * traccc::unit<scalar>::mm;
-    detray::mask<detray::rectangle2D> sensitive_rect{0u,
-                                                     100.f * traccc::unit<scalar>::mm,
-                                                     100.f * traccc::unit<scalar>::mm};
-
-    // Create the telescope geometry with 12 sensitive planes
-    detray::tel_det_config<detray::rectangle2D,
-                           detray::detail::ray<traccc::default_algebra>>
-        tel_cfg{sensitive_rect, pilot_track};
-    tel_cfg.positions(sensitive_positions);
-    tel_cfg.module_material(sensitive_mat);
-    tel_cfg.mat_thickness(sensitive_thickness);
-    tel_cfg.envelope(100.f * traccc::unit<scalar>::mm);
-
-    const auto [det, name_map] = build_telescope_detector(host_mr, tel_cfg);
-
-    // (WIP) Add the Magnet
-
-    // (WIP) Add any structure needed
-
-    // (WIP) Add the attenuator to the telescope geometry
-
-    /*
-    // Set attenuator material and thickness
-    detray::material<scalar> attenuator_mat = detray::iron<scalar>();
-    const scalar attenuator_thickness = 30.f * traccc::unit<scalar>::mm;
-    detray::mask<detray::rectangle2D> attenuator_rect{0u,
-                                                      100.f * traccc::unit<scalar>::mm,
-                                                      100.f * traccc::unit<scalar>::mm};
-    auto &surfaces = det.surfaces();
-    auto &masks = det.mask_store();
-    auto &materials = det.material_store();
-    auto &transforms = det.transform_store();
-    surfaces.push_back({trf_index, mask_link, material_link, volume_idx,
-                        surface_id::e_sensitive},
-                       invalid_src_link);
-    masks.template emplace_back<mask_id>(empty_context{}, m_boundaries,
-                                         mask_volume_link);
-    materials.template emplace_back<material_id>(empty_context{}, m_boundaries,
-                                                 mask_volume_link);
-    transforms.emplace_back(ctx, mod_placement.pos, m_local_z,
-                            m_local_x);
-    */
+    const bella::geometry_config geometry =
+        bella::make_geometry_config(geometry_opts);
+    const auto [det, name_map] = bella::build_detector(host_mr, geometry);
+    timing.add_since("detector", stage_start);
+
+    // Passive material, e.g. the attenuator, is added with --passive
 
     /***************************
      * Run the muon simulation
      ***************************/
 
-    // Origin of particles
-    using generator_type =
-        detray::random_track_generator<traccc::free_track_parameters,
-                                       uniform_gen_t>;
-    generator_type::configuration gen_cfg{};
-    gen_cfg.n_tracks(generation_opts.gen_nparticles);
-    gen_cfg.origin(traccc::point3{generation_opts.vertex[0],
-                                  generation_opts.vertex[1],
-                                  generation_opts.vertex[2]});
-    gen_cfg.origin_stddev(traccc::point3{generation_opts.vertex_stddev[0],
-                                         generation_opts.vertex_stddev[1],
-                                         generation_opts.vertex_stddev[2]});
-    gen_cfg.phi_range(generation_opts.phi_range);
-    gen_cfg.theta_range(generation_opts.theta_range);
-    gen_cfg.mom_range(generation_opts.mom_range);
-    gen_cfg.charge(generation_opts.ptc_type.charge());
-    generator_type generator(gen_cfg);
-
     // Smearing value for measurements (measurement noise)
     traccc::measurement_smearer<traccc::default_algebra> meas_smearer(
         50.f * traccc::unit<scalar>::mm, 50.f * traccc::unit<scalar>::mm);
@@ -155,31 +126,176 @@ int main(int argc, char *argv[])
     using detector_type = decltype(det);
     using writer_type = traccc::smearing_writer<
         traccc::measurement_smearer<traccc::default_algebra>>;
+    using store_writer_type = bella::memory_writer<
+        traccc::measurement_smearer<traccc::default_algebra>,
+        bella::async_writer<bella::truth_event>>;
+
+    // The simulator's stepper is specialized on the B field type
+    stage_start = bella::stage_timing::clock::now();
+    bella::with_field(field_opts, geometry.magnets, [&](const auto &field)
+    {
+        timing.add_since("field", stage_start);
+
+        using b_field_t = std::remove_cvref_t<decltype(field)>;
+
+        // Simulate the events [first_event, last_event) of one generator
+        // configuration with the writer @c sim_writer_t, on @c n_threads
+        // threads with --parallel-simulation
+        auto simulate = [&]<typename sim_writer_t>(
+                            const bella::generator_type::configuration &gen_cfg,
+                            typename sim_writer_t::config writer_cfg,
+                            const std::string &full_path,
+                            const std::size_t first_event,
+                            const std::size_t last_event,
+                            const std::size_t n_threads)
+        {
+            if (simulation_opts.parallel)
+            {
+                bella::parallel_simulator<detector_type, b_field_t, sim_writer_t>
+                    sim(generation_opts.ptc_type, generation_opts.events, det,
+                        field, gen_cfg, std::move(writer_cfg), full_path,
+                        simulation_opts.seed);
+                sim.get_config().propagation = propagation_opts;
+
+                {
+                    // Every event is written out by its thread
+                    bella::scoped_timer timer(timing, "simulation");
+                    sim.run(n_threads, first_event, last_event);
+                }
+                timing.count(last_event - first_event,
+                             (last_event - first_event) *
+                                 generation_opts.gen_nparticles);
+                return;
+            }
 
-    // Writer config
-    typename writer_type::config smearer_writer_cfg{meas_smearer};
+            auto sim = traccc::simulator<detector_type, b_field_t,
+                                         bella::generator_type, sim_writer_t>(
+                generation_opts.ptc_type, generation_opts.events, det, field,
+                bella::generator_type(gen_cfg), std::move(writer_cfg), full_path);
+            sim.get_config().propagation = propagation_opts;
 
-    // Run simulator
-    const std::string full_path = output_opts.directory;
-    boost::filesystem::create_directories(full_path);
+            {
+                // One sample per generator configuration; the simulator
+                // writes every event out as it goes
+                bella::scoped_timer timer(timing, "simulation");
+                sim.run();
+            }
+            timing.count(generation_opts.events,
+                         generation_opts.events * generation_opts.gen_nparticles);
+        };
 
-    // B field value and its type
-    using b_field_t = covfie::field<detray::bfield::inhom_bknd_t>;
-    b_field_t field = detray::io::read_bfield<b_field_t>(field_opts.bfield_file);
+        // Simulate the events [first_event, last_event) of one generator
+        // configuration into a directory, if there are any
+        auto run_simulation = [&](const bella::generator_type::configuration &gen_cfg,
+                                  const std::string &full_path,
+                                  const std::size_t first_event,
+                                  const std::size_t last_event,
+                                  const std::size_t n_threads)
+        {
+            if (first_event == last_event)
+            {
+                return;
+            }
+            boost::filesystem::create_directories(full_path);
 
-    auto sim = traccc::simulator<detector_type, b_field_t, generator_type,
-                                 writer_type>(
-        generation_opts.ptc_type, generation_opts.events, det, field,
-        std::move(generator), std::move(smearer_writer_cfg), full_path);
-    sim.get_config().propagation = propagation_opts;
+            if (store_opts.file.empty())
+            {
+                // csv files per event, written on the simulating threads
+                simulate.template operator()<writer_type>(
+                    gen_cfg, typename writer_type::config{meas_smearer},
+                    full_path, first_event, last_event, n_threads);
+                return;
+            }
 
-    sim.run();
+            // One event store in the directory, e.g. events_shard_3_of_8.bin.
+            // The simulating threads hand their events to a writer thread,
+            // which appends them in event order.
+            const boost::filesystem::path name(store_opts.file);
+            bella::event_store_writer store(
+                (boost::filesystem::path(full_path) /
+                 (name.stem().string() + shard.suffix() +
+                  name.extension().string()))
+                    .string());
+
+            auto append = [&store](bella::truth_event &&evt)
+            { store.add(evt.view()); };
+            bella::ordered_consumer<bella::truth_event, decltype(append)> in_order(
+                first_event, append);
+            bella::async_writer<bella::truth_event> events(
+                store_opts.queue_size, [&in_order](bella::truth_event &&evt)
+                {
+                    const std::size_t event = evt.event_id;
+                    in_order.push(event, std::move(evt));
+                });
+
+            simulate.template operator()<store_writer_type>(
+                gen_cfg,
+                typename store_writer_type::config{
+                    meas_smearer, generation_opts.ptc_type, &events},
+                full_path, first_event, last_event, n_threads);
+
+            bella::scoped_timer timer(timing, "output");
+            events.close();
+            store.close();
+        };
+
+        if (!scan_opts.enabled())
+        {
+            const auto [first_event, last_event] =
+                shard.range(0u, generation_opts.events);
+            run_simulation(bella::make_generator_config(generation_opts),
+                           output_opts.directory, first_event, last_event,
+                           threading_opts.threads);
+        }
+        else
+        {
+            // One sub-directory per scan point, e.g. 0.1_GeV_90_theta/, with the
+            // points simulated in parallel on the same detector and field, or
+            // one after the other with their events in parallel. A shard
+            // runs only its block of the events of all points.
+            const auto points = bella::make_scan_points(scan_opts, generation_opts);
+            const auto ranges =
+                shard.point_ranges(points.size(), generation_opts.events);
+
+            auto run_point = [&](const std::size_t i, const std::size_t n_threads)
+            {
+                auto gen_cfg = bella::make_generator_config(generation_opts);
+                points[i].apply(gen_cfg);
+
+                run_simulation(gen_cfg,
+                               output_opts.directory + "/" + points[i].label + "/",
+                               ranges[i].first, ranges[i].second, n_threads);
+            };
+
+            if (simulation_opts.parallel)
+            {
+                for (std::size_t i = 0; i < points.size(); ++i)
+                {
+                    run_point(i, threading_opts.threads);
+                }
+            }
+            else
+            {
+                bella::parallel_for(threading_opts.threads, 0u, points.size(),
+                                    [&](const std::size_t i) { run_point(i, 1u); });
+            }
+        }
+    });
 
     // Create detector file
-    auto writer_cfg = detray::io::detector_writer_config{}
-                          .format(detray::io::format::json)
-                          .replace_files(true);
-    detray::io::write_detector(det, name_map, writer_cfg);
+    {
+        bella::scoped_timer timer(timing, "output");
+        auto writer_cfg = detray::io::detector_writer_config{}
+                              .format(detray::io::format::json)
+                              .replace_files(true);
+        detray::io::write_detector(det, name_map, writer_cfg);
+    }
+
+    timing.report(std::cout);
+    if (!timing_opts.output.empty())
+    {
+        timing.dump(timing_opts.output);
+    }
 
-    return 1;
+    return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -0,0 +1,187 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+// Project include(s).
+#include "traccc/definitions/common.hpp"
+#include "traccc/definitions/primitives.hpp"
+#include "traccc/definitions/track_parametrization.hpp"
+#include "traccc/fitting/fitting_algorithm.hpp"
+#include "traccc/fitting/kalman_filter/kalman_fitter.hpp"
+#include "traccc/simulation/measurement_smearer.hpp"
+#include "traccc/simulation/simulator.hpp"
+
+// detray include(s).
+#include "detray/definitions/pdg_particle.hpp"
+#include "detray/navigation/navigator.hpp"
+
+// Local include(s).
+#include "src/batched_kalman_fitter.hpp"
+#include "src/bounded_queue.hpp"
+#include "src/event_store.hpp"
+#include "src/gap_stepper.hpp"
+#include "src/geometry_config.hpp"
+#include "src/magnet_field.hpp"
+#include "src/memory_writer.hpp"
+#include "src/telescope_detector.hpp"
+#include "src/track_generator.hpp"
+
+// VecMem include(s).
+#include <vecmem/memory/host_memory_resource.hpp>
+
+// System include(s).
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+// Fit the same simulated events with the scalar traccc fitter and with the
+// batched fitter, and check that the fitted parameters and their errors
+// agree. The tracks/s of both fits are printed, not checked, as they depend
+// on the machine.
+//
+int main()
+{
+    using traccc::scalar;
+    using unit = traccc::unit<scalar>;
+    using detector_type = bella::host_detector_type;
+    using fitter_type =
+        traccc::kalman_fitter<bella::stepper_type<bella::magnet_field>,
+                              detray::navigator<const detector_type>>;
+
+    const bella::geometry_config geometry;
+    vecmem::host_memory_resource host_mr;
+    const auto [det, names] = bella::build_detector(host_mr, geometry);
+    const bella::magnet_field field(geometry.magnets, 10.f);
+
+    // 500 MeV muons around the beam, bent by the magnets
+    const detray::pdg_particle<scalar> ptc_type = detray::muon<scalar>();
+    const std::size_t n_events = 10u;
+    const std::size_t n_muons = 100u;
+
+    bella::generator_type::configuration gen_cfg{};
+    gen_cfg.n_tracks(n_muons);
+    gen_cfg.origin(traccc::point3{0.f, 0.f, 0.f});
+    gen_cfg.phi_range(-2.f * unit::degree, 2.f * unit::degree);
+    gen_cfg.theta_range(88.f * unit::degree, 92.f * unit::degree);
+    gen_cfg.mom_range(0.5f * unit::GeV, 0.5f * unit::GeV);
+    gen_cfg.charge(ptc_type.charge());
+
+    using smearer_type = traccc::measurement_smearer<traccc::default_algebra>;
+    using writer_type = bella::memory_writer<smearer_type>;
+
+    bella::bounded_queue<bella::truth_event> queue(n_events + 1u);
+    typename writer_type::config writer_cfg{
+        smearer_type(50.f * unit::mm, 50.f * unit::mm), ptc_type, &queue};
+
+    auto sim = traccc::simulator<const detector_type, bella::magnet_field,
+                                 bella::generator_type, writer_type>(
+        ptc_type, n_events, det, field, bella::generator_type(gen_cfg),
+        std::move(writer_cfg), "");
+    sim.run();
+    queue.close();
+
+    std::vector<traccc::track_candidate_container_types::host> candidates;
+    while (auto evt = queue.pop())
+    {
+        candidates.push_back(
+            bella::generate_truth_candidates(det, evt->view(), host_mr));
+    }
+
+    const traccc::fitting_algorithm<fitter_type> scalar_fitting(
+        typename traccc::fitting_algorithm<fitter_type>::config_type{});
+    const bella::batched_kalman_fitter batched_fitting(det);
+
+    // Both fits of every event, timed
+    using clock = std::chrono::steady_clock;
+    std::vector<traccc::track_state_container_types::host> scalar_states;
+    std::vector<traccc::track_state_container_types::host> batched_states;
+    std::size_t n_tracks = 0u;
+
+    const auto scalar_start = clock::now();
+    for (const auto &cands : candidates)
+    {
+        scalar_states.push_back(scalar_fitting(det, field, cands));
+        n_tracks += cands.size();
+    }
+    const std::chrono::duration<double> scalar_time = clock::now() - scalar_start;
+
+    const auto batched_start = clock::now();
+    for (const auto &cands : candidates)
+    {
+        batched_states.push_back(
+            batched_fitting(field, cands, scalar_fitting, host_mr));
+    }
+    const std::chrono::duration<double> batched_time =
+        clock::now() - batched_start;
+
+    // Difference of the fitted parameters in units of the scalar error, and
+    // the ratio of the errors
+    const std::array<unsigned int, 5> params{
+        traccc::e_bound_loc0, traccc::e_bound_loc1, traccc::e_bound_phi,
+        traccc::e_bound_theta, traccc::e_bound_qoverp};
+    const std::array<const char *, 5> param_names{"loc0", "loc1", "phi",
+                                                  "theta", "qop"};
+    std::array<double, 5> sum_pull2{};
+    std::array<double, 5> sum_error_ratio{};
+    std::size_t n_compared = 0u;
+
+    for (std::size_t e = 0; e < candidates.size(); ++e)
+    {
+        for (std::size_t i = 0; i < candidates[e].size(); ++i)
+        {
+            const auto &ref = scalar_states[e].at(i).header.fit_params;
+            const auto &test = batched_states[e].at(i).header.fit_params;
+            for (std::size_t p = 0; p < params.size(); ++p)
+            {
+                const unsigned int k = params[p];
+                const double ref_error = std::sqrt(
+                    traccc::getter::element(ref.covariance(), k, k));
+                const double test_error = std::sqrt(
+                    traccc::getter::element(test.covariance(), k, k));
+                const double diff =
+                    traccc::getter::element(test.vector(), k, 0u) -
+                    traccc::getter::element(ref.vector(), k, 0u);
+                sum_pull2[p] += diff * diff / (ref_error * ref_error);
+                sum_error_ratio[p] += test_error / ref_error;
+            }
+            ++n_compared;
+        }
+    }
+
+    bool passed = n_compared == n_events * n_muons;
+    std::cout << n_compared << " tracks fitted by both fitters" << std::endl;
+    std::cout << std::left << std::setw(8) << "" << std::right << std::setw(18)
+              << "rms diff / error" << std::setw(14) << "error ratio"
+              << std::endl;
+    for (std::size_t p = 0; p < params.size() && n_compared > 0u; ++p)
+    {
+        const double n = static_cast<double>(n_compared);
+        const double rms = std::sqrt(sum_pull2[p] / n);
+        const double ratio = sum_error_ratio[p] / n;
+        const bool ok = rms <= 0.2 && ratio >= 0.8 && ratio <= 1.25;
+        passed = passed && ok;
+        std::cout << std::left << std::setw(8) << param_names[p] << std::right
+                  << std::fixed << std::setprecision(4) << std::setw(18) << rms
+                  << std::setw(14) << ratio << (ok ? "" : "  DIFFERENT")
+                  << std::defaultfloat << std::endl;
+    }
+
+    const double tracks = static_cast<double>(n_tracks);
+    std::cout << "Scalar fit: " << tracks / scalar_time.count()
+              << " tracks/s, batched fit: " << tracks / batched_time.count()
+              << " tracks/s" << std::endl;
+
+    std::cout << (passed ? "PASSED" : "FAILED") << ": batched against scalar fit"
+              << std::endl;
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,135 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+// Project include(s).
+#include "traccc/definitions/common.hpp"
+#include "traccc/definitions/primitives.hpp"
+#include "traccc/simulation/measurement_smearer.hpp"
+#include "traccc/simulation/simulator.hpp"
+
+// detray include(s).
+#include "detray/definitions/pdg_particle.hpp"
+
+// Local include(s).
+#include "src/bounded_queue.hpp"
+#include "src/event_store.hpp"
+#include "src/geometry_config.hpp"
+#include "src/magnet_field.hpp"
+#include "src/memory_writer.hpp"
+#include "src/telescope_detector.hpp"
+#include "src/telescope_metadata.hpp"
+#include "src/track_generator.hpp"
+
+// VecMem include(s).
+#include <vecmem/memory/host_memory_resource.hpp>
+
+// System include(s).
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+
+// Simulate muons through the telescope with an iron slab between the
+// sensitive planes, and check that the slab is passive in the detector and
+// in the surface lookup of the navigator, and gets no measurements
+//
+int main()
+{
+    using traccc::scalar;
+
+    bella::geometry_config geometry;
+    geometry.passive_slabs.push_back({120.f, "iron", 30.f});
+
+    vecmem::host_memory_resource host_mr;
+    const auto [det, names] = bella::build_detector(host_mr, geometry);
+
+    // One passive surface in both copies of the surface descriptors
+    std::size_t n_passive = 0u;
+    for (const auto &sf : det.surfaces())
+    {
+        n_passive += sf.is_passive() ? 1u : 0u;
+    }
+    std::size_t n_lookup_passive = 0u;
+    for (const auto &sf : det.accelerator_store()
+                              .template get<bella::telescope_metadata::accel_ids::
+                                                e_brute_force>()
+                              .all())
+    {
+        n_lookup_passive += sf.is_passive() ? 1u : 0u;
+    }
+    std::cout << "Passive surfaces: " << n_passive << " in the detector, "
+              << n_lookup_passive << " in the surface lookup" << std::endl;
+    bool passed = n_passive == 1u && n_lookup_passive == 1u;
+
+    // 1 GeV muons along the beam cross every plane and the slab
+    const detray::pdg_particle<scalar> ptc_type = detray::muon<scalar>();
+    const std::size_t n_events = 5u;
+    const std::size_t n_muons = 100u;
+
+    bella::generator_type::configuration gen_cfg{};
+    gen_cfg.n_tracks(n_muons);
+    gen_cfg.origin(traccc::point3{0.f, 0.f, 0.f});
+    gen_cfg.phi_range(0.f, 0.f);
+    gen_cfg.theta_range(90.f * traccc::unit<scalar>::degree,
+                        90.f * traccc::unit<scalar>::degree);
+    gen_cfg.mom_range(1.f * traccc::unit<scalar>::GeV,
+                      1.f * traccc::unit<scalar>::GeV);
+    gen_cfg.charge(ptc_type.charge());
+
+    using smearer_type = traccc::measurement_smearer<traccc::default_algebra>;
+    using writer_type = bella::memory_writer<smearer_type>;
+
+    bella::bounded_queue<bella::truth_event> queue(n_events + 1u);
+    typename writer_type::config writer_cfg{
+        smearer_type(50.f * traccc::unit<scalar>::mm,
+                     50.f * traccc::unit<scalar>::mm),
+        ptc_type, &queue};
+
+    const bella::magnet_field field(geometry.magnets, 10.f);
+    auto sim = traccc::simulator<const bella::host_detector_type,
+                                 bella::magnet_field, bella::generator_type,
+                                 writer_type>(
+        ptc_type, n_events, det, field, bella::generator_type(gen_cfg),
+        std::move(writer_cfg), "");
+    sim.run();
+    queue.close();
+
+    // Every measurement on a sensitive plane, none at the slab
+    const scalar slab_x = geometry.passive_slabs[0].position;
+    std::size_t n_measurements = 0u;
+    std::size_t n_on_passive = 0u;
+    std::size_t n_at_slab = 0u;
+    while (auto evt = queue.pop())
+    {
+        for (std::size_t i = 0u; i < evt->measurements.size(); ++i)
+        {
+            ++n_measurements;
+            if (!det.surface(evt->measurements[i].surface_link).is_sensitive())
+            {
+                ++n_on_passive;
+            }
+            if (detray::math::fabs(evt->truths[i].position[0] - slab_x) <
+                1.f * traccc::unit<scalar>::mm)
+            {
+                ++n_at_slab;
+            }
+        }
+    }
+    std::cout << "Measurements: " << n_measurements << ", "
+              << n_on_passive << " on passive surfaces, " << n_at_slab
+              << " at the slab" << std::endl;
+
+    const std::size_t expected =
+        n_events * n_muons * geometry.plane_positions.size();
+    passed = passed && n_on_passive == 0u && n_at_slab == 0u &&
+             n_measurements == expected;
+
+    std::cout << (passed ? "PASSED" : "FAILED") << ": "
+              << expected << " measurements expected" << std::endl;
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
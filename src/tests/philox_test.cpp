@@ -0,0 +1,63 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+// Local include(s).
+#include "src/philox.hpp"
+
+// System include(s).
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <ios>
+#include <iostream>
+
+// Check the Philox4x32-10 block function against the known-answer vectors
+// of Random123 (kat_vectors, philox4x32 10)
+//
+int main()
+{
+    struct known_answer
+    {
+        std::array<std::uint32_t, 4> ctr;
+        std::array<std::uint32_t, 2> key;
+        std::array<std::uint32_t, 4> expected;
+    };
+
+    const std::array<known_answer, 3> vectors{{
+        {{0x00000000u, 0x00000000u, 0x00000000u, 0x00000000u},
+         {0x00000000u, 0x00000000u},
+         {0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u}},
+        {{0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu},
+         {0xffffffffu, 0xffffffffu},
+         {0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu}},
+        {{0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u},
+         {0xa4093822u, 0x299f31d0u},
+         {0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u}},
+    }};
+
+    bool passed = true;
+    for (std::size_t i = 0; i < vectors.size(); ++i)
+    {
+        const known_answer &v = vectors[i];
+        const std::array<std::uint32_t, 4> result = bella::philox4x32(v.ctr, v.key);
+        const bool ok = result == v.expected;
+        passed = passed && ok;
+
+        std::cout << "vector " << i << ":" << std::hex;
+        for (const std::uint32_t word : result)
+        {
+            std::cout << " " << word;
+        }
+        std::cout << std::dec << (ok ? "" : "  WRONG") << std::endl;
+    }
+
+    std::cout << (passed ? "PASSED" : "FAILED")
+              << ": Philox4x32-10 known answers" << std::endl;
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
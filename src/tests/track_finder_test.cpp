@@ -0,0 +1,200 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+// Project include(s).
+#include "traccc/definitions/common.hpp"
+#include "traccc/definitions/primitives.hpp"
+#include "traccc/simulation/measurement_smearer.hpp"
+#include "traccc/simulation/simulator.hpp"
+
+// detray include(s).
+#include "detray/definitions/pdg_particle.hpp"
+
+// Local include(s).
+#include "src/bounded_queue.hpp"
+#include "src/event_store.hpp"
+#include "src/geometry_config.hpp"
+#include "src/magnet_field.hpp"
+#include "src/memory_writer.hpp"
+#include "src/telescope_detector.hpp"
+#include "src/telescope_planes.hpp"
+#include "src/track_finder.hpp"
+#include "src/track_generator.hpp"
+
+// VecMem include(s).
+#include <vecmem/memory/host_memory_resource.hpp>
+
+// System include(s).
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <utility>
+#include <vector>
+
+// Find the tracks of simulated multi-track events, with the magnets and
+// without field, and check the efficiency and the purity of the found
+// tracks against the particle of matched_truths. Without field, every seed
+// must carry the fallback momentum of the finder.
+//
+int main()
+{
+    using traccc::scalar;
+    using unit = traccc::unit<scalar>;
+    using detector_type = bella::host_detector_type;
+
+    const bella::geometry_config geometry;
+    vecmem::host_memory_resource host_mr;
+    const auto [det, names] = bella::build_detector(host_mr, geometry);
+    const std::vector<bella::sensitive_plane> planes =
+        bella::sensitive_planes(det);
+
+    // Muons of 0.3 to 1 GeV around the beam, 20 per event
+    const detray::pdg_particle<scalar> ptc_type = detray::muon<scalar>();
+    const std::size_t n_events = 10u;
+    const std::size_t n_muons = 20u;
+
+    bella::generator_type::configuration gen_cfg{};
+    gen_cfg.n_tracks(n_muons);
+    gen_cfg.origin(traccc::point3{0.f, 0.f, 0.f});
+    gen_cfg.phi_range(-2.f * unit::degree, 2.f * unit::degree);
+    gen_cfg.theta_range(88.f * unit::degree, 92.f * unit::degree);
+    gen_cfg.mom_range(0.3f * unit::GeV, 1.f * unit::GeV);
+    gen_cfg.charge(ptc_type.charge());
+
+    using smearer_type = traccc::measurement_smearer<traccc::default_algebra>;
+    using writer_type = bella::memory_writer<smearer_type>;
+
+    const bella::track_finder_config finder_cfg{};
+    const bella::track_finder finder(det, finder_cfg);
+
+    struct field_case
+    {
+        const char *name;
+        bella::magnet_field field;
+    };
+    const std::vector<field_case> cases{
+        {"magnets", bella::magnet_field(geometry.magnets, 10.f)},
+        {"no field", bella::magnet_field({}, 10.f)}};
+
+    bool passed = true;
+    for (const field_case &fc : cases)
+    {
+        bella::bounded_queue<bella::truth_event> queue(n_events + 1u);
+        typename writer_type::config writer_cfg{
+            smearer_type(50.f * unit::um, 50.f * unit::um), ptc_type, &queue};
+
+        auto sim = traccc::simulator<const detector_type, bella::magnet_field,
+                                     bella::generator_type, writer_type>(
+            ptc_type, n_events, det, fc.field, bella::generator_type(gen_cfg),
+            std::move(writer_cfg), "");
+        sim.run();
+        queue.close();
+
+        const bella::magnet_field::view_t field_view(fc.field);
+        const scalar fallback_qop =
+            ptc_type.charge() / (finder_cfg.fallback_momentum * unit::GeV);
+
+        std::size_t n_findable = 0u;
+        std::size_t n_found = 0u;
+        std::size_t n_tracks = 0u;
+        std::size_t n_truth_mismatch = 0u;
+        std::size_t n_bad_seeds = 0u;
+        double sum_purity = 0.;
+
+        while (auto evt = queue.pop())
+        {
+            const bella::event_view evt_view = evt->view();
+
+            traccc::track_candidate_container_types::host candidates{&host_mr};
+            finder(field_view, bella::make_hit_frame(evt_view, planes),
+                   candidates, host_mr);
+            const std::vector<bella::track_truth> truths =
+                bella::matched_truths(evt_view, candidates);
+
+            // Particle giving most measurements to every track, and the
+            // fraction it gives
+            std::set<std::size_t> found;
+            for (std::size_t t = 0; t < candidates.size(); ++t)
+            {
+                std::vector<std::size_t> counts(evt_view.particles.size(), 0u);
+                const auto &items = candidates.at(t).items;
+                for (const auto &meas : items)
+                {
+                    const auto it = std::upper_bound(
+                        evt_view.measurement_offsets.begin(),
+                        evt_view.measurement_offsets.end(), meas.measurement_id);
+                    ++counts[static_cast<std::size_t>(
+                        it - evt_view.measurement_offsets.begin() - 1)];
+                }
+                const std::size_t ptc = static_cast<std::size_t>(
+                    std::max_element(counts.begin(), counts.end()) -
+                    counts.begin());
+                const double purity = static_cast<double>(counts[ptc]) /
+                                      static_cast<double>(items.size());
+                sum_purity += purity;
+                if (purity > 0.5)
+                {
+                    found.insert(ptc);
+                }
+
+                // matched_truths names the same particle
+                const traccc::vector3 &p =
+                    evt_view.truths[evt_view.measurement_offsets[ptc]].momentum;
+                if (truths[t].momentum[0] != p[0] ||
+                    truths[t].momentum[1] != p[1] ||
+                    truths[t].momentum[2] != p[2])
+                {
+                    ++n_truth_mismatch;
+                }
+
+                // A finite seed momentum, the fallback one without field
+                const scalar qop = candidates.at(t).header.qop();
+                if (!std::isfinite(qop) || qop == 0.f ||
+                    (fc.field.magnets().empty() &&
+                     std::abs(qop - fallback_qop) > 1e-6f * std::abs(fallback_qop)))
+                {
+                    ++n_bad_seeds;
+                }
+            }
+            n_tracks += candidates.size();
+
+            for (std::size_t i = 0; i < evt_view.particles.size(); ++i)
+            {
+                if (evt_view.particle_measurements(i).size() >=
+                    finder_cfg.min_measurements)
+                {
+                    ++n_findable;
+                    n_found += found.count(i);
+                }
+            }
+        }
+
+        const double efficiency =
+            n_findable > 0u ? static_cast<double>(n_found) /
+                                  static_cast<double>(n_findable)
+                            : 0.;
+        const double purity =
+            n_tracks > 0u ? sum_purity / static_cast<double>(n_tracks) : 0.;
+        const bool ok = efficiency >= 0.9 && purity >= 0.95 &&
+                        n_truth_mismatch == 0u && n_bad_seeds == 0u;
+        passed = passed && ok;
+
+        std::cout << fc.name << ": " << n_tracks << " tracks, efficiency "
+                  << efficiency << " (" << n_found << "/" << n_findable
+                  << "), purity " << purity << ", " << n_truth_mismatch
+                  << " truth mismatches, " << n_bad_seeds << " bad seeds"
+                  << (ok ? "" : "  WRONG") << std::endl;
+    }
+
+    std::cout << (passed ? "PASSED" : "FAILED")
+              << ": track finding in simulated events" << std::endl;
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
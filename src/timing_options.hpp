@@ -0,0 +1,51 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Local include(s).
+#include "traccc/options/details/interface.hpp"
+
+// System include(s).
+#include <string>
+
+namespace traccc::opts
+{
+
+    /// Convenience namespace shorthand
+    namespace po = boost::program_options;
+
+    /// Command line options of the stage timing
+    class timing_options : public interface
+    {
+
+    public:
+        /// Constructor
+        timing_options() : interface("BELLA Timing Options")
+        {
+
+            m_desc.add_options()("timing",
+                                 po::bool_switch(&(enabled))
+                                     ->default_value(false),
+                                 "Time the stages and report the totals, "
+                                 "percentiles and rates at exit");
+            m_desc.add_options()("timing-output",
+                                 po::value(&(output))
+                                     ->default_value(""),
+                                 "JSON file the timing report is also "
+                                 "written to (implies --timing)");
+        }
+
+        /// Whether the stages are timed
+        bool active() const { return enabled || !output.empty(); }
+
+        bool enabled;
+        std::string output;
+
+    }; // class timing_options
+
+} // namespace traccc::opts
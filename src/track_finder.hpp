@@ -0,0 +1,959 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Project include(s).
+#include "traccc/definitions/common.hpp"
+#include "traccc/definitions/primitives.hpp"
+#include "traccc/edm/measurement.hpp"
+#include "traccc/edm/track_candidate.hpp"
+
+// detray include(s).
+#include "detray/definitions/pdg_particle.hpp"
+#include "detray/geometry/barcode.hpp"
+#include "detray/geometry/tracking_surface.hpp"
+
+// Local include(s).
+#include "src/batched_kalman_fitter.hpp"
+#include "src/event_store.hpp"
+#include "src/frame_seeding.hpp"
+#include "src/raw_frame.hpp"
+#include "src/telescope_metadata.hpp"
+#include "src/telescope_planes.hpp"
+#include "src/track_finding_options.hpp"
+#include "src/truth_fitting.hpp"
+
+// VecMem include(s).
+#include <vecmem/containers/vector.hpp>
+#include <vecmem/memory/memory_resource.hpp>
+
+// System include(s).
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace bella
+{
+
+    /// Configuration of the track finder
+    struct track_finder_config
+    {
+        /// Sensitive planes of the triplet seeds, in ascending x. The planes
+        /// between them are not searched.
+        std::array<std::size_t, 3> seed_planes{0u, 1u, 2u};
+        /// Maximum |dy/dx| and |dz/dx| of a seed
+        traccc::scalar max_slope = 0.1f;
+        /// Maximum distance of the third seed hit from the line through the
+        /// first two, on top of the measurement errors [mm]
+        traccc::scalar triplet_tolerance = 0.5f;
+        /// Number of measurement standard deviations added to the search
+        /// windows
+        traccc::scalar window_sigmas = 3.f;
+        /// Lowest momentum searched for, which sets the qop uncertainty of
+        /// the seeds and rejects the branches bending more [GeV]
+        traccc::scalar min_momentum = 0.05f;
+        /// Momentum of the scattering while qop is not yet measured [GeV]
+        traccc::scalar scattering_momentum = 1.f;
+        /// Maximum chi2 of a measurement on a track (2 degrees of freedom)
+        traccc::scalar chi2_max = 15.f;
+        /// Maximum number of branches of a seed kept after every plane
+        std::size_t max_branches = 4u;
+        /// Maximum number of sensitive planes without a measurement
+        std::size_t max_holes = 1u;
+        /// Minimum number of measurements of a track
+        std::size_t min_measurements = 6u;
+        /// Maximum number of measurements a track shares with better ones
+        std::size_t max_shared = 0u;
+        /// Bin size of the measurement grids of the planes [mm]
+        traccc::scalar bin_size = 1.f;
+        /// Maximum RK4 step in the field [mm]
+        traccc::scalar max_step = 2.f;
+        /// Particle hypothesis of the scattering and of the seed charge
+        detray::pdg_particle<traccc::scalar> ptc_type =
+            detray::muon<traccc::scalar>();
+        /// Standard deviations of the direction and the relative qop of the
+        /// seeds handed to the fitter
+        traccc::scalar angle_stddev = 0.01f;
+        traccc::scalar qop_rel_stddev = 0.3f;
+        /// Seed momentum of the tracks whose qop the field did not measure,
+        /// as in the frame seeding [GeV]
+        traccc::scalar fallback_momentum = 0.1f;
+        traccc::scalar fallback_qop_rel_stddev = 1.f;
+        /// Fraction of the initial qop error above which the qop of a track
+        /// counts as not measured
+        traccc::scalar unmeasured_qop_error = 0.5f;
+    };
+
+    /// Track finding in the BELLA telescope, without truth
+    ///
+    /// Seeds are triplets of measurements on the three seed planes, a
+    /// doublet within @c max_slope and a third measurement near its line,
+    /// as the seed planes are in front of the magnets. Every seed is then
+    /// followed plane by plane in ascending x with a combinatorial Kalman
+    /// filter, as in the traccc CKF: the state is transported to the next
+    /// plane (RK4 in the field, straight lines elsewhere), every measurement
+    /// within @c chi2_max of the prediction opens a branch, a plane without
+    /// one is a hole, and only the @c max_branches best branches of the seed
+    /// are kept. The qop of the seed is unknown, with the uncertainty of
+    /// @c min_momentum, and is measured by the first planes behind a magnet;
+    /// branches bending more than that momentum allows are dropped.
+    ///
+    /// The planes are ordered in x and only the next plane is searched, so
+    /// a branch only looks at the measurements of its prediction window,
+    /// found in a grid of @c bin_size bins per plane. The work per track is
+    /// then bounded by the branch limit and the occupancy of its windows,
+    /// and grows with the number of tracks only as the windows fill up.
+    /// The best branch of every seed becomes a track; tracks sharing more
+    /// than @c max_shared measurements with longer or better ones are
+    /// dropped.
+    class track_finder
+    {
+
+    public:
+        /// Constructor
+        ///
+        /// @param det Telescope the tracks are found in
+        /// @param cfg Finder configuration
+        explicit track_finder(const host_detector_type &det,
+                              const track_finder_config &cfg = {})
+            : m_cfg(cfg),
+              m_qop_max(std::abs(cfg.ptc_type.charge()) /
+                        (cfg.min_momentum * traccc::unit<traccc::scalar>::GeV))
+        {
+            using traccc::scalar;
+
+            const traccc::vector3 beam{1.f, 0.f, 0.f};
+            const auto &slabs = det.material_store().template get<
+                host_detector_type::materials::id::e_slab>();
+
+            for (const auto &desc : det.surfaces())
+            {
+                if (!desc.is_sensitive() && !desc.is_passive())
+                {
+                    continue;
+                }
+
+                const detray::tracking_surface sf{det, desc.barcode()};
+                const auto origin = sf.bound_to_global({}, {0.f, 0.f}, beam);
+                const auto u = sf.bound_to_global({}, {1.f, 0.f}, beam) - origin;
+                const auto v = sf.bound_to_global({}, {0.f, 1.f}, beam) - origin;
+
+                const auto &slab = slabs.at(desc.material().index());
+
+                layer l;
+                l.barcode = desc.barcode();
+                l.sensitive = desc.is_sensitive();
+                l.x = origin[0];
+                l.origin = {origin[1], origin[2]};
+                l.u = {u[1], u[2]};
+                l.v = {v[1], v[2]};
+                l.thickness = slab.thickness();
+                l.X0 = slab.get_material().X0();
+                m_layers.push_back(l);
+            }
+
+            std::sort(m_layers.begin(), m_layers.end(),
+                      [](const layer &a, const layer &b) { return a.x < b.x; });
+
+            for (std::size_t i = 0; i < m_layers.size(); ++i)
+            {
+                if (m_layers[i].sensitive)
+                {
+                    m_layers[i].plane = m_sensitive.size();
+                    m_sensitive.push_back(i);
+                }
+            }
+
+            for (std::size_t k = 0; k < 3u; ++k)
+            {
+                if (m_cfg.seed_planes[k] >= m_sensitive.size() ||
+                    (k > 0u && m_cfg.seed_planes[k] <= m_cfg.seed_planes[k - 1u]))
+                {
+                    throw std::invalid_argument(
+                        "The seed planes are not three ascending telescope planes");
+                }
+            }
+        }
+
+        /// Find the tracks of @c frame and add them to @c candidates
+        ///
+        /// @param field      Field view of the stepper
+        /// @param frame      Measurements of the frame, one group per plane
+        /// @param candidates Track candidates the tracks are added to
+        /// @param mr         Memory resource of the candidates
+        /// @return the number of tracks found
+        template <typename field_view_t>
+        std::size_t operator()(
+            const field_view_t &field, const hit_frame &frame,
+            traccc::track_candidate_container_types::host &candidates,
+            vecmem::memory_resource &mr) const
+        {
+            if (frame.n_planes() != m_sensitive.size())
+            {
+                throw std::invalid_argument(
+                    "The frame does not match the telescope planes");
+            }
+
+            // Measurements in the telescope frame, binned on every plane
+            std::vector<std::vector<hit>> hits(m_sensitive.size());
+            std::vector<hit_grid> grids(m_sensitive.size());
+            std::vector<scalar> max_sigma(m_sensitive.size(), 0.f);
+            for (std::size_t p = 0; p < m_sensitive.size(); ++p)
+            {
+                const layer &l = m_layers[m_sensitive[p]];
+                const auto measurements = frame.plane_measurements(p);
+                hits[p].reserve(measurements.size());
+                for (std::size_t i = 0; i < measurements.size(); ++i)
+                {
+                    const hit &h = hits[p].emplace_back(
+                        make_hit(l, measurements[i], frame.plane_offsets[p] + i));
+                    max_sigma[p] = std::max(
+                        max_sigma[p], std::sqrt(std::max(h.vyy, h.vzz)));
+                }
+                grids[p].build(hits[p], m_cfg.bin_size * traccc::unit<traccc::scalar>::mm);
+            }
+
+            // Best branch of every seed
+            std::vector<branch> tracks;
+            for_each_seed(hits, grids, max_sigma,
+                          [&](const std::array<const hit *, 3> &seed)
+                          {
+                              branch best =
+                                  follow(field, hits, grids, max_sigma, seed);
+                              if (best.hits.size() >= m_cfg.min_measurements)
+                              {
+                                  tracks.push_back(std::move(best));
+                              }
+                          });
+
+            // Longest and best tracks first, each measurement used once
+            std::sort(tracks.begin(), tracks.end(), better);
+            std::vector<bool> used(frame.measurements.size(), false);
+
+            std::size_t n_found = 0u;
+            for (const branch &trk : tracks)
+            {
+                std::size_t n_shared = 0u;
+                for (const hit *h : trk.hits)
+                {
+                    n_shared += used[h->index] ? 1u : 0u;
+                }
+                if (n_shared > m_cfg.max_shared)
+                {
+                    continue;
+                }
+                for (const hit *h : trk.hits)
+                {
+                    used[h->index] = true;
+                }
+
+                vecmem::vector<traccc::track_candidate> measurements(&mr);
+                measurements.reserve(trk.hits.size());
+                for (const hit *h : trk.hits)
+                {
+                    measurements.push_back(frame.measurements[h->index]);
+                }
+
+                const detail::vec3 dir = detail::unit_vector(
+                    {1.f, trk.seed_slope[0], trk.seed_slope[1]});
+
+                // A track crossing no field keeps the qop of its seed, 0 with
+                // the error of min_momentum, which is no seed for the fitter
+                traccc::scalar qop = trk.s[e_qop];
+                traccc::scalar qop_stddev_rel = m_cfg.qop_rel_stddev;
+                if (!(std::sqrt(trk.C[e_qop][e_qop]) <
+                      m_cfg.unmeasured_qop_error * m_qop_max))
+                {
+                    qop = m_cfg.ptc_type.charge() /
+                          (m_cfg.fallback_momentum * traccc::unit<scalar>::GeV);
+                    qop_stddev_rel = m_cfg.fallback_qop_rel_stddev;
+                }
+                const traccc::bound_track_parameters seed =
+                    make_seed(measurements[0], dir, qop, m_cfg.angle_stddev,
+                              qop_stddev_rel * std::abs(qop));
+                candidates.push_back(seed, std::move(measurements));
+                ++n_found;
+            }
+
+            return n_found;
+        }
+
+    private:
+        using scalar = traccc::scalar;
+        using vector5 = std::array<scalar, 5>;
+        using matrix5 = std::array<std::array<scalar, 5>, 5>;
+
+        /// Indices of the telescope frame parameters
+        enum parameter : unsigned int
+        {
+            e_y = 0u,
+            e_z = 1u,
+            e_ty = 2u,
+            e_tz = 3u,
+            e_qop = 4u,
+        };
+
+        /// A sensitive or passive plane
+        struct layer
+        {
+            detray::geometry::barcode barcode;
+            bool sensitive;
+            /// Index among the sensitive planes
+            std::size_t plane = 0u;
+            scalar x;
+            std::array<scalar, 2> origin;
+            std::array<scalar, 2> u;
+            std::array<scalar, 2> v;
+            scalar thickness;
+            scalar X0;
+        };
+
+        /// A measurement in the telescope frame
+        struct hit
+        {
+            scalar y;
+            scalar z;
+            /// Covariance of (y, z)
+            scalar vyy;
+            scalar vyz;
+            scalar vzz;
+            /// Index in the measurements of the frame
+            std::size_t index;
+        };
+
+        /// Measurements of one plane, sorted into square bins
+        class hit_grid
+        {
+
+        public:
+            void build(const std::vector<hit> &hits, const scalar bin_size)
+            {
+                m_bin = bin_size;
+                m_order.clear();
+                m_offsets.assign(1u, 0u);
+                if (hits.empty())
+                {
+                    m_ny = m_nz = 0u;
+                    return;
+                }
+
+                m_y0 = m_z0 = std::numeric_limits<scalar>::max();
+                scalar y1 = std::numeric_limits<scalar>::lowest();
+                scalar z1 = std::numeric_limits<scalar>::lowest();
+                for (const hit &h : hits)
+                {
+                    m_y0 = std::min(m_y0, h.y);
+                    m_z0 = std::min(m_z0, h.z);
+                    y1 = std::max(y1, h.y);
+                    z1 = std::max(z1, h.z);
+                }
+                m_ny = static_cast<std::size_t>((y1 - m_y0) / m_bin) + 1u;
+                m_nz = static_cast<std::size_t>((z1 - m_z0) / m_bin) + 1u;
+
+                // Counting sort by bin
+                m_offsets.assign(m_ny * m_nz + 1u, 0u);
+                std::vector<std::size_t> bins(hits.size());
+                for (std::size_t i = 0; i < hits.size(); ++i)
+                {
+                    bins[i] = bin(hits[i].y, hits[i].z);
+                    ++m_offsets[bins[i] + 1u];
+                }
+                for (std::size_t b = 0; b < m_ny * m_nz; ++b)
+                {
+                    m_offsets[b + 1u] += m_offsets[b];
+                }
+                m_order.resize(hits.size());
+                std::vector<std::size_t> next(m_offsets.begin(), m_offsets.end() - 1);
+                for (std::size_t i = 0; i < hits.size(); ++i)
+                {
+                    m_order[next[bins[i]]++] = i;
+                }
+            }
+
+            /// Call @c func with the index of every measurement in the bins
+            /// overlapping [@c y_min, @c y_max] x [@c z_min, @c z_max]
+            template <typename func_t>
+            void for_each(const scalar y_min, const scalar y_max,
+                          const scalar z_min, const scalar z_max,
+                          func_t &&func) const
+            {
+                if (m_ny == 0u || y_max < m_y0 || z_max < m_z0)
+                {
+                    return;
+                }
+                const std::size_t iy0 = index(y_min, m_y0, m_ny);
+                const std::size_t iy1 = index(y_max, m_y0, m_ny);
+                const std::size_t iz0 = index(z_min, m_z0, m_nz);
+                const std::size_t iz1 = index(z_max, m_z0, m_nz);
+                for (std::size_t iy = iy0; iy <= iy1; ++iy)
+                {
+                    const std::size_t row = iy * m_nz;
+                    for (std::size_t i = m_offsets[row + iz0];
+                         i < m_offsets[row + iz1 + 1u]; ++i)
+                    {
+                        func(m_order[i]);
+                    }
+                }
+            }
+
+        private:
+            std::size_t bin(const scalar y, const scalar z) const
+            {
+                return index(y, m_y0, m_ny) * m_nz + index(z, m_z0, m_nz);
+            }
+
+            /// Bin of @c v along an axis from @c v0 with @c n bins, clamped
+            std::size_t index(const scalar v, const scalar v0,
+                              const std::size_t n) const
+            {
+                const scalar f = (v - v0) / m_bin;
+                if (!(f > 0.f))
+                {
+                    return 0u;
+                }
+                return std::min(static_cast<std::size_t>(f), n - 1u);
+            }
+
+            scalar m_bin = 1.f;
+            scalar m_y0 = 0.f;
+            scalar m_z0 = 0.f;
+            std::size_t m_ny = 0u;
+            std::size_t m_nz = 0u;
+            std::vector<std::size_t> m_offsets;
+            std::vector<std::size_t> m_order;
+
+        }; // class hit_grid
+
+        /// One branch of a seed
+        struct branch
+        {
+            vector5 s;
+            matrix5 C;
+            /// x of the state
+            scalar x;
+            std::vector<const hit *> hits;
+            scalar chi2 = 0.f;
+            std::size_t holes = 0u;
+            /// Direction of the seed, for the seed of the fitter
+            std::array<scalar, 2> seed_slope;
+        };
+
+        /// Longer, then smaller chi2 first
+        static bool better(const branch &a, const branch &b)
+        {
+            if (a.hits.size() != b.hits.size())
+            {
+                return a.hits.size() > b.hits.size();
+            }
+            return a.chi2 < b.chi2;
+        }
+
+        static hit make_hit(const layer &l, const traccc::measurement &meas,
+                            const std::size_t index)
+        {
+            const scalar l0 = meas.local[0];
+            const scalar l1 = meas.local[1];
+            const scalar v0 = meas.variance[0];
+            const scalar v1 = meas.variance[1];
+            return {l.origin[0] + l0 * l.u[0] + l1 * l.v[0],
+                    l.origin[1] + l0 * l.u[1] + l1 * l.v[1],
+                    v0 * l.u[0] * l.u[0] + v1 * l.v[0] * l.v[0],
+                    v0 * l.u[0] * l.u[1] + v1 * l.v[0] * l.v[1],
+                    v0 * l.u[1] * l.u[1] + v1 * l.v[1] * l.v[1],
+                    index};
+        }
+
+        /// Call @c func with every triplet seed
+        template <typename func_t>
+        void for_each_seed(const std::vector<std::vector<hit>> &hits,
+                           const std::vector<hit_grid> &grids,
+                           const std::vector<scalar> &max_sigma,
+                           func_t &&func) const
+        {
+            const std::size_t p0 = m_cfg.seed_planes[0];
+            const std::size_t p1 = m_cfg.seed_planes[1];
+            const std::size_t p2 = m_cfg.seed_planes[2];
+            const scalar x0 = m_layers[m_sensitive[p0]].x;
+            const scalar x1 = m_layers[m_sensitive[p1]].x;
+            const scalar x2 = m_layers[m_sensitive[p2]].x;
+
+            // Windows around the doublet slope and the predicted third
+            // measurement, widened by the errors of the measurements
+            const scalar k = m_cfg.window_sigmas;
+            const scalar window = m_cfg.max_slope * (x1 - x0) +
+                                  k * (max_sigma[p0] + max_sigma[p1]);
+            const scalar r = (x2 - x1) / (x1 - x0);
+            const scalar tolerance =
+                m_cfg.triplet_tolerance * traccc::unit<scalar>::mm +
+                k * std::sqrt(max_sigma[p2] * max_sigma[p2] +
+                              (1.f + r) * (1.f + r) * max_sigma[p1] * max_sigma[p1] +
+                              r * r * max_sigma[p0] * max_sigma[p0]);
+            const scalar max_slope =
+                m_cfg.max_slope + k * (max_sigma[p0] + max_sigma[p1]) / (x1 - x0);
+
+            for (const hit &a : hits[p0])
+            {
+                grids[p1].for_each(
+                    a.y - window, a.y + window, a.z - window, a.z + window,
+                    [&](const std::size_t ib)
+                    {
+                        const hit &b = hits[p1][ib];
+                        const scalar ty = (b.y - a.y) / (x1 - x0);
+                        const scalar tz = (b.z - a.z) / (x1 - x0);
+                        if (std::abs(ty) > max_slope || std::abs(tz) > max_slope)
+                        {
+                            return;
+                        }
+
+                        const scalar y = b.y + ty * (x2 - x1);
+                        const scalar z = b.z + tz * (x2 - x1);
+                        grids[p2].for_each(
+                            y - tolerance, y + tolerance, z - tolerance,
+                            z + tolerance,
+                            [&](const std::size_t ic)
+                            {
+                                const hit &c = hits[p2][ic];
+                                if (std::abs(c.y - y) <= tolerance &&
+                                    std::abs(c.z - z) <= tolerance)
+                                {
+                                    func(std::array<const hit *, 3>{&a, &b, &c});
+                                }
+                            });
+                    });
+            }
+        }
+
+        /// Follow one seed through the telescope, returning its best branch
+        template <typename field_view_t>
+        branch follow(const field_view_t &field,
+                      const std::vector<std::vector<hit>> &hits,
+                      const std::vector<hit_grid> &grids,
+                      const std::vector<scalar> &max_sigma,
+                      const std::array<const hit *, 3> &seed) const
+        {
+            const std::size_t first = m_sensitive[m_cfg.seed_planes[0]];
+            const scalar dx =
+                m_layers[m_sensitive[m_cfg.seed_planes[2]]].x - m_layers[first].x;
+
+            // Start on the first seed measurement, with the slope of the
+            // triplet, qop unknown
+            branch start;
+            start.x = m_layers[first].x;
+            start.seed_slope = {(seed[2]->y - seed[0]->y) / dx,
+                                (seed[2]->z - seed[0]->z) / dx};
+            start.s = {seed[0]->y, seed[0]->z, start.seed_slope[0],
+                       start.seed_slope[1], 0.f};
+            start.C = {};
+            start.C[e_y][e_y] = seed[0]->vyy;
+            start.C[e_y][e_z] = start.C[e_z][e_y] = seed[0]->vyz;
+            start.C[e_z][e_z] = seed[0]->vzz;
+            start.C[e_ty][e_ty] = start.C[e_tz][e_tz] =
+                m_cfg.max_slope * m_cfg.max_slope;
+            start.C[e_qop][e_qop] = m_qop_max * m_qop_max;
+            start.hits.push_back(seed[0]);
+
+            std::vector<branch> branches{std::move(start)};
+            std::vector<branch> next;
+
+            for (std::size_t li = first; li < m_layers.size(); ++li)
+            {
+                const layer &l = m_layers[li];
+                next.clear();
+
+                for (branch &br : branches)
+                {
+                    if (li != first)
+                    {
+                        transport(field, l.x, br);
+                    }
+
+                    if (!l.sensitive || li == first ||
+                        (l.plane > m_cfg.seed_planes[0] &&
+                         l.plane < m_cfg.seed_planes[2] &&
+                         l.plane != m_cfg.seed_planes[1]))
+                    {
+                        next.push_back(std::move(br));
+                        continue;
+                    }
+
+                    // The seed measurements on the seed planes, a search
+                    // around the prediction on the others
+                    bool found = false;
+                    auto try_hit = [&](const hit &h)
+                    {
+                        branch updated = br;
+                        if (update(updated, h))
+                        {
+                            next.push_back(std::move(updated));
+                            found = true;
+                        }
+                    };
+
+                    if (l.plane == m_cfg.seed_planes[1])
+                    {
+                        try_hit(*seed[1]);
+                    }
+                    else if (l.plane == m_cfg.seed_planes[2])
+                    {
+                        try_hit(*seed[2]);
+                    }
+                    else
+                    {
+                        // Every measurement within chi2_max lies in the
+                        // window of its 1D residuals
+                        const scalar k = std::sqrt(m_cfg.chi2_max);
+                        const scalar v = max_sigma[l.plane] * max_sigma[l.plane];
+                        const scalar wy = k * std::sqrt(br.C[e_y][e_y] + v);
+                        const scalar wz = k * std::sqrt(br.C[e_z][e_z] + v);
+                        grids[l.plane].for_each(
+                            br.s[e_y] - wy, br.s[e_y] + wy, br.s[e_z] - wz,
+                            br.s[e_z] + wz,
+                            [&](const std::size_t i) { try_hit(hits[l.plane][i]); });
+                    }
+
+                    if (!found && l.plane > m_cfg.seed_planes[2] &&
+                        br.holes < m_cfg.max_holes)
+                    {
+                        ++br.holes;
+                        next.push_back(std::move(br));
+                    }
+                }
+
+                // Material of the plane, then keep the best branches
+                for (branch &br : next)
+                {
+                    add_scattering(l, br);
+                }
+                if (next.size() > m_cfg.max_branches)
+                {
+                    std::partial_sort(next.begin(),
+                                      next.begin() + static_cast<std::ptrdiff_t>(
+                                                         m_cfg.max_branches),
+                                      next.end(), better);
+                    next.resize(m_cfg.max_branches);
+                }
+                std::swap(branches, next);
+                if (branches.empty())
+                {
+                    return {};
+                }
+            }
+
+            return *std::min_element(branches.begin(), branches.end(), better);
+        }
+
+        /// Kalman update of @c br with @c h, false if its chi2 is too large
+        /// or its momentum too low. A low momentum branch scatters so much
+        /// that it would pick up any measurement.
+        bool update(branch &br, const hit &h) const
+        {
+            const scalar r0 = h.y - br.s[e_y];
+            const scalar r1 = h.z - br.s[e_z];
+            const scalar s00 = br.C[e_y][e_y] + h.vyy;
+            const scalar s01 = br.C[e_y][e_z] + h.vyz;
+            const scalar s11 = br.C[e_z][e_z] + h.vzz;
+            const scalar det = s00 * s11 - s01 * s01;
+            if (!(det > 0.f))
+            {
+                return false;
+            }
+            const scalar i00 = s11 / det;
+            const scalar i01 = -s01 / det;
+            const scalar i11 = s00 / det;
+
+            const scalar chi2 = r0 * (i00 * r0 + i01 * r1) + r1 * (i01 * r0 + i11 * r1);
+            if (!(chi2 <= m_cfg.chi2_max))
+            {
+                return false;
+            }
+
+            // K = C H^T S^-1, with H selecting (y, z)
+            std::array<std::array<scalar, 2>, 5> K;
+            for (unsigned int i = 0; i < 5u; ++i)
+            {
+                K[i][0] = br.C[i][e_y] * i00 + br.C[i][e_z] * i01;
+                K[i][1] = br.C[i][e_y] * i01 + br.C[i][e_z] * i11;
+            }
+            for (unsigned int i = 0; i < 5u; ++i)
+            {
+                br.s[i] += K[i][0] * r0 + K[i][1] * r1;
+            }
+            const std::array<std::array<scalar, 5>, 2> HC{br.C[e_y], br.C[e_z]};
+            for (unsigned int i = 0; i < 5u; ++i)
+            {
+                for (unsigned int j = 0; j < 5u; ++j)
+                {
+                    br.C[i][j] -= K[i][0] * HC[0][j] + K[i][1] * HC[1][j];
+                }
+            }
+
+            br.chi2 += chi2;
+            br.hits.push_back(&h);
+            return std::abs(br.s[e_qop]) <= m_qop_max;
+        }
+
+        /// Multiple scattering in the plane @c l (Highland formula)
+        void add_scattering(const layer &l, branch &br) const
+        {
+            const scalar ty = br.s[e_ty];
+            const scalar tz = br.s[e_tz];
+            const scalar n2 = 1.f + ty * ty + tz * tz;
+            const scalar x_X0 = l.thickness * std::sqrt(n2) / l.X0;
+            if (!(x_X0 > 0.f))
+            {
+                return;
+            }
+
+            const scalar m = m_cfg.ptc_type.mass();
+            const scalar q = std::abs(m_cfg.ptc_type.charge());
+            const scalar qop = std::max(
+                std::abs(br.s[e_qop]),
+                1.f / (m_cfg.scattering_momentum * traccc::unit<scalar>::GeV));
+            const scalar mom = q / qop;
+            const scalar beta2 = mom * mom / (mom * mom + m * m);
+
+            const scalar theta0 =
+                13.6f * traccc::unit<scalar>::MeV / (std::sqrt(beta2) * mom) * q *
+                std::sqrt(x_X0) * (1.f + 0.038f * std::log(x_X0 * q * q / beta2));
+            const scalar var = theta0 * theta0 * n2;
+            br.C[e_ty][e_ty] += var * (1.f + ty * ty);
+            br.C[e_tz][e_tz] += var * (1.f + tz * tz);
+            br.C[e_ty][e_tz] += var * ty * tz;
+            br.C[e_tz][e_ty] += var * ty * tz;
+        }
+
+        /// Whether the straight line from the state of @c br to @c x1 sees
+        /// no field
+        template <typename field_view_t>
+        bool field_free(const field_view_t &field, const scalar x1,
+                        const branch &br) const
+        {
+            const scalar dx = x1 - br.x;
+            if constexpr (requires(const std::array<scalar, 3> &p) {
+                              field.is_field_free(p, p);
+                          })
+            {
+                const std::array<scalar, 3> a{br.x, br.s[e_y], br.s[e_z]};
+                const std::array<scalar, 3> b{x1, br.s[e_y] + dx * br.s[e_ty],
+                                              br.s[e_z] + dx * br.s[e_tz]};
+                return field.is_field_free(a, b);
+            }
+            else
+            {
+                const std::size_t n = n_steps(dx);
+                for (std::size_t i = 0; i <= n; ++i)
+                {
+                    const scalar t = dx * static_cast<scalar>(i) / static_cast<scalar>(n);
+                    const auto b = field.at(static_cast<float>(br.x + t),
+                                            static_cast<float>(br.s[e_y] + t * br.s[e_ty]),
+                                            static_cast<float>(br.s[e_z] + t * br.s[e_tz]));
+                    if (b[0] != 0.f || b[1] != 0.f || b[2] != 0.f)
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+        }
+
+        std::size_t n_steps(const scalar dx) const
+        {
+            return std::max<std::size_t>(
+                1u, static_cast<std::size_t>(std::ceil(
+                        std::abs(dx) / (m_cfg.max_step * traccc::unit<scalar>::mm))));
+        }
+
+        /// Transport the state and covariance of @c br to @c x1
+        template <typename field_view_t>
+        void transport(const field_view_t &field, const scalar x1, branch &br) const
+        {
+            const scalar dx = x1 - br.x;
+
+            matrix5 F{};
+            if (field_free(field, x1, br))
+            {
+                br.s[e_y] += dx * br.s[e_ty];
+                br.s[e_z] += dx * br.s[e_tz];
+                for (unsigned int i = 0; i < 5u; ++i)
+                {
+                    F[i][i] = 1.f;
+                }
+                F[e_y][e_ty] = dx;
+                F[e_z][e_tz] = dx;
+            }
+            else
+            {
+                // One lane of the RK4 steps of the batched fitter, with the
+                // Jacobian integrated along them
+                detail::lane_vector<1u> s;
+                for (unsigned int i = 0; i < 5u; ++i)
+                {
+                    s[i][0] = br.s[i];
+                }
+                detail::lane_matrix<1u> jacobian;
+                detail::propagate(field, br.x, x1,
+                                  m_cfg.max_step * traccc::unit<scalar>::mm, s,
+                                  jacobian);
+                for (unsigned int i = 0; i < 5u; ++i)
+                {
+                    br.s[i] = s[i][0];
+                    for (unsigned int j = 0; j < 5u; ++j)
+                    {
+                        F[i][j] = jacobian[i][j][0];
+                    }
+                }
+            }
+
+            // C = F C F^T
+            matrix5 FC{};
+            for (unsigned int i = 0; i < 5u; ++i)
+            {
+                for (unsigned int j = 0; j < 5u; ++j)
+                {
+                    for (unsigned int k = 0; k < 5u; ++k)
+                    {
+                        FC[i][j] += F[i][k] * br.C[k][j];
+                    }
+                }
+            }
+            for (unsigned int i = 0; i < 5u; ++i)
+            {
+                for (unsigned int j = 0; j < 5u; ++j)
+                {
+                    scalar c = 0.f;
+                    for (unsigned int k = 0; k < 5u; ++k)
+                    {
+                        c += FC[i][k] * F[j][k];
+                    }
+                    br.C[i][j] = c;
+                }
+            }
+            br.x = x1;
+        }
+
+        track_finder_config m_cfg;
+        /// Largest |qop| searched for
+        scalar m_qop_max;
+        std::vector<layer> m_layers;
+        /// Layer index of every sensitive plane
+        std::vector<std::size_t> m_sensitive;
+
+    }; // class track_finder
+
+    /// Make the finder configuration of the track finding options
+    inline track_finder_config make_track_finder_config(
+        const traccc::opts::track_finding_options &opts)
+    {
+        track_finder_config cfg;
+        cfg.min_momentum = opts.min_momentum;
+        cfg.chi2_max = opts.chi2_max;
+        cfg.max_branches = std::max<std::size_t>(opts.max_branches, 1u);
+        cfg.max_holes = opts.max_holes;
+        cfg.min_measurements = opts.min_measurements;
+        return cfg;
+    }
+
+    /// Measurements of a simulated event grouped by plane, to find its
+    /// tracks like those of a raw frame
+    ///
+    /// The measurement ids are set to the index of the measurement in @c evt,
+    /// which @c matched_truths relies on.
+    ///
+    /// @param evt    Simulated event
+    /// @param planes Sensitive planes of the telescope, in plane order
+    inline hit_frame make_hit_frame(const event_view &evt,
+                                    const std::vector<sensitive_plane> &planes)
+    {
+        hit_frame frame;
+        frame.frame_id = evt.event_id;
+        frame.plane_offsets.assign(planes.size() + 1u, 0u);
+
+        std::vector<std::size_t> plane_of(evt.measurements.size());
+        for (std::size_t i = 0; i < evt.measurements.size(); ++i)
+        {
+            std::size_t p = 0u;
+            while (p < planes.size() &&
+                   planes[p].barcode != evt.measurements[i].surface_link)
+            {
+                ++p;
+            }
+            plane_of[i] = p;
+            if (p == planes.size())
+            {
+                ++frame.n_invalid;
+                continue;
+            }
+            ++frame.plane_offsets[p + 1u];
+        }
+        for (std::size_t p = 0; p < planes.size(); ++p)
+        {
+            frame.plane_offsets[p + 1u] += frame.plane_offsets[p];
+        }
+
+        frame.measurements.resize(frame.plane_offsets.back());
+        std::vector<std::size_t> next(frame.plane_offsets.begin(),
+                                      frame.plane_offsets.end() - 1);
+        for (std::size_t i = 0; i < evt.measurements.size(); ++i)
+        {
+            if (plane_of[i] == planes.size())
+            {
+                continue;
+            }
+            traccc::measurement &meas = frame.measurements[next[plane_of[i]]++];
+            meas = evt.measurements[i];
+            meas.measurement_id = i;
+        }
+
+        return frame;
+    }
+
+    /// Truth of the particle contributing most measurements to every found
+    /// track candidate of a simulated event
+    ///
+    /// @param evt        Simulated event
+    /// @param candidates Candidates found in the @c make_hit_frame of @c evt
+    /// @param first      First candidate of this event in @c candidates
+    inline std::vector<track_truth> matched_truths(
+        const event_view &evt,
+        const traccc::track_candidate_container_types::host &candidates,
+        const std::size_t first = 0u)
+    {
+        std::vector<track_truth> truths;
+        truths.reserve(candidates.size() - first);
+
+        std::map<std::size_t, std::size_t> counts;
+        for (std::size_t t = first; t < candidates.size(); ++t)
+        {
+            counts.clear();
+            for (const auto &meas : candidates.at(t).items)
+            {
+                const auto it = std::upper_bound(evt.measurement_offsets.begin(),
+                                                 evt.measurement_offsets.end(),
+                                                 meas.measurement_id);
+                ++counts[static_cast<std::size_t>(
+                    it - evt.measurement_offsets.begin() - 1)];
+            }
+
+            const auto best = std::max_element(
+                counts.begin(), counts.end(),
+                [](const auto &a, const auto &b) { return a.second < b.second; });
+            const std::size_t ptc = best->first;
+            truths.push_back({evt.truths[evt.measurement_offsets[ptc]].momentum,
+                              evt.particles[ptc].charge});
+        }
+
+        return truths;
+    }
+
+} // namespace bella
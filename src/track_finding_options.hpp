@@ -0,0 +1,74 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Local include(s).
+#include "traccc/options/details/interface.hpp"
+
+// System include(s).
+#include <cstddef>
+#include <string>
+
+namespace traccc::opts
+{
+
+    /// Convenience namespace shorthand
+    namespace po = boost::program_options;
+
+    /// Command line options of the BELLA track finding
+    class track_finding_options : public interface
+    {
+
+    public:
+        /// Constructor
+        track_finding_options() : interface("BELLA Track Finding Options")
+        {
+
+            m_desc.add_options()("track-candidates",
+                                 po::value(&(candidates))
+                                     ->default_value("auto"),
+                                 "Track candidates fitted: truth (simulated "
+                                 "events only), finder (triplet seeding and "
+                                 "combinatorial following), single (raw "
+                                 "frames of one track only) or auto (truth "
+                                 "of simulated events; single for raw "
+                                 "frames, finder for the others)");
+            m_desc.add_options()("finder-min-momentum",
+                                 po::value(&(min_momentum))
+                                     ->default_value(0.05f),
+                                 "Lowest track momentum searched for [GeV]");
+            m_desc.add_options()("finder-chi2-max",
+                                 po::value(&(chi2_max))
+                                     ->default_value(15.f),
+                                 "Maximum chi2 of a measurement on a track");
+            m_desc.add_options()("finder-max-branches",
+                                 po::value(&(max_branches))
+                                     ->default_value(4u),
+                                 "Maximum number of branches followed per "
+                                 "seed");
+            m_desc.add_options()("finder-max-holes",
+                                 po::value(&(max_holes))
+                                     ->default_value(1u),
+                                 "Maximum number of planes without a "
+                                 "measurement on a track");
+            m_desc.add_options()("finder-min-measurements",
+                                 po::value(&(min_measurements))
+                                     ->default_value(6u),
+                                 "Minimum number of measurements of a track");
+        }
+
+        std::string candidates;
+        float min_momentum;
+        float chi2_max;
+        std::size_t max_branches;
+        std::size_t max_holes;
+        std::size_t min_measurements;
+
+    }; // class track_finding_options
+
+} // namespace traccc::opts
@@ -0,0 +1,64 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Project include(s).
+#include "traccc/definitions/primitives.hpp"
+#include "traccc/edm/track_parameters.hpp"
+#include "traccc/options/generation.hpp"
+
+// detray include(s).
+#include "detray/test/utils/simulation/event_generator/track_generators.hpp"
+
+// System include(s).
+#include <random>
+
+namespace bella
+{
+
+    // Use deterministic random number generator for testing; the parallel
+    // simulation seeds it per particle from bella::stream_seed
+    using uniform_gen_t =
+        detray::detail::random_numbers<traccc::scalar,
+                                       std::uniform_real_distribution<traccc::scalar>>;
+
+    /// Generator of the simulated muons
+    using generator_type =
+        detray::random_track_generator<traccc::free_track_parameters,
+                                       uniform_gen_t>;
+
+    /// Make the particle generator configuration described by the
+    /// generation options
+    inline generator_type::configuration make_generator_config(
+        const traccc::opts::generation &generation_opts)
+    {
+        // Origin of particles
+        generator_type::configuration gen_cfg{};
+        gen_cfg.n_tracks(generation_opts.gen_nparticles);
+        gen_cfg.origin(traccc::point3{generation_opts.vertex[0],
+                                      generation_opts.vertex[1],
+                                      generation_opts.vertex[2]});
+        gen_cfg.origin_stddev(traccc::point3{generation_opts.vertex_stddev[0],
+                                             generation_opts.vertex_stddev[1],
+                                             generation_opts.vertex_stddev[2]});
+        gen_cfg.phi_range(generation_opts.phi_range);
+        gen_cfg.theta_range(generation_opts.theta_range);
+        gen_cfg.mom_range(generation_opts.mom_range);
+        gen_cfg.charge(generation_opts.ptc_type.charge());
+
+        return gen_cfg;
+    }
+
+    /// Make the particle generator described by the generation options
+    inline generator_type make_track_generator(
+        const traccc::opts::generation &generation_opts)
+    {
+        return generator_type(make_generator_config(generation_opts));
+    }
+
+} // namespace bella
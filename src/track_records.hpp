@@ -0,0 +1,54 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Project include(s).
+#include "traccc/definitions/primitives.hpp"
+
+// System include(s).
+#include <cstddef>
+#include <vector>
+
+namespace bella
+{
+
+    /// Fitted and truth momentum of one track
+    struct residual_record
+    {
+        std::size_t event_id;
+        std::size_t track_id;
+        traccc::scalar fit_qop;
+        traccc::scalar fit_qopT;
+        traccc::scalar fit_qopz;
+        traccc::scalar truth_qop;
+        traccc::scalar truth_qopT;
+        traccc::scalar truth_qopz;
+        // Fitted standard deviations, used for the pulls
+        traccc::scalar fit_qop_err = 0.f;
+        traccc::scalar fit_qopT_err = 0.f;
+        traccc::scalar fit_qopz_err = 0.f;
+    };
+
+    /// Global position of one smoothed track state
+    struct state_record
+    {
+        std::size_t event_id;
+        std::size_t track_id;
+        traccc::scalar x;
+        traccc::scalar y;
+        traccc::scalar z;
+    };
+
+    /// Everything the fitter writes out for one event
+    struct event_records
+    {
+        std::vector<residual_record> residuals;
+        std::vector<state_record> states;
+    };
+
+} // namespace bella
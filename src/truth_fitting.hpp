@@ -0,0 +1,178 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+#pragma once
+
+// Project include(s).
+#include "traccc/definitions/common.hpp"
+#include "traccc/definitions/primitives.hpp"
+#include "traccc/edm/particle.hpp"
+#include "traccc/edm/track_candidate.hpp"
+#include "traccc/edm/track_state.hpp"
+
+// Detray include(s).
+#include "detray/geometry/tracking_surface.hpp"
+
+// Local include(s).
+#include "src/track_records.hpp"
+
+// VecMem include(s).
+#include <vecmem/memory/memory_resource.hpp>
+
+// System include(s).
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace bella
+{
+
+    /// Truth charge and momentum of a track at its first measurement
+    struct track_truth
+    {
+        traccc::vector3 momentum;
+        traccc::scalar charge;
+    };
+
+    /// Truth track candidates of one event, ready to be fitted
+    struct candidate_event
+    {
+        traccc::track_candidate_container_types::host candidates;
+        std::vector<track_truth> truths;
+    };
+
+    /// Standard deviations of the seed track parameters
+    ///
+    /// @param ptc Particle the qop smearing is taken from
+    inline std::array<traccc::scalar, traccc::e_bound_size> seed_stddevs(
+        const traccc::particle &ptc)
+    {
+        using traccc::scalar;
+
+        const scalar qop_stddev = 0.05f * traccc::math::abs(ptc.charge) /
+                                  traccc::getter::norm(ptc.momentum);
+
+        return {0.02f * detray::unit<scalar>::mm,
+                0.02f * detray::unit<scalar>::mm,
+                0.0085f,
+                0.0085f,
+                qop_stddev,
+                1.f * detray::unit<scalar>::ns};
+    }
+
+    /// Collect the residual and state records of the fitted tracks
+    /// [@c first, @c first + @c n) of one event
+    ///
+    /// The track ids of the records count from zero, so a batch holding
+    /// several events can be split back into the per-event output.
+    ///
+    /// @param event        Event index
+    /// @param det          Detector the tracks were fitted in
+    /// @param truths       Truth of the tracks of this event
+    /// @param track_states Fitted tracks
+    /// @param first        First track of this event in @c track_states
+    /// @param n            Number of tracks of this event
+    template <typename detector_t>
+    event_records collect_records(
+        const std::size_t event, const detector_t &det,
+        const std::vector<track_truth> &truths,
+        const traccc::track_state_container_types::host &track_states,
+        const std::size_t first = 0u,
+        std::size_t n = std::numeric_limits<std::size_t>::max())
+    {
+        using namespace traccc;
+
+        event_records records;
+
+        n = std::min(n, track_states.size() - first);
+        records.residuals.reserve(n);
+
+        for (std::size_t i = 0; i < n; i++)
+        {
+            const auto &trk_states_per_track = track_states.at(first + i).items;
+
+            if (trk_states_per_track.size() == 0u)
+            {
+                throw std::runtime_error("track states is empty");
+            }
+            /*
+            if (trk_states_per_track.size() < 6u)
+            {
+                throw std::runtime_error(
+                    "The number of track states per track (" +
+                    std::to_string(trk_states_per_track.size()) +
+                    ") is less than 6");
+            }
+            */
+
+            /************************************
+             *  Collect Residuals of qop
+             * **********************************/
+
+            // Fit qop
+            const auto &fit_par = trk_states_per_track.at(0).smoothed();
+            const scalar fit_qop = fit_par.qop();
+            const scalar fit_qopT = fit_par.qopT();
+            // @NOTE: qopz is a signed value
+            const scalar fit_qopz = fit_par.qopz();
+
+            // Their standard deviations, from the qop and theta covariance
+            const auto &cov = fit_par.covariance();
+            const scalar var_qop =
+                getter::element(cov, e_bound_qoverp, e_bound_qoverp);
+            const scalar cov_qop_theta =
+                getter::element(cov, e_bound_qoverp, e_bound_theta);
+            const scalar var_theta =
+                getter::element(cov, e_bound_theta, e_bound_theta);
+            const scalar sin_theta = math::sin(fit_par.theta());
+            const scalar cos_theta = math::cos(fit_par.theta());
+
+            // d(qop/sin)/d(qop, theta) and d(qop/cos)/d(qop, theta)
+            const std::array<scalar, 2> d_qopT{
+                1.f / sin_theta, -fit_qop * cos_theta / (sin_theta * sin_theta)};
+            const std::array<scalar, 2> d_qopz{
+                1.f / cos_theta, fit_qop * sin_theta / (cos_theta * cos_theta)};
+            auto propagate = [&](const std::array<scalar, 2> &d)
+            {
+                return math::sqrt(d[0] * d[0] * var_qop +
+                                  2.f * d[0] * d[1] * cov_qop_theta +
+                                  d[1] * d[1] * var_theta);
+            };
+
+            // Truth qop
+            const auto &global_mom = truths.at(i).momentum;
+            const auto p = getter::norm(global_mom);
+            const auto pT = getter::perp(global_mom);
+            // @NOTE: pz is a signed value
+            const auto pz = global_mom[2];
+
+            const auto q = truths.at(i).charge;
+
+            const scalar truth_qop = q / p;
+            const scalar truth_qopT = q / pT;
+            const scalar truth_qopz = q / pz;
+
+            records.residuals.push_back(
+                {event, i, fit_qop, fit_qopT, fit_qopz, truth_qop, truth_qopT,
+                 truth_qopz, math::sqrt(var_qop), propagate(d_qopT),
+                 propagate(d_qopz)});
+
+            for (const auto &st : trk_states_per_track)
+            {
+                const detray::tracking_surface sf{det, st.surface_link()};
+                const auto xyz = sf.bound_to_global({}, st.smoothed().bound_local(), st.smoothed().dir());
+                records.states.push_back({event, i, xyz[0], xyz[1], xyz[2]});
+            }
+        }
+
+        return records;
+    }
+
+} // namespace bella
@@ -16,31 +16,58 @@
 #include "traccc/options/input_data.hpp"
 #include "traccc/options/performance.hpp"
 #include "traccc/options/program_options.hpp"
+#include "traccc/options/threading.hpp"
 #include "traccc/options/track_propagation.hpp"
 #include "traccc/utils/seed_generator.hpp"
-#include "traccc/utils/event_data.hpp"
 
 // Detray include(s).
 #include "detray/core/detector.hpp"
-#include "detray/core/detector_metadata.hpp"
 #include "detray/detectors/bfield.hpp"
-#include "detray/io/frontend/detector_reader.hpp"
 #include "detray/navigation/navigator.hpp"
 #include "detray/propagator/propagator.hpp"
 #include "detray/propagator/rk_stepper.hpp"
 
 // Local include(s).
+#include "src/batched_kalman_fitter.hpp"
+#include "src/chunked_fitting.hpp"
+#include "src/csv_event.hpp"
+#include "src/detector_io.hpp"
+#include "src/event_loop.hpp"
+#include "src/event_store.hpp"
+#include "src/event_store_options.hpp"
+#include "src/field_model.hpp"
 #include "src/field_options.hpp"
+#include "src/fit_output.hpp"
+#include "src/fit_output_options.hpp"
+#include "src/fitting_options.hpp"
+#include "src/gap_stepper.hpp"
+#include "src/geometry_config.hpp"
+#include "src/geometry_source_options.hpp"
+#include "src/residual_summary.hpp"
+#include "src/shard.hpp"
+#include "src/shard_options.hpp"
+#include "src/stage_timing.hpp"
+#include "src/telescope_metadata.hpp"
+#include "src/timing_options.hpp"
+#include "src/track_records.hpp"
+#include "src/truth_fitting.hpp"
 
 // VecMem include(s).
+#include <vecmem/memory/binary_page_memory_resource.hpp>
 #include <vecmem/memory/host_memory_resource.hpp>
+#include <vecmem/memory/synchronized_memory_resource.hpp>
 
 // System include(s).
 #include <cstdlib>
 #include <exception>
 #include <iomanip>
 #include <iostream>
-#include <fstream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 using namespace traccc;
 namespace po = boost::program_options;
@@ -54,181 +81,199 @@ int main(int argc, char *argv[])
     traccc::opts::input_data input_opts;
     traccc::opts::track_propagation propagation_opts;
     traccc::opts::field_options field_opts;
+    traccc::opts::threading threading_opts;
+    traccc::opts::fitting_options fitting_opts;
+    traccc::opts::fit_output_options output_opts;
+    traccc::opts::event_store_options store_opts;
+    traccc::opts::geometry_source_options source_opts;
+    traccc::opts::bella_geometry_options geometry_opts;
+    traccc::opts::timing_options timing_opts;
+    traccc::opts::shard_options shard_opts;
     traccc::opts::program_options program_opts{
         "Truth Track Fitting on the Host",
-        {detector_opts, input_opts, propagation_opts, field_opts},
+        {detector_opts, input_opts, propagation_opts, field_opts,
+         threading_opts, fitting_opts, output_opts, store_opts, source_opts,
+         geometry_opts, timing_opts, shard_opts},
         argc,
         argv};
 
     /// Type declarations
-    using host_detector_type = detray::detector<detray::default_metadata,
-                                                detray::host_container_types>;
-
-    using b_field_t = covfie::field<detray::bfield::inhom_bknd_t>;
-    using rk_stepper_type =
-        detray::rk_stepper<b_field_t::view_t, traccc::default_algebra,
-                           detray::constrained_step<>>;
-
-    using host_navigator_type = detray::navigator<const host_detector_type>;
-    using host_fitter_type =
-        traccc::kalman_fitter<rk_stepper_type, host_navigator_type>;
+    using host_detector_type = bella::host_detector_type;
 
     // Memory resources used by the application.
     vecmem::host_memory_resource host_mr;
 
+    // Time spent per stage, reported at exit with --timing
+    bella::stage_timing timing(timing_opts.active());
+    auto stage_start = bella::stage_timing::clock::now();
+
     /*****************************
      * Build a geometry
      *****************************/
 
-    // B field value and its type
-    b_field_t field = detray::io::read_bfield<b_field_t>(field_opts.bfield_file);
+    // The telescope the tracks are fitted in, read from json or rebuilt
+    const bella::geometry_config geometry =
+        bella::make_geometry_config(geometry_opts);
+    const auto [host_det, names] =
+        bella::load_telescope(detector_opts, source_opts, geometry, host_mr);
+    timing.add_since("detector", stage_start);
 
-    // Read the detector
-    detray::io::detector_reader_config reader_cfg{};
-    reader_cfg.add_file(detector_opts.detector_file);
-    if (!detector_opts.material_file.empty())
+    // Events read from the binary event store instead of the csv files
+    std::unique_ptr<bella::event_store> store;
+    if (!store_opts.file.empty())
     {
-        reader_cfg.add_file(detector_opts.material_file);
+        store = std::make_unique<bella::event_store>(store_opts.file);
     }
-    if (!detector_opts.grid_file.empty())
+
+    // The csv events are read without a detector, so the builder source
+    // reads no geometry file at all
+    if (!store && (input_opts.use_acts_geom_source ||
+                   input_opts.format != traccc::data_format::csv))
     {
-        reader_cfg.add_file(detector_opts.grid_file);
+        throw std::invalid_argument(
+            "Only csv events with detray geometry ids can be fitted");
     }
-    const auto [host_det, names] =
-        detray::io::read_detector<host_detector_type>(host_mr, reader_cfg);
+
+    // Output files, and the resolution summary of every fitted track. A
+    // shard fits its block of the input events into its own files. The files
+    // are written on a writer thread, so the fitting does not wait for the
+    // file system.
+    const bella::shard shard = bella::make_shard(shard_opts);
+    const auto output_writer = bella::make_record_writer(
+        output_opts.format, shard.suffix(), output_opts.queue_size);
+    bella::residual_summary summary(output_opts.summary);
+
+    // Pooled memory of the event containers. Pages freed by a finished event
+    // are handed to the next events instead of going back to the system,
+    // so a steady stream of events does not allocate upstream.
+    vecmem::binary_page_memory_resource pool_mr(host_mr);
+    vecmem::synchronized_memory_resource event_mr(pool_mr);
+
+    // Read a single event and make its truth track candidates. Only reads
+    // the detector and the store, so this may run on any thread.
+    auto load_event = [&](const std::size_t event)
+    {
+        // Truth Track Candidates, from the flattened truth of the event
+        auto make_candidates = [&](const bella::event_view &evt)
+        {
+            bella::scoped_timer timer(timing, "seeding");
+            return bella::candidate_event{
+                bella::generate_truth_candidates(host_det, evt, event_mr),
+                bella::track_truths(evt)};
+        };
+
+        if (store)
+        {
+            auto load_start = bella::stage_timing::clock::now();
+            const bella::event_view evt = store->find(event);
+            timing.add_since("event load", load_start);
+
+            return make_candidates(evt);
+        }
+
+        auto load_start = bella::stage_timing::clock::now();
+        const bella::truth_event evt =
+            bella::read_csv_event(input_opts.directory, event);
+        timing.add_since("event load", load_start);
+
+        return make_candidates(evt.view());
+    };
 
     /*****************************
      * Do the reconstruction
      *****************************/
 
-    // Fitting algorithm object
-    typename traccc::fitting_algorithm<host_fitter_type>::config_type fit_cfg;
-    fit_cfg.propagation = propagation_opts;
-
-    traccc::fitting_algorithm<host_fitter_type> host_fitting(fit_cfg);
-
-    // Residual file
-    std::ofstream residual_file;
-    residual_file.open("residual.csv");
-    residual_file << "fit_qop, fit_qopT, fit_qopz, ";
-    residual_file << "truth_qop, truth_qopT, truth_qopz,";
-    residual_file << "qop_residual, qopT_residual, qopz_residual";
-    residual_file << std::endl;
-
-    // Track state file
-    std::ofstream state_file;
-    state_file.open("state.csv");
-    state_file << "event_id, fit_track_id, x, y, z";
-    state_file << std::endl;
-
-    // Iterate over events
-    for (auto event = input_opts.skip;
-         event < input_opts.events + input_opts.skip; ++event)
+    // With --fit-mode=batched the tracks crossing every plane are fitted in
+    // batches, and only the others by the traccc fitter
+    std::optional<bella::batched_kalman_fitter> batched_fitter;
+    if (fitting_opts.mode == "batched")
     {
+        batched_fitter.emplace(host_det, bella::make_batched_fitter_config(fitting_opts));
+    }
+    else if (fitting_opts.mode != "scalar")
+    {
+        throw std::invalid_argument("Unknown fit mode: " + fitting_opts.mode);
+    }
 
-        // Truth Track Candidates
-        traccc::event_data evt_data(input_opts.directory, event, host_mr,
-                                    input_opts.use_acts_geom_source, &host_det,
-                                    input_opts.format, false);
-
-        assert(evt_data.m_particle_map.size() > 0u);
-        /// Assume that all particle momentum are the same
-        const auto truth_mom = evt_data.m_particle_map.begin()->second.momentum;
-        const auto charge = evt_data.m_particle_map.begin()->second.charge;
+    // The stepper, and with it the fitter, is specialized on the B field type.
+    // The magnet field model crosses the field-free gaps on straight lines.
+    stage_start = bella::stage_timing::clock::now();
+    bella::with_field(field_opts, geometry.magnets, [&](const auto &field)
+    {
+        timing.add_since("field", stage_start);
 
-        const scalar qop_stddev = 0.05f * math::abs(charge) / getter::norm(truth_mom);
+        using b_field_t = std::remove_cvref_t<decltype(field)>;
+        using rk_stepper_type = bella::stepper_type<b_field_t>;
 
-        /// Standard deviations for seed track parameters
-        const std::array<scalar, e_bound_size> stddevs = {
-            0.02f * detray::unit<scalar>::mm,
-            0.02f * detray::unit<scalar>::mm,
-            0.0085f,
-            0.0085f,
-            qop_stddev,
-            1.f * detray::unit<scalar>::ns};
+        using host_navigator_type = detray::navigator<const host_detector_type>;
+        using host_fitter_type =
+            traccc::kalman_fitter<rk_stepper_type, host_navigator_type>;
 
-        // Seed generator
-        traccc::seed_generator<host_detector_type> sg(host_det, stddevs);
+        // Fitting algorithm object
+        typename traccc::fitting_algorithm<host_fitter_type>::config_type fit_cfg;
+        fit_cfg.propagation = propagation_opts;
 
-        traccc::track_candidate_container_types::host truth_track_candidates =
-            evt_data.generate_truth_candidates(sg, host_mr);
+        traccc::fitting_algorithm<host_fitter_type> host_fitting(fit_cfg);
 
-        // Run fitting
-        auto track_states =
-            host_fitting(host_det, field, truth_track_candidates);
+        // Fit a single event. The detector, the field and the fitting algorithm
+        // are only read here, so this may run on several threads at once.
+        auto fit_event = [&](const std::size_t event,
+                             const bella::candidate_event &evt)
+        {
+            // Run fitting
+            bella::scoped_timer timer(timing, "fitting");
+            auto track_states =
+                batched_fitter
+                    ? (*batched_fitter)(field, evt.candidates, host_fitting, event_mr)
+                    : bella::chunked_fit(host_fitting, host_det, field,
+                                         evt.candidates, fitting_opts.chunk_size,
+                                         fitting_opts.threads, event_mr);
+
+            return bella::collect_records(event, host_det, evt.truths, track_states);
+        };
+
+        // Write the records of one event. Called in event order.
+        auto write_event = [&](const bella::event_records &records)
+        {
+            std::cout << "Number of fitted tracks: " << records.residuals.size()
+                      << std::endl;
 
-        std::cout << "Number of fitted tracks: " << track_states.size()
-                  << std::endl;
+            bella::scoped_timer timer(timing, "output");
+            output_writer->write(records);
+            summary.add(records);
+            timing.count(1u, records.residuals.size());
+        };
 
-        const decltype(track_states)::size_type n_fitted_tracks =
-            track_states.size();
+        // Iterate over events
+        const auto [first_event, last_event] =
+            shard.range(input_opts.skip, input_opts.events + input_opts.skip);
 
-        for (unsigned int i = 0; i < n_fitted_tracks; i++)
+        if (fitting_opts.prefetch == 0u)
         {
-            const auto &trk_states_per_track = track_states.at(i).items;
-
-            if (trk_states_per_track.size() == 0u)
-            {
-                throw std::runtime_error("track states is empty");
-            }
-            /*
-            if (trk_states_per_track.size() < 6u)
-            {
-                throw std::runtime_error(
-                    "The number of track states per track (" +
-                    std::to_string(trk_states_per_track.size()) +
-                    ") is less than 6");
-            }
-            */
-
-            const auto &fit_res = track_states[i].header;
-
-            /************************************
-             *  Write Residuals of qop
-             * **********************************/
-
-            // Fit qop
-            const auto &fit_par = trk_states_per_track.at(0).smoothed();
-            const scalar fit_qop = fit_par.qop();
-            const scalar fit_qopT = fit_par.qopT();
-            // @NOTE: qopz is a signed value
-            const scalar fit_qopz = fit_par.qopz();
-
-            // Truth qop
-            const measurement meas = trk_states_per_track.at(0).get_measurement();
-            const auto global_mom = evt_data.m_meas_to_param_map.at(meas).second;
-            const auto p = getter::norm(global_mom);
-            const auto pT = getter::perp(global_mom);
-            // @NOTE: pz is a signed value
-            const auto pz = global_mom[2];
-
-            std::map<particle, uint64_t> contributing_particles =
-                evt_data.m_meas_to_ptc_map.at(meas);
-            const particle ptc = contributing_particles.begin()->first;
-            const auto q = ptc.charge;
-
-            const scalar truth_qop = q / p;
-            const scalar truth_qopT = q / pT;
-            const scalar truth_qopz = q / pz;
-
-            residual_file << fit_qop << "," << fit_qopT << "," << fit_qopz << ",";
-            residual_file << truth_qop << "," << truth_qopT << "," << truth_qopz << ",";
-            residual_file << fit_qop - truth_qop << ",";
-            residual_file << fit_qopT - truth_qopT << ",";
-            residual_file << fit_qopz - truth_qopz << " \n";
-
-            for (const auto &st : trk_states_per_track)
-            {
-                const detray::tracking_surface sf{host_det, st.surface_link()};
-                const auto xyz = sf.bound_to_global({}, st.smoothed().bound_local(), st.smoothed().dir());
-                state_file << event << "," << i << "," 
-                           << xyz[0] << "," << xyz[1] << "," << xyz[2] << "\n";
-            }
+            bella::ordered_event_loop(
+                threading_opts.threads, first_event, last_event,
+                [&](const std::size_t event)
+                { return fit_event(event, load_event(event)); },
+                write_event);
         }
-    }
+        else
+        {
+            bella::prefetched_event_loop(threading_opts.threads, first_event,
+                                         last_event, fitting_opts.prefetch,
+                                         load_event, fit_event, write_event);
+        }
+    });
+
+    output_writer->close();
 
-    residual_file.close();
-    state_file.close();
+    summary.report(std::cout);
+    summary.write("residual_summary" + shard.suffix() + ".json");
+
+    timing.report(std::cout);
+    if (!timing_opts.output.empty())
+    {
+        timing.dump(timing_opts.output);
+    }
 
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,214 @@
+/** BELLA experiment track reconstruction framework
+ *
+ * (c) 2024 Lawrence Berkeley National Laboratory
+ *
+ * Mozilla Public License Version 2.0
+ */
+
+// Project include(s).
+#include "traccc/cuda/utils/stream.hpp"
+#include "traccc/definitions/common.hpp"
+#include "traccc/definitions/primitives.hpp"
+#include "traccc/device/container_d2h_copy_alg.hpp"
+#include "traccc/device/container_h2d_copy_alg.hpp"
+#include "traccc/io/utils.hpp"
+#include "traccc/options/detector.hpp"
+#include "traccc/options/input_data.hpp"
+#include "traccc/options/program_options.hpp"
+#include "traccc/options/track_propagation.hpp"
+#include "traccc/utils/memory_resource.hpp"
+
+// Detray include(s).
+#include "detray/core/detector.hpp"
+#include "detray/detectors/bfield.hpp"
+
+// Local include(s).
+#include "src/cuda/fitting_algorithm.hpp"
+#include "src/csv_event.hpp"
+#include "src/cuda_options.hpp"
+#include "src/detector_io.hpp"
+#include "src/event_store.hpp"
+#include "src/field_options.hpp"
+#include "src/fit_output.hpp"
+#include "src/fit_output_options.hpp"
+#include "src/geometry_config.hpp"
+#include "src/geometry_source_options.hpp"
+#include "src/residual_summary.hpp"
+#include "src/shard.hpp"
+#include "src/shard_options.hpp"
+#include "src/telescope_metadata.hpp"
+#include "src/truth_fitting.hpp"
+
+// VecMem include(s).
+#include <vecmem/memory/cuda/device_memory_resource.hpp>
+#include <vecmem/memory/cuda/host_memory_resource.hpp>
+#include <vecmem/memory/host_memory_resource.hpp>
+#include <vecmem/utils/cuda/async_copy.hpp>
+
+// System include(s).
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+using namespace traccc;
+namespace po = boost::program_options;
+
+// The main routine
+//
+int main(int argc, char *argv[])
+{
+    // Program options.
+    traccc::opts::detector detector_opts;
+    traccc::opts::input_data input_opts;
+    traccc::opts::track_propagation propagation_opts;
+    traccc::opts::field_options field_opts;
+    traccc::opts::cuda_options cuda_opts;
+    traccc::opts::fit_output_options output_opts;
+    traccc::opts::geometry_source_options source_opts;
+    traccc::opts::bella_geometry_options geometry_opts;
+    traccc::opts::shard_options shard_opts;
+    traccc::opts::program_options program_opts{
+        "Truth Track Fitting on a CUDA Device",
+        {detector_opts, input_opts, propagation_opts, field_opts, cuda_opts,
+         output_opts, source_opts, geometry_opts, shard_opts},
+        argc,
+        argv};
+
+    /// Type declarations
+    using host_detector_type = bella::host_detector_type;
+
+    using b_field_t = covfie::field<detray::bfield::inhom_bknd_t>;
+
+    // Memory resources used by the application.
+    vecmem::host_memory_resource host_mr;
+    vecmem::cuda::host_memory_resource cuda_host_mr;
+    vecmem::cuda::device_memory_resource device_mr;
+    traccc::memory_resource mr{device_mr, &cuda_host_mr};
+
+    // CUDA stream and the copy object working on it
+    traccc::cuda::stream stream;
+    vecmem::cuda::async_copy copy{stream.cudaStream()};
+
+    /*****************************
+     * Build a geometry
+     *****************************/
+
+    // B field value and its type. The device fitter is only built for the
+    // field map.
+    if (field_opts.model != "grid")
+    {
+        throw std::invalid_argument("The CUDA fitter only supports --bfield-model=grid");
+    }
+    b_field_t field = detray::io::read_bfield<b_field_t>(field_opts.bfield_file);
+
+    // The telescope the device fitter is compiled for, read from json or
+    // rebuilt. The csv events are read without a detector.
+    const auto [host_det, names] = bella::load_telescope(
+        detector_opts, source_opts, bella::make_geometry_config(geometry_opts),
+        host_mr);
+    if (input_opts.use_acts_geom_source ||
+        input_opts.format != traccc::data_format::csv)
+    {
+        throw std::invalid_argument(
+            "Only csv events with detray geometry ids can be fitted");
+    }
+
+    // Copy the detector and the field to the device once
+    auto det_buffer = detray::get_buffer(host_det, device_mr, copy);
+    stream.synchronize();
+    auto det_view = detray::get_data(det_buffer);
+
+    const bella::cuda::field_type device_field(field);
+
+    /*****************************
+     * Do the reconstruction
+     *****************************/
+
+    // Fitting algorithm object
+    typename bella::cuda::fitting_algorithm::config_type fit_cfg;
+    fit_cfg.propagation = propagation_opts;
+
+    bella::cuda::fitting_algorithm device_fitting(fit_cfg, mr, copy, stream);
+
+    // Host <-> device copies of the fitting input and output
+    traccc::device::container_h2d_copy_alg<
+        traccc::track_candidate_container_types>
+        track_candidate_h2d{mr, copy};
+    traccc::device::container_d2h_copy_alg<traccc::track_state_container_types>
+        track_state_d2h{mr, copy};
+
+    // Output files. A shard fits its block of the input events.
+    const bella::shard shard = bella::make_shard(shard_opts);
+    const auto output_writer = bella::make_record_writer(
+        output_opts.format, shard.suffix(), output_opts.queue_size);
+    bella::residual_summary summary(output_opts.summary);
+
+    // Iterate over batches of events
+    const std::size_t batch_events = std::max<std::size_t>(cuda_opts.batch_events, 1u);
+    const auto [shard_begin, last_event] =
+        shard.range(input_opts.skip, input_opts.events + input_opts.skip);
+
+    for (std::size_t first_event = shard_begin; first_event < last_event;
+         first_event += batch_events)
+    {
+        const std::size_t n_events =
+            std::min(batch_events, last_event - first_event);
+
+        // Truth track candidates of all events in the batch
+        std::vector<std::vector<bella::track_truth>> truths;
+        std::vector<std::size_t> track_offsets;
+        traccc::track_candidate_container_types::host truth_track_candidates{&host_mr};
+
+        for (std::size_t i = 0; i < n_events; ++i)
+        {
+            const bella::truth_event evt =
+                bella::read_csv_event(input_opts.directory, first_event + i);
+
+            const auto event_candidates =
+                bella::generate_truth_candidates(host_det, evt.view(), host_mr);
+            truths.push_back(bella::track_truths(evt.view()));
+
+            track_offsets.push_back(truth_track_candidates.size());
+            for (std::size_t j = 0; j < event_candidates.size(); ++j)
+            {
+                truth_track_candidates.push_back(event_candidates.at(j).header,
+                                                 event_candidates.at(j).items);
+            }
+        }
+        track_offsets.push_back(truth_track_candidates.size());
+
+        // Run fitting
+        const traccc::track_candidate_container_types::buffer
+            track_candidates_buffer =
+                track_candidate_h2d(traccc::get_data(truth_track_candidates));
+
+        const traccc::track_state_container_types::buffer track_states_buffer =
+            device_fitting(det_view, device_field, track_candidates_buffer);
+
+        const traccc::track_state_container_types::host track_states =
+            track_state_d2h(track_states_buffer);
+
+        // Split the batch back into events
+        for (std::size_t i = 0; i < n_events; ++i)
+        {
+            const auto records = bella::collect_records(
+                first_event + i, host_det, truths[i], track_states,
+                track_offsets[i], track_offsets[i + 1] - track_offsets[i]);
+
+            std::cout << "Number of fitted tracks: " << records.residuals.size()
+                      << std::endl;
+
+            output_writer->write(records);
+            summary.add(records);
+        }
+    }
+
+    output_writer->close();
+
+    summary.report(std::cout);
+    summary.write("residual_summary" + shard.suffix() + ".json");
+
+    return EXIT_SUCCESS;
+}
@@ -5,65 +5,102 @@
  * Mozilla Public License Version 2.0
  */
 
+// Project include(s).
+#include "traccc/definitions/common.hpp"
+#include "traccc/options/program_options.hpp"
+#include "traccc/options/threading.hpp"
+
+// Local include(s).
+#include "src/bfield_writer_options.hpp"
+#include "src/field_map.hpp"
+#include "src/field_options.hpp"
+#include "src/geometry_config.hpp"
+#include "src/mapped_field.hpp"
+
 // System include(s).
-#include <iostream>
+#include <cstddef>
+#include <cstdlib>
 #include <fstream>
+#include <iostream>
+#include <stdexcept>
 
 // The main routine
 //
-
-bool is_in_magnet(const double x, const double y, const double z)
-{
-    bool is_x_in_magnet = (x >= 40.f && x <= 50.f) || (x >= 210.f && x <= 220.f);
-    bool is_y_in_magnet = (std::abs(y) <= 10.f);
-    bool is_z_in_magnet = (std::abs(z) <= 10.f);
-
-    return is_x_in_magnet && is_y_in_magnet && is_z_in_magnet;
-}
-
 int main(int argc, char *argv[])
 {
+    // Program options.
+    traccc::opts::bfield_writer_options writer_opts;
+    traccc::opts::bella_geometry_options geometry_opts;
+    traccc::opts::threading threading_opts;
+    traccc::opts::program_options program_opts{
+        "BELLA B Field Map Writer", {writer_opts, geometry_opts, threading_opts},
+        argc, argv};
 
-    // Residual file
-    std::ofstream bfield_file;
-    bfield_file.open("bfield.txt");
+    const bella::geometry_config geometry =
+        bella::make_geometry_config(geometry_opts);
 
-    // Cell size = 10 mm
-    double spacing = 10.f;
+    bella::field_grid grid;
+    grid.spacing = writer_opts.spacing;
+    grid.min = {writer_opts.x_min, writer_opts.y_min, writer_opts.z_min};
+    grid.max = {writer_opts.x_max, writer_opts.y_max, writer_opts.z_max};
 
-    const double start_x = -100.f;
-    const double end_x = 1000.f;
-    const double start_z = -500.f;
-    const double end_z = 500.f;
-    const double start_y = -500.f;
-    const double end_y = 500.f;
+    const bella::magnet_grid_sampler sampler(geometry.magnets, grid);
 
-    double x{start_x};
-    double y{start_y};
-    double z{start_z};
-    while (x < end_x)
+    if (writer_opts.format == "txt")
     {
-        while (y < end_y)
+        // Text input of covfie's convert_bfield
+        const auto &xs = sampler.axis(0);
+        const auto &ys = sampler.axis(1);
+        const auto &zs = sampler.axis(2);
+
+        std::ofstream bfield_file;
+        bfield_file.open(writer_opts.output_file());
+
+        bella::magnet_grid_sampler::row_type row(zs.size());
+        for (std::size_t i = 0; i < xs.size(); ++i)
         {
-            while (z < end_z)
+            for (std::size_t j = 0; j < ys.size(); ++j)
             {
-                // @NOTE: What is the b direction?
-                const double bx = 0.f;
-                const double bz = 0.f;
-                const double by = is_in_magnet(x, y, z) ? 0.5f : 0.f; // in Tesla
-                bfield_file << x << " " << y << " " << z << " "
-                            << bx << " " << by << " " << bz << "\n";
-
-                z += spacing;
+                // in Tesla
+                sampler.fill_row(i, j, 1.f, row);
+                for (std::size_t k = 0; k < zs.size(); ++k)
+                {
+                    bfield_file << xs[i] << " " << ys[j] << " " << zs[k] << " "
+                                << row[k][0] << " " << row[k][1] << " "
+                                << row[k][2] << "\n";
+                }
             }
-            y += spacing;
-            z = start_z;
         }
-        x += spacing;
-        y = start_y;
-        z = start_z;
+
+        bfield_file.close();
+    }
+    else if (writer_opts.format == "cvf")
+    {
+        // Fill the grid in memory, in the same layout that convert_bfield
+        // makes from the text file
+        const bella::grid_field_type field = bella::make_field_map(
+            sampler, grid, threading_opts.threads);
+
+        std::ofstream bfield_file(writer_opts.output_file(), std::ios::binary);
+        if (!bfield_file)
+        {
+            throw std::runtime_error("Could not open " + writer_opts.output_file());
+        }
+        field.dump(bfield_file);
+        bfield_file.close();
     }
+    else if (writer_opts.format == "bfm")
+    {
+        // Written row by row, in the layout the executables map in place
+        bella::write_mapped_field(writer_opts.output_file(), sampler, grid);
+    }
+    else
+    {
+        throw std::invalid_argument("Unknown B field format: " + writer_opts.format);
+    }
+
+    std::cout << "Wrote " << sampler.size() << " field points to "
+              << writer_opts.output_file() << std::endl;
 
-    bfield_file.close();
-    return 1;
-}
\ No newline at end of file
+    return EXIT_SUCCESS;
+}